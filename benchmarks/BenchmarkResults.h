@@ -0,0 +1,468 @@
+#pragma once
+
+/* Machine-readable throughput results and the regression gate on top of them.
+ *
+ * The [throughput] benchmarks record every configuration's repeated
+ * samples/s measurements into <results dir>/<machine>/latest.json. A
+ * machine's baseline.json is a copy of an accepted latest.json; the
+ * [regression] test compares the two configuration by configuration.
+ *
+ * The gate judges modules, not configurations. Repetitions of one
+ * configuration run back to back and share whatever the machine was doing
+ * at the time, so their spread understates the noise, and with a t-test per
+ * configuration a few hundred configurations would turn up false alarms on
+ * every run. Instead each configuration contributes the log of its
+ * current/baseline mean, and a module has regressed when the geometric mean
+ * of those dropped by more than the threshold *and* a one-sample t-test over
+ * them says the drop is not noise, after Holm's correction across all the
+ * modules compared. Results from different machines, compilers or build
+ * types never meet, since each fingerprint gets its own directory.
+ */
+
+#include <juce_core/juce_core.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <vector>
+
+namespace BenchmarkResults
+{
+    /** Set from the command line, see Catch2Main.cpp. */
+    struct Options
+    {
+        std::string resultsDirectory = "benchmark-results";
+        std::string baselineFile; ///< overrides <results dir>/<machine>/baseline.json
+        std::string resultsFile;  ///< overrides <results dir>/<machine>/latest.json
+        double threshold = 0.05;  ///< relative throughput loss that fails the gate
+        double alpha = 0.01;      ///< chance of any false alarm across the modules
+        int repetitions = 5;      ///< measurements per configuration
+    };
+
+    inline Options& options()
+    {
+        static Options instance;
+        return instance;
+    }
+
+    //==============================================================================
+    /** One configuration of one module, with a samples/s value per repetition. */
+    struct Measurement
+    {
+        juce::String module;
+        juce::String type;   ///< float or double
+        juce::String params; ///< static or automated
+        double sampleRate = 0.0;
+        int blockSize = 0;
+        std::vector<double> samplesPerSecond;
+
+        juce::String getKey() const
+        {
+            return module + " | " + type + " | " + juce::String (juce::roundToInt (sampleRate)) + " Hz | "
+                 + juce::String (blockSize) + " | " + params;
+        }
+
+        double getMean() const
+        {
+            double sum = 0.0;
+
+            for (const auto value : samplesPerSecond)
+                sum += value;
+
+            return samplesPerSecond.empty() ? 0.0 : sum / static_cast<double> (samplesPerSecond.size());
+        }
+
+        /** Sample variance, 0 with fewer than two repetitions. */
+        double getVariance() const
+        {
+            if (samplesPerSecond.size() < 2)
+                return 0.0;
+
+            const auto mean = getMean();
+            double sum = 0.0;
+
+            for (const auto value : samplesPerSecond)
+                sum += (value - mean) * (value - mean);
+
+            return sum / static_cast<double> (samplesPerSecond.size() - 1);
+        }
+    };
+
+    //==============================================================================
+    /** What makes two runs comparable: CPU, OS, compiler and build type. */
+    inline juce::String getMachineDescription()
+    {
+        using Stats = juce::SystemStats;
+
+        juce::String compiler;
+
+       #if defined(__clang__)
+        compiler << "Clang " << __clang_major__ << "." << __clang_minor__;
+       #elif defined(__GNUC__)
+        compiler << "GCC " << __GNUC__ << "." << __GNUC_MINOR__;
+       #elif defined(_MSC_VER)
+        compiler << "MSVC " << _MSC_VER;
+       #endif
+
+        juce::String description;
+        description << Stats::getCpuVendor() << " " << Stats::getCpuModel() << ", "
+                    << Stats::getNumPhysicalCpus() << "/" << Stats::getNumCpus() << " cores, "
+                    << Stats::getOperatingSystemName() << ", " << compiler;
+
+       #ifdef CMAKE_BUILD_TYPE
+        description << ", " << CMAKE_BUILD_TYPE;
+       #endif
+
+       #ifdef CHASM_IPP
+        description << ", IPP";
+       #endif
+
+        return description;
+    }
+
+    /** Readable CPU name plus a hash of the full description, usable as a directory name. */
+    inline juce::String getMachineFingerprint()
+    {
+        const auto description = getMachineDescription();
+        const auto cpu = juce::SystemStats::getCpuModel().retainCharacters ("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 -").trim().replaceCharacter (' ', '-');
+
+        return (cpu.isEmpty() ? juce::String ("machine") : cpu) + "-" + juce::String::toHexString (description.hashCode64());
+    }
+
+    inline juce::File getMachineDirectory()
+    {
+        return juce::File::getCurrentWorkingDirectory().getChildFile (options().resultsDirectory).getChildFile (getMachineFingerprint());
+    }
+
+    inline juce::File getLatestFile()
+    {
+        if (! options().resultsFile.empty())
+            return juce::File::getCurrentWorkingDirectory().getChildFile (options().resultsFile);
+
+        return getMachineDirectory().getChildFile ("latest.json");
+    }
+
+    inline juce::File getBaselineFile()
+    {
+        if (! options().baselineFile.empty())
+            return juce::File::getCurrentWorkingDirectory().getChildFile (options().baselineFile);
+
+        return getMachineDirectory().getChildFile ("baseline.json");
+    }
+
+    //==============================================================================
+    inline std::vector<Measurement> load (const juce::File& file)
+    {
+        std::vector<Measurement> measurements;
+        const auto json = juce::JSON::parse (file);
+
+        if (const auto* results = json["results"].getArray())
+        {
+            for (const auto& result : *results)
+            {
+                Measurement measurement;
+                measurement.module = result["module"].toString();
+                measurement.type = result["type"].toString();
+                measurement.params = result["params"].toString();
+                measurement.sampleRate = result["sampleRate"];
+                measurement.blockSize = result["blockSize"];
+
+                if (const auto* values = result["samplesPerSecond"].getArray())
+                    for (const auto& value : *values)
+                        measurement.samplesPerSecond.push_back (value);
+
+                measurements.push_back (std::move (measurement));
+            }
+        }
+
+        return measurements;
+    }
+
+    inline bool save (const juce::File& file, const std::vector<Measurement>& measurements)
+    {
+        juce::Array<juce::var> results;
+
+        for (const auto& measurement : measurements)
+        {
+            auto result = std::make_unique<juce::DynamicObject>();
+            result->setProperty ("module", measurement.module);
+            result->setProperty ("type", measurement.type);
+            result->setProperty ("params", measurement.params);
+            result->setProperty ("sampleRate", measurement.sampleRate);
+            result->setProperty ("blockSize", measurement.blockSize);
+            result->setProperty ("mean", measurement.getMean());
+
+            juce::Array<juce::var> values;
+
+            for (const auto value : measurement.samplesPerSecond)
+                values.add (value);
+
+            result->setProperty ("samplesPerSecond", values);
+            results.add (juce::var (result.release()));
+        }
+
+        auto root = std::make_unique<juce::DynamicObject>();
+        root->setProperty ("machine", getMachineDescription());
+        root->setProperty ("fingerprint", getMachineFingerprint());
+        root->setProperty ("time", juce::Time::getCurrentTime().toISO8601 (true));
+        root->setProperty ("results", results);
+
+        return file.getParentDirectory().createDirectory()
+            && file.replaceWithText (juce::JSON::toString (juce::var (root.release())));
+    }
+
+    /**
+     * Replaces the module's entries in the latest results with these, keeping
+     * other modules' so benchmarks can be run one module at a time.
+     */
+    inline bool record (const juce::String& module, const std::vector<Measurement>& measurements)
+    {
+        const auto file = getLatestFile();
+        auto merged = load (file);
+
+        merged.erase (std::remove_if (merged.begin(), merged.end(), [&] (const Measurement& m) { return m.module == module; }), merged.end());
+        merged.insert (merged.end(), measurements.begin(), measurements.end());
+
+        return save (file, merged);
+    }
+
+    //==============================================================================
+    /** One configuration in both runs. */
+    struct Comparison
+    {
+        Measurement baseline, current;
+        double change = 0.0; ///< relative change in mean throughput, negative is slower
+        double t = 0.0;      ///< Welch's t statistic of the change, positive is slower
+    };
+
+    /** All of one module's configurations in both runs, which is what the gate judges. */
+    struct ModuleComparison
+    {
+        juce::String module;
+        std::vector<double> changes; ///< per configuration, sorted
+        double change = 0.0;         ///< geometric mean relative change, negative is slower
+        double t = 0.0;              ///< one-sample t of the log changes, positive is slower
+        double pSlower = 1.0;        ///< Holm-adjusted p-value of being slower
+        double pFaster = 1.0;        ///< Holm-adjusted p-value of being faster
+
+        bool isRegression() const { return change < -options().threshold && pSlower <= options().alpha; }
+        bool isImprovement() const { return change > options().threshold && pFaster <= options().alpha; }
+    };
+
+    /** Pairs up the configurations present in both runs. */
+    inline std::vector<Comparison> compare (const std::vector<Measurement>& baseline, const std::vector<Measurement>& current)
+    {
+        std::map<juce::String, const Measurement*> baselineByKey;
+
+        for (const auto& measurement : baseline)
+            baselineByKey[measurement.getKey()] = &measurement;
+
+        std::vector<Comparison> comparisons;
+
+        for (const auto& measurement : current)
+        {
+            const auto found = baselineByKey.find (measurement.getKey());
+
+            if (found == baselineByKey.end() || found->second->getMean() <= 0.0)
+                continue;
+
+            Comparison comparison;
+            comparison.baseline = *found->second;
+            comparison.current = measurement;
+
+            const auto baselineMean = comparison.baseline.getMean();
+            const auto currentMean = measurement.getMean();
+            comparison.change = currentMean / baselineMean - 1.0;
+
+            const auto standardError = std::sqrt (comparison.baseline.getVariance() / static_cast<double> (comparison.baseline.samplesPerSecond.size())
+                                                  + measurement.getVariance() / static_cast<double> (measurement.samplesPerSecond.size()));
+
+            // no spread at all (a single repetition): any change counts
+            comparison.t = standardError > 0.0 ? (baselineMean - currentMean) / standardError
+                                               : (baselineMean > currentMean ? 1.0 : -1.0) * std::numeric_limits<double>::infinity();
+
+            comparisons.push_back (comparison);
+        }
+
+        return comparisons;
+    }
+
+    //==============================================================================
+    /** Regularised incomplete beta function I_x(a, b), by its continued fraction. */
+    inline double incompleteBeta (double a, double b, double x)
+    {
+        if (x <= 0.0 || x >= 1.0)
+            return x <= 0.0 ? 0.0 : 1.0;
+
+        // the fraction converges quickly only below the mean, use the symmetry above it
+        if (x > (a + 1.0) / (a + b + 2.0))
+            return 1.0 - incompleteBeta (b, a, 1.0 - x);
+
+        constexpr double tiny = 1.0e-300;
+        const auto front = std::exp (std::lgamma (a + b) - std::lgamma (a) - std::lgamma (b) + a * std::log (x) + b * std::log1p (-x)) / a;
+
+        // modified Lentz's method
+        double c = 1.0, d = 1.0 - (a + b) * x / (a + 1.0);
+        d = 1.0 / (std::abs (d) < tiny ? tiny : d);
+        double result = d;
+
+        for (int m = 1; m <= 300; ++m)
+        {
+            for (const auto numerator : { m * (b - m) * x / ((a + 2.0 * m - 1.0) * (a + 2.0 * m)),
+                                          -(a + m) * (a + b + m) * x / ((a + 2.0 * m) * (a + 2.0 * m + 1.0)) })
+            {
+                d = 1.0 + numerator * d;
+                d = 1.0 / (std::abs (d) < tiny ? tiny : d);
+                c = 1.0 + numerator / c;
+                c = std::abs (c) < tiny ? tiny : c;
+                result *= c * d;
+            }
+
+            if (std::abs (c * d - 1.0) < 1.0e-12)
+                break;
+        }
+
+        return front * result;
+    }
+
+    /** P(T >= t) for Student's t distribution with the given degrees of freedom. */
+    inline double studentTUpperTail (double t, double degreesOfFreedom)
+    {
+        if (std::isinf (t))
+            return t > 0.0 ? 0.0 : 1.0;
+
+        const auto tail = 0.5 * incompleteBeta (0.5 * degreesOfFreedom, 0.5, degreesOfFreedom / (degreesOfFreedom + t * t));
+        return t > 0.0 ? tail : 1.0 - tail;
+    }
+
+    /** Holm's step-down adjustment: p-values to compare against the family-wise alpha directly. */
+    inline void adjustHolm (std::vector<double*> pValues)
+    {
+        std::sort (pValues.begin(), pValues.end(), [] (const double* a, const double* b) { return *a < *b; });
+
+        const auto count = static_cast<double> (pValues.size());
+        double running = 0.0;
+
+        for (size_t rank = 0; rank < pValues.size(); ++rank)
+        {
+            running = std::max (running, std::min (1.0, (count - static_cast<double> (rank)) * *pValues[rank]));
+            *pValues[rank] = running;
+        }
+    }
+
+    /**
+     * Groups the configurations by module and tests each module's log changes
+     * against zero, with one-sided p-values Holm-adjusted across the modules.
+     * A module with a single configuration has no spread to test against and
+     * never counts as significant.
+     */
+    inline std::vector<ModuleComparison> compareModules (const std::vector<Comparison>& comparisons)
+    {
+        std::map<juce::String, std::vector<double>> logChanges;
+
+        for (const auto& comparison : comparisons)
+            logChanges[comparison.current.module].push_back (std::log1p (comparison.change));
+
+        std::vector<ModuleComparison> modules;
+
+        for (const auto& [module, logs] : logChanges)
+        {
+            ModuleComparison result;
+            result.module = module;
+
+            const auto count = static_cast<double> (logs.size());
+            double mean = 0.0;
+
+            for (const auto value : logs)
+            {
+                mean += value / count;
+                result.changes.push_back (std::expm1 (value));
+            }
+
+            std::sort (result.changes.begin(), result.changes.end());
+            result.change = std::expm1 (mean);
+
+            if (logs.size() >= 2)
+            {
+                double variance = 0.0;
+
+                for (const auto value : logs)
+                    variance += (value - mean) * (value - mean) / (count - 1.0);
+
+                const auto standardError = std::sqrt (variance / count);
+
+                // every configuration changed by the same amount: any change counts
+                result.t = standardError > 0.0 ? -mean / standardError
+                                               : (mean < 0.0 ? 1.0 : -1.0) * std::numeric_limits<double>::infinity();
+
+                result.pSlower = studentTUpperTail (result.t, count - 1.0);
+                result.pFaster = studentTUpperTail (-result.t, count - 1.0);
+            }
+
+            modules.push_back (std::move (result));
+        }
+
+        std::vector<double*> slower, faster;
+
+        for (auto& module : modules)
+        {
+            slower.push_back (&module.pSlower);
+            faster.push_back (&module.pFaster);
+        }
+
+        adjustHolm (slower);
+        adjustHolm (faster);
+
+        return modules;
+    }
+
+    /** Per-module table of the changes, then the worst configurations of every regressed module. */
+    inline void printSummary (std::ostream& out, const std::vector<Comparison>& comparisons, const std::vector<ModuleComparison>& modules)
+    {
+        out << "\nThroughput against baseline (threshold " << options().threshold * 100.0 << "%, alpha " << options().alpha << " over "
+            << modules.size() << " modules, Holm-adjusted)\n"
+            << std::left << std::setw (26) << "module" << std::right << std::setw (9) << "configs" << std::setw (11) << "change"
+            << std::setw (11) << "median" << std::setw (11) << "worst" << std::setw (9) << "t" << std::setw (11) << "p slower"
+            << std::setw (11) << "p faster" << "\n";
+
+        for (const auto& module : modules)
+        {
+            const auto& changes = module.changes;
+
+            out << std::left << std::setw (26) << module.module << std::right << std::setw (9) << changes.size() << std::fixed << std::setprecision (1)
+                << std::setw (10) << module.change * 100.0 << "%" << std::setw (10) << changes[changes.size() / 2] * 100.0 << "%"
+                << std::setw (10) << changes.front() * 100.0 << "%" << std::setw (9) << module.t << std::setprecision (4)
+                << std::setw (11) << module.pSlower << std::setw (11) << module.pFaster
+                << (module.isRegression() ? "  REGRESSION" : module.isImprovement() ? "  improved" : "") << "\n"
+                << std::defaultfloat;
+        }
+
+        for (const auto& module : modules)
+        {
+            if (! module.isRegression())
+                continue;
+
+            std::vector<const Comparison*> worst;
+
+            for (const auto& comparison : comparisons)
+                if (comparison.current.module == module.module)
+                    worst.push_back (&comparison);
+
+            std::sort (worst.begin(), worst.end(), [] (const Comparison* a, const Comparison* b) { return a->change < b->change; });
+            worst.resize (std::min<size_t> (worst.size(), 5));
+
+            out << "REGRESSION " << module.module << ", slowest configurations:\n";
+
+            for (const auto* comparison : worst)
+                out << "  " << comparison->current.getKey() << ": " << std::fixed << std::setprecision (0)
+                    << comparison->baseline.getMean() << " -> " << comparison->current.getMean() << " samples/s ("
+                    << std::setprecision (1) << comparison->change * 100.0 << "%, Welch's t = " << comparison->t << ")\n"
+                    << std::defaultfloat;
+        }
+
+        out << std::flush;
+    }
+}
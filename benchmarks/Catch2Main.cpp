@@ -1,5 +1,6 @@
 // All test files are included in the executable via the Glob in CMakeLists.txt
 
+#include "BenchmarkResults.h"
 #include "juce_gui_basics/juce_gui_basics.h"
 #include <catch2/catch_session.hpp>
 
@@ -11,7 +12,22 @@ int main (int argc, char* argv[])
     // It's nicer DX when placed here vs. manually in Catch2 SECTIONs
     juce::ScopedJuceInitialiser_GUI gui;
 
-    const int result = Catch::Session().run (argc, argv);
+    Catch::Session session;
+    auto& options = BenchmarkResults::options();
+
+    using Catch::Clara::Opt;
+    session.cli (session.cli()
+                 | Opt (options.resultsDirectory, "directory")["--results-dir"]("where throughput results and baselines are kept, per machine")
+                 | Opt (options.resultsFile, "file")["--results-file"]("throughput results to write and check, instead of the machine's latest.json")
+                 | Opt (options.baselineFile, "file")["--baseline-file"]("baseline to check against, instead of the machine's baseline.json")
+                 | Opt (options.threshold, "fraction")["--regression-threshold"]("throughput loss that fails the regression gate (default 0.05)")
+                 | Opt (options.alpha, "probability")["--regression-alpha"]("chance of any false alarm across the modules (default 0.01)")
+                 | Opt (options.repetitions, "count")["--repetitions"]("measurements per throughput configuration (default 5)"));
+
+    if (const int error = session.applyCommandLine (argc, argv); error != 0)
+        return error;
+
+    const int result = session.run();
 
     return result;
 }
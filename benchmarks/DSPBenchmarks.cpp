@@ -0,0 +1,379 @@
+#include "DSP/ChasmDSP.h"
+#include "catch2/benchmark/catch_benchmark_all.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+namespace
+{
+    constexpr int benchmarkSamples = 4096;
+    constexpr double benchmarkSampleRate = 48000.0;
+
+    // Divide the reported time by benchmarkSamples for the per-sample cost
+    std::vector<float> makeNoise()
+    {
+        juce::Random random (42);
+        std::vector<float> samples (benchmarkSamples);
+        for (auto& sample : samples)
+            sample = random.nextFloat() * 2.0f - 1.0f;
+        return samples;
+    }
+}
+
+TEST_CASE ("Delay line performance")
+{
+    const auto noise = makeNoise();
+
+    auto benchmarkInterpolation = [&] (const char* name, DSP::Filters::DelayInterpolation interpolation) {
+        DSP::Filters::DelayLine<float, 1> delayLine;
+        delayLine.prepare (benchmarkSampleRate, 100.0);
+        delayLine.setInterpolation (interpolation);
+
+        BENCHMARK (name)
+        {
+            float sum = 0.0f;
+            for (int i = 0; i < benchmarkSamples; ++i)
+            {
+                // modulated read position, as under a moving delay parameter
+                delayLine.setDelaySamples (1000.0 + 0.25 * (i & 63));
+                sum += delayLine.readSample();
+                delayLine.writeSample (noise[(size_t) i]);
+            }
+            return sum;
+        };
+    };
+
+    benchmarkInterpolation ("Linear, 4096 samples", DSP::Filters::DelayInterpolation::Linear);
+    benchmarkInterpolation ("Lagrange3rd, 4096 samples", DSP::Filters::DelayInterpolation::Lagrange3rd);
+    benchmarkInterpolation ("Thiran, 4096 samples", DSP::Filters::DelayInterpolation::Thiran);
+
+    DSP::FloatAllpassFilter allpass;
+    allpass.prepare (benchmarkSampleRate, 100.0);
+    allpass.setDelayTime (29.1);
+    allpass.setFeedback (0.7f);
+
+    BENCHMARK ("AllpassFilter, 4096 samples")
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < benchmarkSamples; ++i)
+            sum += allpass.processSample (noise[(size_t) i]);
+        return sum;
+    };
+}
+
+TEST_CASE ("Allpass chain packing")
+{
+    const auto noise = makeNoise();
+    std::vector<float> left (noise.size()), right (noise.size());
+
+    // a moving delay keeps the coefficient updates in the measurement
+    auto nextDelay = [delay = 0] () mutable { return static_cast<float> (20 + (delay++ % 20)); };
+
+    std::array<DSP::Filters::SchroederAllpassChain<float>, 2> scalar;
+
+    for (auto& chain : scalar)
+        chain.prepare (benchmarkSampleRate);
+
+    BENCHMARK ("Two scalar chains, stereo 4096 samples")
+    {
+        std::copy (noise.begin(), noise.end(), left.begin());
+        std::copy (noise.rbegin(), noise.rend(), right.begin());
+
+        const auto delay = nextDelay();
+        scalar[0].setDelayTime (delay);
+        scalar[1].setDelayTime (delay);
+        scalar[0].processBlock (left.data(), benchmarkSamples);
+        scalar[1].processBlock (right.data(), benchmarkSamples);
+        return left.back() + right.back();
+    };
+
+    DSP::Filters::PackedSchroederAllpassChain<float, 2> packed;
+    packed.prepare (benchmarkSampleRate);
+
+    BENCHMARK ("Packed 2-lane chain, stereo 4096 samples")
+    {
+        std::copy (noise.begin(), noise.end(), left.begin());
+        std::copy (noise.rbegin(), noise.rend(), right.begin());
+
+        float* channels[] = { left.data(), right.data() };
+        packed.setDelayTime (nextDelay());
+        packed.processBlock (channels, 2, benchmarkSamples);
+        return left.back() + right.back();
+    };
+}
+
+TEST_CASE ("Saturation performance")
+{
+    using Saturation = DSP::Utils::Saturation;
+
+    const auto noise = makeNoise();
+    std::vector<float> block (noise.size());
+    constexpr float drive = 4.0f;
+
+    Saturation::prepareTanhTable<float>();
+
+    BENCHMARK ("std::tanh, 4096 samples")
+    {
+        for (size_t i = 0; i < block.size(); ++i)
+            block[i] = std::tanh (noise[i] * drive);
+        return block.back();
+    };
+
+    BENCHMARK ("tanhPade block, 4096 samples")
+    {
+        std::copy (noise.begin(), noise.end(), block.begin());
+        Saturation::tanhPade (block.data(), benchmarkSamples, drive);
+        return block.back();
+    };
+
+    BENCHMARK ("tanhTable block, 4096 samples")
+    {
+        std::copy (noise.begin(), noise.end(), block.begin());
+        Saturation::tanhTable (block.data(), benchmarkSamples, drive);
+        return block.back();
+    };
+
+    BENCHMARK ("softKnee block, 4096 samples")
+    {
+        std::copy (noise.begin(), noise.end(), block.begin());
+        Saturation::softKnee (block.data(), benchmarkSamples, 0.5f, drive);
+        return block.back();
+    };
+
+    BENCHMARK ("cubic block, 4096 samples")
+    {
+        std::copy (noise.begin(), noise.end(), block.begin());
+        Saturation::cubic (block.data(), benchmarkSamples, drive);
+        return block.back();
+    };
+}
+
+TEST_CASE ("Limiter performance")
+{
+    const auto noise = makeNoise();
+    juce::AudioBuffer<float> buffer (2, benchmarkSamples);
+
+    auto benchmarkLimiter = [&] (const char* name, bool truePeak) {
+        DSP::Effects::LookaheadLimiter<float> limiter;
+        limiter.prepare ({ benchmarkSampleRate, (juce::uint32) benchmarkSamples, 2 });
+        limiter.setCeiling (-6.0f);
+        limiter.setTruePeak (truePeak);
+
+        BENCHMARK (name)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                buffer.copyFrom (channel, 0, noise.data(), benchmarkSamples);
+
+            limiter.processBlock (buffer);
+            return buffer.getSample (0, 0);
+        };
+    };
+
+    benchmarkLimiter ("LookaheadLimiter sample peak, stereo 4096 samples", false);
+    benchmarkLimiter ("LookaheadLimiter true peak, stereo 4096 samples", true);
+}
+
+TEST_CASE ("Processor idle performance")
+{
+    const auto noise = makeNoise();
+    juce::AudioBuffer<float> buffer (2, benchmarkSamples);
+
+    DSP::FloatProcessor active;
+    active.prepare ({ benchmarkSampleRate, (juce::uint32) benchmarkSamples, 2 });
+
+    BENCHMARK ("ChasmDSPProcessor active, stereo 4096 samples")
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            buffer.copyFrom (channel, 0, noise.data(), benchmarkSamples);
+
+        active.processBlock (buffer);
+        return buffer.getSample (0, 0);
+    };
+
+    // feed silence until the tail has rung out and the processor sleeps
+    DSP::FloatProcessor idle;
+    idle.prepare ({ benchmarkSampleRate, (juce::uint32) benchmarkSamples, 2 });
+
+    while (! idle.isSleeping())
+    {
+        buffer.clear();
+        idle.processBlock (buffer);
+    }
+
+    BENCHMARK ("ChasmDSPProcessor idle, stereo 4096 samples")
+    {
+        buffer.clear();
+        idle.processBlock (buffer);
+        return buffer.getSample (0, 0);
+    };
+}
+
+TEST_CASE ("Processor precision")
+{
+    const auto noise = makeNoise();
+    const juce::dsp::ProcessSpec spec { benchmarkSampleRate, (juce::uint32) benchmarkSamples, 2 };
+
+    juce::AudioBuffer<float> floatBuffer (2, benchmarkSamples);
+    juce::AudioBuffer<double> doubleBuffer (2, benchmarkSamples);
+
+    auto fillDouble = [&] {
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < benchmarkSamples; ++i)
+                doubleBuffer.setSample (channel, i, noise[(size_t) i]);
+    };
+
+    DSP::FloatProcessor floatProcessor;
+    floatProcessor.prepare (spec);
+
+    BENCHMARK ("FloatProcessor, stereo 4096 samples")
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            floatBuffer.copyFrom (channel, 0, noise.data(), benchmarkSamples);
+
+        floatProcessor.processBlock (floatBuffer);
+        return floatBuffer.getSample (0, 0);
+    };
+
+    DSP::DoubleProcessor doubleProcessor;
+    doubleProcessor.prepare (spec);
+
+    BENCHMARK ("DoubleProcessor, stereo 4096 samples")
+    {
+        fillDouble();
+        doubleProcessor.processBlock (doubleBuffer);
+        return doubleBuffer.getSample (0, 0);
+    };
+
+    // what a 64-bit host paid before: convert to float, process, convert back
+    DSP::FloatProcessor convertingProcessor;
+    convertingProcessor.prepare (spec);
+
+    BENCHMARK ("FloatProcessor with double conversion, stereo 4096 samples")
+    {
+        fillDouble();
+        floatBuffer.makeCopyOf (doubleBuffer, true);
+        convertingProcessor.processBlock (floatBuffer);
+        doubleBuffer.makeCopyOf (floatBuffer, true);
+        return doubleBuffer.getSample (0, 0);
+    };
+}
+
+TEST_CASE ("Processor kernel specialisation")
+{
+    const auto noise = makeNoise();
+
+    auto benchmarkKernels = [&] (const char* name, int numChannels, bool specialised) {
+        using Parameter = DSP::FloatProcessor::Parameter;
+
+        DSP::FloatProcessor processor;
+        processor.setParameter (Parameter::lowCut, 80.0f);
+        processor.setParameter (Parameter::highCut, 8000.0f);
+        processor.setUseSpecialisedKernels (specialised);
+        processor.prepare ({ benchmarkSampleRate, (juce::uint32) benchmarkSamples, (juce::uint32) numChannels });
+
+        juce::AudioBuffer<float> buffer (numChannels, benchmarkSamples);
+
+        BENCHMARK (name)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.copyFrom (channel, 0, noise.data(), benchmarkSamples);
+
+            processor.processBlock (buffer);
+            return buffer.getSample (0, 0);
+        };
+    };
+
+    benchmarkKernels ("Branchy cut filters, mono 4096 samples", 1, false);
+    benchmarkKernels ("Specialised cut filters, mono 4096 samples", 1, true);
+    benchmarkKernels ("Branchy cut filters, stereo 4096 samples", 2, false);
+    benchmarkKernels ("Specialised cut filters, stereo 4096 samples", 2, true);
+}
+
+TEST_CASE ("Processor instruction sets")
+{
+    using DSP::Utils::CpuDispatch;
+    using DSP::Utils::InstructionSet;
+
+    const auto noise = makeNoise();
+    juce::AudioBuffer<float> buffer (2, benchmarkSamples);
+
+    for (auto index = 0; index < static_cast<int> (InstructionSet::numInstructionSets); ++index)
+    {
+        const auto instructionSet = static_cast<InstructionSet> (index);
+
+        if (! CpuDispatch::isSupported (instructionSet))
+            continue;
+
+        DSP::FloatProcessor processor;
+        processor.setInstructionSet (instructionSet);
+        processor.prepare ({ benchmarkSampleRate, (juce::uint32) benchmarkSamples, 2 });
+
+        BENCHMARK (std::string ("ChasmDSPProcessor ") + CpuDispatch::getName (instructionSet) + ", stereo 4096 samples")
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                buffer.copyFrom (channel, 0, noise.data(), benchmarkSamples);
+
+            processor.processBlock (buffer);
+            return buffer.getSample (0, 0);
+        };
+    }
+}
+
+namespace
+{
+    /** The same set of vector operations over a stereo 4096-sample block, per backend. */
+    template <typename Ops, typename Cascade>
+    void benchmarkVectorBackend (const std::string& backend)
+    {
+        const auto noise = makeNoise();
+        std::vector<float> ramp (noise.size()), left (noise.size()), right (noise.size());
+
+        for (size_t i = 0; i < ramp.size(); ++i)
+            ramp[i] = 0.5f + 0.5f * (float) i / (float) ramp.size();
+
+        BENCHMARK (backend + " gain ramp, stereo 4096 samples")
+        {
+            Ops::multiply (left.data(), noise.data(), ramp.data(), benchmarkSamples);
+            Ops::multiply (right.data(), noise.data(), ramp.data(), benchmarkSamples);
+            return left.back() + right.back();
+        };
+
+        BENCHMARK (backend + " dry/wet mix, stereo 4096 samples")
+        {
+            std::copy (noise.begin(), noise.end(), left.begin());
+            std::copy (noise.begin(), noise.end(), right.begin());
+            Ops::mix (left.data(), noise.data(), ramp.data(), ramp.data(), benchmarkSamples);
+            Ops::mix (right.data(), noise.data(), ramp.data(), ramp.data(), benchmarkSamples);
+            return left.back() + right.back();
+        };
+
+        BENCHMARK (backend + " M/S width, stereo 4096 samples")
+        {
+            std::copy (noise.begin(), noise.end(), left.begin());
+            std::copy (noise.rbegin(), noise.rend(), right.begin());
+            Ops::midSideWidth (left.data(), right.data(), 1.5f, benchmarkSamples);
+            return left.back() + right.back();
+        };
+
+        Cascade cascade;
+        cascade.prepare (2);
+        cascade.setCoefficients (0, 1.2426f, -1.6585f, 0.6254f, -1.6307f, 0.6702f);
+        cascade.setCoefficients (1, 0.9817f, -1.9630f, 0.9817f, -1.9629f, 0.9633f);
+
+        BENCHMARK (backend + " 2-stage biquad cascade, stereo 4096 samples")
+        {
+            std::copy (noise.begin(), noise.end(), left.begin());
+            std::copy (noise.begin(), noise.end(), right.begin());
+            cascade.process (0, left.data(), benchmarkSamples);
+            cascade.process (1, right.data(), benchmarkSamples);
+            return left.back() + right.back();
+        };
+    }
+}
+
+TEST_CASE ("Vector backend performance")
+{
+    benchmarkVectorBackend<DSP::Utils::PortableVectorOps, DSP::Utils::PortableBiquadCascade<float, 2>> ("Portable");
+
+   #ifdef CHASM_IPP
+    benchmarkVectorBackend<DSP::Utils::IppVectorOps, DSP::Utils::IppBiquadCascade<float, 2>> ("IPP");
+   #endif
+}
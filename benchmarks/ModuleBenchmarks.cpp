@@ -0,0 +1,512 @@
+/* Throughput of every DSP module, for sizing render and server machines.
+ *
+ * Each module is swept over block sizes, sample rates, float/double and
+ * static vs automated parameters (new targets every block), always on a
+ * stereo signal. Every configuration prints one row with
+ * - samples/s: stereo frames processed per second spent processing (the
+ *   input refill between blocks is not timed), by one instance on one core
+ * - realtime factor: samples/s divided by the sample rate, i.e. how many
+ *   instances one core could run in real time
+ *
+ * Each configuration is measured --repetitions times; the means are
+ * printed and all values recorded as JSON for the regression gate, see
+ * BenchmarkResults.h.
+ *
+ * Run a single module with e.g. `Benchmarks "Throughput: MakeItLoud"`.
+ *
+ * The [counters] benchmarks run the same modules at 48 kHz under hardware
+ * performance counters (see PerfCounters.h), counting process() only, and
+ * print per-sample cycles, instructions, IPC and cache and branch misses.
+ * They are skipped where the counters can't be opened.
+ */
+
+#include "BenchmarkResults.h"
+#include "DSP/ChasmDSP.h"
+#include "PerfCounters.h"
+#include "catch2/catch_test_macros.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    constexpr std::array blockSizes { 16, 64, 256, 1024, 4096 };
+    constexpr std::array sampleRates { 44100.0, 48000.0, 96000.0, 192000.0 };
+
+    // wall time of each repetition, and of the warm-up before them
+    constexpr double measureSeconds = 0.05;
+
+    /** Triangle between low and high over 64 blocks, for automated parameters. */
+    template <typename SampleType>
+    SampleType automation (int block, SampleType low, SampleType high)
+    {
+        const auto phase = static_cast<SampleType> (block % 64) / SampleType { 32.0 };
+        const auto triangle = phase < SampleType { 1.0 } ? phase : SampleType { 2.0 } - phase;
+        return low + (high - low) * triangle;
+    }
+
+    //==============================================================================
+    // One adapter per module: prepare(), automate() before every block, process()
+
+    template <typename SampleType>
+    struct AllpassFilterModule
+    {
+        std::array<DSP::Filters::AllpassFilter<SampleType>, 2> filters;
+
+        void prepare (double sampleRate, int)
+        {
+            for (auto& filter : filters)
+            {
+                filter.prepare (sampleRate, 100.0);
+                filter.setDelayTime (29.1);
+                filter.setFeedback (SampleType { 0.7 });
+            }
+        }
+
+        void automate (int block)
+        {
+            for (auto& filter : filters)
+                filter.setDelayTime (static_cast<double> (automation (block, SampleType { 5.0 }, SampleType { 60.0 })));
+        }
+
+        void process (juce::AudioBuffer<SampleType>& buffer)
+        {
+            for (size_t channel = 0; channel < filters.size(); ++channel)
+            {
+                auto* data = buffer.getWritePointer ((int) channel);
+
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    data[i] = filters[channel].processSample (data[i]);
+            }
+        }
+    };
+
+    template <typename SampleType>
+    struct SchroederAllpassChainModule
+    {
+        std::array<DSP::Filters::SchroederAllpassChain<SampleType>, 2> chains;
+
+        void prepare (double sampleRate, int)
+        {
+            for (auto& chain : chains)
+                chain.prepare (sampleRate);
+        }
+
+        void automate (int block)
+        {
+            for (auto& chain : chains)
+            {
+                chain.setDelayTime (automation (block, SampleType { 5.0 }, SampleType { 60.0 }));
+                chain.setCharacter (automation (block, SampleType { 0.5 }, SampleType { 5.0 }));
+            }
+        }
+
+        void process (juce::AudioBuffer<SampleType>& buffer)
+        {
+            for (size_t channel = 0; channel < chains.size(); ++channel)
+                chains[channel].processBlock (buffer.getWritePointer ((int) channel), buffer.getNumSamples());
+        }
+    };
+
+    template <typename SampleType>
+    struct HaasEffectModule
+    {
+        DSP::Effects::HaasEffect<SampleType> haas;
+
+        void prepare (double sampleRate, int blockSize) { haas.prepare (sampleRate, blockSize); }
+        void automate (int block) { haas.setDelayMs (automation (block, SampleType { 1.0 }, SampleType { 30.0 })); }
+        void process (juce::AudioBuffer<SampleType>& buffer) { haas.processBlock (buffer); }
+    };
+
+    template <typename SampleType>
+    struct StereoEnhancerModule
+    {
+        DSP::Effects::StereoEnhancer<SampleType> enhancer;
+
+        void prepare (double sampleRate, int)
+        {
+            enhancer.prepare (sampleRate);
+            enhancer.setWidth (SampleType { 150.0 });
+        }
+
+        void automate (int block) { enhancer.setWidth (automation (block, SampleType { 0.0 }, SampleType { 200.0 })); }
+        void process (juce::AudioBuffer<SampleType>& buffer) { enhancer.processBlock (buffer); }
+    };
+
+    template <typename SampleType>
+    struct BrightnessEQModule
+    {
+        DSP::Filters::BrightnessEQ<SampleType> eq;
+
+        void prepare (double sampleRate, int blockSize)
+        {
+            eq.prepare ({ sampleRate, (juce::uint32) blockSize, 2 });
+            eq.setBrightness (SampleType { 6.0 });
+        }
+
+        void automate (int block) { eq.setBrightness (automation (block, SampleType { -12.0 }, SampleType { 12.0 })); }
+        void process (juce::AudioBuffer<SampleType>& buffer) { eq.processBlock (buffer); }
+    };
+
+    template <typename SampleType>
+    struct MakeItLoudModule
+    {
+        DSP::Effects::MakeItLoud<SampleType> makeItLoud;
+
+        // Further, by its enum (the int overload takes the plugin's menu index), with 2x
+        // polyphase oversampling so the oversampler is measured too; the plugin defaults to 1x
+        void prepare (double sampleRate, int blockSize)
+        {
+            using MakeItLoud = DSP::Effects::MakeItLoud<SampleType>;
+
+            makeItLoud.prepare ({ sampleRate, (juce::uint32) blockSize, 2 });
+            makeItLoud.setCompressorMode (MakeItLoud::CompressorMode::Further);
+            makeItLoud.setOversampling (1, MakeItLoud::OversamplingFilter::PolyphaseIIR);
+            makeItLoud.setInputGain (SampleType { 1.0 });
+            makeItLoud.setBoost (SampleType { 2.0 });
+        }
+
+        void automate (int block)
+        {
+            makeItLoud.setInputGain (automation (block, SampleType { 0.5 }, SampleType { 2.0 }));
+            makeItLoud.setBoost (automation (block, SampleType { 1.0 }, SampleType { 3.0 }));
+        }
+
+        void process (juce::AudioBuffer<SampleType>& buffer) { makeItLoud.processBlock (buffer); }
+    };
+
+    template <typename SampleType>
+    struct LookaheadLimiterModule
+    {
+        DSP::Effects::LookaheadLimiter<SampleType> limiter;
+
+        void prepare (double sampleRate, int blockSize)
+        {
+            limiter.prepare ({ sampleRate, (juce::uint32) blockSize, 2 });
+            limiter.setCeiling (SampleType { -6.0 });
+            limiter.setTruePeak (true);
+        }
+
+        void automate (int block) { limiter.setCeiling (automation (block, SampleType { -12.0 }, SampleType { -1.0 })); }
+        void process (juce::AudioBuffer<SampleType>& buffer) { limiter.processBlock (buffer); }
+    };
+
+    template <typename SampleType>
+    struct ChasmDSPProcessorModule
+    {
+        using Parameter = typename DSP::Core::ChasmDSPProcessor<SampleType>::Parameter;
+
+        DSP::Core::ChasmDSPProcessor<SampleType> processor;
+
+        void prepare (double sampleRate, int blockSize)
+        {
+            processor.setParameter (Parameter::lowCut, SampleType { 80.0 });
+            processor.setParameter (Parameter::highCut, SampleType { 12000.0 });
+            processor.setParameter (Parameter::haas, SampleType { 10.0 });
+
+            // menu index 3, Crunchy, at the plugin's default 1x oversampling
+            processor.setCompressorMode (3);
+            processor.setOversampling (0, DSP::Core::ChasmDSPProcessor<SampleType>::OversamplingFilter::PolyphaseIIR);
+            processor.prepare ({ sampleRate, (juce::uint32) blockSize, 2 });
+        }
+
+        void automate (int block)
+        {
+            processor.setParameter (Parameter::delay, automation (block, SampleType { 5.0 }, SampleType { 60.0 }));
+            processor.setParameter (Parameter::character, automation (block, SampleType { 0.5 }, SampleType { 5.0 }));
+            processor.setParameter (Parameter::brightness, automation (block, SampleType { -6.0 }, SampleType { 6.0 }));
+            processor.setParameter (Parameter::width, automation (block, SampleType { 50.0 }, SampleType { 150.0 }));
+            processor.setParameter (Parameter::lowCut, automation (block, SampleType { 20.0 }, SampleType { 200.0 }));
+            processor.setParameter (Parameter::mix, automation (block, SampleType { 20.0 }, SampleType { 80.0 }));
+        }
+
+        void process (juce::AudioBuffer<SampleType>& buffer) { processor.processBlock (buffer); }
+    };
+
+    //==============================================================================
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType> makeNoise (int blockSize)
+    {
+        juce::Random random (42);
+        juce::AudioBuffer<SampleType> noise (2, blockSize);
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                noise.setSample (channel, i, static_cast<SampleType> (random.nextFloat() * 2.0f - 1.0f));
+
+        return noise;
+    }
+
+    /** Stereo frames per second spent in process() for one configuration, once per repetition. */
+    template <template <typename> class Module, typename SampleType>
+    std::vector<double> measureSamplesPerSecond (double sampleRate, int blockSize, bool automated, int repetitions)
+    {
+        Module<SampleType> module;
+        module.prepare (sampleRate, blockSize);
+
+        // the input is refilled every block, so e.g. the processor never goes to sleep
+        const auto noise = makeNoise<SampleType> (blockSize);
+        juce::AudioBuffer<SampleType> buffer (2, blockSize);
+
+        int block = 0;
+
+        // only automate() and process() are timed; refilling the input is not,
+        // as for small modules the copy would be a good part of the work
+        auto runFor = [&] (double seconds) {
+            const auto end = juce::Time::getHighResolutionTicks() + juce::Time::secondsToHighResolutionTicks (seconds);
+            juce::int64 frames = 0;
+            juce::int64 processTicks = 0;
+
+            while (juce::Time::getHighResolutionTicks() < end)
+            {
+                buffer.makeCopyOf (noise, true);
+
+                const auto start = juce::Time::getHighResolutionTicks();
+
+                if (automated)
+                    module.automate (block);
+
+                module.process (buffer);
+                processTicks += juce::Time::getHighResolutionTicks() - start;
+
+                ++block;
+                frames += blockSize;
+            }
+
+            return static_cast<double> (frames) / juce::Time::highResolutionTicksToSeconds (processTicks);
+        };
+
+        runFor (measureSeconds);
+
+        std::vector<double> samplesPerSecond;
+
+        for (int repetition = 0; repetition < repetitions; ++repetition)
+            samplesPerSecond.push_back (runFor (measureSeconds));
+
+        return samplesPerSecond;
+    }
+
+    /** Sweeps the module, prints a table and records the results under the module's name. */
+    template <template <typename> class Module>
+    void measureThroughput (const char* module, const char* description)
+    {
+        const auto repetitions = juce::jmax (1, BenchmarkResults::options().repetitions);
+        std::vector<BenchmarkResults::Measurement> measurements;
+
+        std::cout << "\n"
+                  << module << " - " << description << "\n"
+                  << std::left << std::setw (8) << "type" << std::setw (10) << "rate" << std::setw (8) << "block"
+                  << std::setw (11) << "params" << std::right << std::setw (16) << "samples/s" << std::setw (14) << "realtime x"
+                  << std::setw (9) << "+-" << "\n";
+
+        auto sweep = [&] (auto sampleType, const char* typeName) {
+            using SampleType = decltype (sampleType);
+
+            for (const auto sampleRate : sampleRates)
+                for (const auto blockSize : blockSizes)
+                    for (const auto automated : { false, true })
+                    {
+                        BenchmarkResults::Measurement measurement;
+                        measurement.module = module;
+                        measurement.type = typeName;
+                        measurement.params = automated ? "automated" : "static";
+                        measurement.sampleRate = sampleRate;
+                        measurement.blockSize = blockSize;
+                        measurement.samplesPerSecond = measureSamplesPerSecond<Module, SampleType> (sampleRate, blockSize, automated, repetitions);
+
+                        const auto mean = measurement.getMean();
+                        const auto spread = std::sqrt (measurement.getVariance()) / mean;
+
+                        std::cout << std::left << std::setw (8) << typeName << std::setw (10) << juce::roundToInt (sampleRate) << std::setw (8) << blockSize
+                                  << std::setw (11) << measurement.params << std::right << std::fixed
+                                  << std::setprecision (0) << std::setw (16) << mean
+                                  << std::setprecision (1) << std::setw (14) << mean / sampleRate
+                                  << std::setw (8) << spread * 100.0 << "%\n"
+                                  << std::defaultfloat;
+
+                        measurements.push_back (std::move (measurement));
+                    }
+        };
+
+        sweep (float {}, "float");
+        sweep (double {}, "double");
+
+        std::cout << std::flush;
+
+        CHECK (BenchmarkResults::record (module, measurements));
+    }
+
+    //==============================================================================
+    // stereo frames counted per configuration, after as many again to warm up
+    constexpr int countedFrames = 1 << 20;
+
+    /** Hardware counts per stereo frame for one configuration, around process() only. */
+    template <template <typename> class Module, typename SampleType>
+    PerfCounters::Counts countEvents (PerfCounters::Group& counters, double sampleRate, int blockSize, bool automated)
+    {
+        Module<SampleType> module;
+        module.prepare (sampleRate, blockSize);
+
+        const auto noise = makeNoise<SampleType> (blockSize);
+        juce::AudioBuffer<SampleType> buffer (2, blockSize);
+        const int numBlocks = countedFrames / blockSize;
+
+        for (int block = 0; block < 2 * numBlocks; ++block)
+        {
+            if (automated)
+                module.automate (block);
+
+            buffer.makeCopyOf (noise, true);
+
+            if (block == numBlocks)
+                counters.reset();
+
+            if (block >= numBlocks)
+                counters.enable();
+
+            module.process (buffer);
+            counters.disable();
+        }
+
+        auto counts = counters.read();
+
+        for (auto& value : counts.values)
+            value /= static_cast<double> (numBlocks * blockSize);
+
+        return counts;
+    }
+
+    /** Prints a table of per-sample counts for the module at 48 kHz. */
+    template <template <typename> class Module>
+    void measureCounters (const char* module, const char* description)
+    {
+        using PerfCounters::Event;
+
+        PerfCounters::Group counters;
+
+        if (! counters.isAvailable())
+            SKIP ("Hardware counters unavailable: " << counters.getError());
+
+        constexpr double sampleRate = 48000.0;
+
+        std::cout << "\n"
+                  << module << " - " << description << ", per sample at " << juce::roundToInt (sampleRate) << " Hz\n"
+                  << std::left << std::setw (8) << "type" << std::setw (8) << "block" << std::setw (11) << "params" << std::right
+                  << std::setw (10) << "cycles" << std::setw (10) << "instr" << std::setw (7) << "IPC" << std::setw (12) << "L1D miss"
+                  << std::setw (14) << "LLC miss/1k" << std::setw (13) << "branch miss" << "\n";
+
+        auto column = [] (int width, int precision, double value) {
+            if (std::isnan (value))
+                std::cout << std::setw (width) << "n/a";
+            else
+                std::cout << std::fixed << std::setprecision (precision) << std::setw (width) << value << std::defaultfloat;
+        };
+
+        auto sweep = [&] (auto sampleType, const char* typeName) {
+            using SampleType = decltype (sampleType);
+
+            for (const auto blockSize : blockSizes)
+                for (const auto automated : { false, true })
+                {
+                    const auto counts = countEvents<Module, SampleType> (counters, sampleRate, blockSize, automated);
+                    auto perSample = [&] (Event event) { return counts.has (event) ? counts.get (event) : std::numeric_limits<double>::quiet_NaN(); };
+
+                    std::cout << std::left << std::setw (8) << typeName << std::setw (8) << blockSize << std::setw (11)
+                              << (automated ? "automated" : "static") << std::right;
+
+                    column (10, 1, perSample (Event::cycles));
+                    column (10, 1, perSample (Event::instructions));
+                    column (7, 2, counts.ratio (Event::instructions, Event::cycles));
+                    column (12, 4, perSample (Event::l1dMisses));
+                    column (14, 3, perSample (Event::llcMisses) * 1000.0);
+                    column (13, 4, perSample (Event::branchMisses));
+                    std::cout << "\n";
+                }
+        };
+
+        sweep (float {}, "float");
+        sweep (double {}, "double");
+
+        std::cout << std::flush;
+    }
+}
+
+TEST_CASE ("Throughput: AllpassFilter", "[throughput]")
+{
+    measureThroughput<AllpassFilterModule> ("AllpassFilter", "two, one per channel");
+}
+
+TEST_CASE ("Throughput: SchroederAllpassChain", "[throughput]")
+{
+    measureThroughput<SchroederAllpassChainModule> ("SchroederAllpassChain", "two, one per channel");
+}
+
+TEST_CASE ("Throughput: HaasEffect", "[throughput]")
+{
+    measureThroughput<HaasEffectModule> ("HaasEffect", "right channel delay");
+}
+
+TEST_CASE ("Throughput: StereoEnhancer", "[throughput]")
+{
+    measureThroughput<StereoEnhancerModule> ("StereoEnhancer", "M/S width");
+}
+
+TEST_CASE ("Throughput: BrightnessEQ", "[throughput]")
+{
+    measureThroughput<BrightnessEQModule> ("BrightnessEQ", "3 kHz high shelf");
+}
+
+TEST_CASE ("Throughput: MakeItLoud", "[throughput]")
+{
+    measureThroughput<MakeItLoudModule> ("MakeItLoud", "Further, 2x oversampling");
+}
+
+TEST_CASE ("Throughput: LookaheadLimiter", "[throughput]")
+{
+    measureThroughput<LookaheadLimiterModule> ("LookaheadLimiter", "true peak");
+}
+
+TEST_CASE ("Throughput: ChasmDSPProcessor", "[throughput]")
+{
+    measureThroughput<ChasmDSPProcessorModule> ("ChasmDSPProcessor", "all stages active, Crunchy, 1x oversampling");
+}
+
+TEST_CASE ("Counters: AllpassFilter", "[counters]")
+{
+    measureCounters<AllpassFilterModule> ("AllpassFilter", "two, one per channel");
+}
+
+TEST_CASE ("Counters: SchroederAllpassChain", "[counters]")
+{
+    measureCounters<SchroederAllpassChainModule> ("SchroederAllpassChain", "two, one per channel");
+}
+
+TEST_CASE ("Counters: HaasEffect", "[counters]")
+{
+    measureCounters<HaasEffectModule> ("HaasEffect", "right channel delay");
+}
+
+TEST_CASE ("Counters: StereoEnhancer", "[counters]")
+{
+    measureCounters<StereoEnhancerModule> ("StereoEnhancer", "M/S width");
+}
+
+TEST_CASE ("Counters: BrightnessEQ", "[counters]")
+{
+    measureCounters<BrightnessEQModule> ("BrightnessEQ", "3 kHz high shelf");
+}
+
+TEST_CASE ("Counters: MakeItLoud", "[counters]")
+{
+    measureCounters<MakeItLoudModule> ("MakeItLoud", "Further, 2x oversampling");
+}
+
+TEST_CASE ("Counters: LookaheadLimiter", "[counters]")
+{
+    measureCounters<LookaheadLimiterModule> ("LookaheadLimiter", "true peak");
+}
+
+TEST_CASE ("Counters: ChasmDSPProcessor", "[counters]")
+{
+    measureCounters<ChasmDSPProcessorModule> ("ChasmDSPProcessor", "all stages active, Crunchy, 1x oversampling");
+}
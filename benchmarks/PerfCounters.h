@@ -0,0 +1,213 @@
+#pragma once
+
+/* Hardware performance counters around a stretch of code, for the [counters]
+ * benchmarks.
+ *
+ * On Linux this opens one perf_event_open group on the calling thread, user
+ * space only, so it works with the default perf_event_paranoid of 2. Events
+ * the CPU or kernel doesn't offer are left out of the group, and when nothing
+ * can be opened (other platforms, containers, VMs without a virtual PMU)
+ * isAvailable() is false and getError() says why.
+ */
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <limits>
+
+#if JUCE_LINUX
+    #include <cerrno>
+    #include <cstring>
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace PerfCounters
+{
+    enum class Event
+    {
+        cycles,
+        instructions,
+        l1dMisses,    ///< L1 data cache read misses
+        llcMisses,    ///< last level cache misses
+        branchMisses,
+        numEvents
+    };
+
+    constexpr auto numEvents = static_cast<size_t> (Event::numEvents);
+
+    inline const char* getName (Event event)
+    {
+        switch (event)
+        {
+            case Event::cycles: return "cycles";
+            case Event::instructions: return "instructions";
+            case Event::l1dMisses: return "L1D misses";
+            case Event::llcMisses: return "LLC misses";
+            case Event::branchMisses: return "branch misses";
+            case Event::numEvents: break;
+        }
+
+        return "";
+    }
+
+    /** Counts since the last reset(), scaled up if the kernel had to multiplex. */
+    struct Counts
+    {
+        std::array<double, numEvents> values {};
+        std::array<bool, numEvents> valid {};
+
+        bool has (Event event) const { return valid[static_cast<size_t> (event)]; }
+        double get (Event event) const { return values[static_cast<size_t> (event)]; }
+
+        /** a / b if both were counted, otherwise NaN. */
+        double ratio (Event a, Event b) const
+        {
+            return has (a) && has (b) && get (b) > 0.0 ? get (a) / get (b) : std::numeric_limits<double>::quiet_NaN();
+        }
+    };
+
+    //==============================================================================
+    class Group
+    {
+    public:
+        Group()
+        {
+           #if JUCE_LINUX
+            for (size_t index = 0; index < numEvents; ++index)
+                open (static_cast<Event> (index));
+
+            if (isAvailable())
+                error.clear();
+            else
+                error << " (perf_event_paranoid is " << juce::File ("/proc/sys/kernel/perf_event_paranoid").loadFileAsString().trim() << ")";
+           #else
+            error = "hardware counters are only read on Linux";
+           #endif
+        }
+
+        ~Group()
+        {
+           #if JUCE_LINUX
+            for (const auto fd : descriptors)
+                if (fd >= 0)
+                    ::close (fd);
+           #endif
+        }
+
+        Group (const Group&) = delete;
+        Group& operator= (const Group&) = delete;
+
+        bool isAvailable() const { return leader >= 0; }
+        bool isAvailable (Event event) const { return descriptors[static_cast<size_t> (event)] >= 0; }
+
+        /** Why no counters could be opened, empty if they could. */
+        const juce::String& getError() const { return error; }
+
+       #if JUCE_LINUX
+        void reset() { control (PERF_EVENT_IOC_RESET); }
+        void enable() { control (PERF_EVENT_IOC_ENABLE); }
+        void disable() { control (PERF_EVENT_IOC_DISABLE); }
+       #else
+        void reset() {}
+        void enable() {}
+        void disable() {}
+       #endif
+
+        Counts read() const
+        {
+            Counts counts;
+
+           #if JUCE_LINUX
+            if (! isAvailable())
+                return counts;
+
+            // PERF_FORMAT_GROUP layout: count, time enabled, time running, then the values in opening order
+            std::array<juce::uint64, 3 + numEvents> buffer {};
+
+            if (::read (leader, buffer.data(), sizeof (buffer)) <= 0 || buffer[2] == 0)
+                return counts;
+
+            const auto scale = static_cast<double> (buffer[1]) / static_cast<double> (buffer[2]);
+
+            for (size_t i = 0; i < buffer[0] && i < order.size() && order[i] != Event::numEvents; ++i)
+            {
+                const auto index = static_cast<size_t> (order[i]);
+                counts.values[index] = static_cast<double> (buffer[3 + i]) * scale;
+                counts.valid[index] = true;
+            }
+           #endif
+
+            return counts;
+        }
+
+    private:
+        std::array<int, numEvents> descriptors { -1, -1, -1, -1, -1 };
+        std::array<Event, numEvents> order { Event::numEvents, Event::numEvents, Event::numEvents, Event::numEvents, Event::numEvents };
+        int leader = -1;
+        size_t numOpen = 0;
+        juce::String error;
+
+       #if JUCE_LINUX
+        void open (Event event)
+        {
+            // candidates in order of preference, as { type, config }
+            static constexpr auto l1dReadMiss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            static constexpr auto llReadMiss = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+            std::array<std::pair<juce::uint32, juce::uint64>, 2> candidates {};
+            size_t numCandidates = 1;
+
+            switch (event)
+            {
+                case Event::cycles: candidates[0] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES }; break;
+                case Event::instructions: candidates[0] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS }; break;
+                case Event::l1dMisses: candidates[0] = { PERF_TYPE_HW_CACHE, l1dReadMiss }; break;
+                case Event::llcMisses:
+                    // not every CPU exposes the LL cache event, the generic cache miss event is usually LLC too
+                    candidates = { { { PERF_TYPE_HW_CACHE, llReadMiss }, { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES } } };
+                    numCandidates = 2;
+                    break;
+                case Event::branchMisses: candidates[0] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }; break;
+                case Event::numEvents: return;
+            }
+
+            for (size_t i = 0; i < numCandidates; ++i)
+            {
+                perf_event_attr attributes {};
+                attributes.size = sizeof (attributes);
+                attributes.type = candidates[i].first;
+                attributes.config = candidates[i].second;
+                attributes.disabled = leader < 0 ? 1 : 0; // members follow the leader
+                attributes.exclude_kernel = 1;
+                attributes.exclude_hv = 1;
+                attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                const auto fd = static_cast<int> (::syscall (SYS_perf_event_open, &attributes, 0, -1, leader, 0));
+
+                if (fd >= 0)
+                {
+                    descriptors[static_cast<size_t> (event)] = fd;
+                    order[numOpen++] = event;
+
+                    if (leader < 0)
+                        leader = fd;
+
+                    return;
+                }
+
+                if (error.isEmpty())
+                    error << "perf_event_open failed: " << std::strerror (errno);
+            }
+        }
+
+        void control (unsigned long request)
+        {
+            if (isAvailable())
+                ::ioctl (leader, request, PERF_IOC_FLAG_GROUP);
+        }
+       #endif
+    };
+}
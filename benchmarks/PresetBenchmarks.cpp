@@ -0,0 +1,146 @@
+/* Listing a large preset library: scanning every file as the preset menu used
+ * to, against the index cold, loaded from disk, refreshed in full and refreshed
+ * by directory when nothing or one category changed. Run with
+ * `Benchmarks "[presets]"`.
+ */
+
+#include "Service/PresetIndex.h"
+#include "catch2/benchmark/catch_benchmark_all.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+namespace
+{
+    constexpr int numCategories = 100;
+    constexpr int presetsPerCategory = 100;
+
+    /** Settled an hour ago, as a library that was installed a while back. */
+    juce::Time settled()
+    {
+        return juce::Time::getCurrentTime() - juce::RelativeTime::hours (1.0);
+    }
+
+    /** A preset as the plugin saves it, with the metadata and a child per parameter. */
+    juce::String makePreset (int number)
+    {
+        juce::XmlElement xml ("Parameters");
+        xml.setAttribute ("presetName", "Preset " + juce::String (number));
+        xml.setAttribute ("artist", "Artist " + juce::String (number % 17));
+        xml.setAttribute ("dateCreated", "2024-01-01T00:00:00.000Z");
+        xml.setAttribute ("dateModified", "2024-06-01T00:00:00.000Z");
+
+        for (const auto* id : { "INPUT_GAIN", "OUTPUT_GAIN", "MIX", "HIGH_CUT", "MODE", "OVERSAMPLING", "OVERSAMPLING_FILTER" })
+        {
+            auto* param = xml.createNewChildElement ("PARAM");
+            param->setAttribute ("id", id);
+            param->setAttribute ("value", (number % 10) * 0.1);
+        }
+
+        return xml.toString();
+    }
+
+    void createLibrary (const juce::File& root)
+    {
+        for (int c = 0; c < numCategories; ++c)
+        {
+            const auto directory = root.getChildFile ("Category " + juce::String (c));
+            REQUIRE (directory.createDirectory().wasOk());
+
+            for (int p = 0; p < presetsPerCategory; ++p)
+            {
+                const auto file = directory.getChildFile ("Preset " + juce::String (p) + ".ddsp");
+                REQUIRE (file.replaceWithText (makePreset (c * presetsPerCategory + p)));
+                file.setLastModificationTime (settled());
+            }
+
+            directory.setLastModificationTime (settled());
+        }
+
+        root.setLastModificationTime (settled());
+    }
+
+    /** What getAllPresetMetadata() did before the index. */
+    int scanEverything (const juce::File& root)
+    {
+        int found = 0;
+
+        for (const auto& directory : root.findChildFiles (juce::File::findDirectories, false))
+        {
+            for (const auto& file : directory.findChildFiles (juce::File::findFiles, false, "*.ddsp"))
+            {
+                juce::XmlDocument document (file);
+
+                if (const auto xml = document.getDocumentElement())
+                    found += juce::ValueTree::fromXml (*xml).getProperty ("artist").toString().isNotEmpty() ? 1 : 0;
+            }
+        }
+
+        return found;
+    }
+
+    int countPresets (const Service::PresetIndex& index)
+    {
+        int found = 0;
+
+        for (const auto& category : index.getCategories())
+            found += index.getMetadata (category).size();
+
+        return found;
+    }
+}
+
+TEST_CASE ("Preset library, 10k presets", "[presets]")
+{
+    const juce::TemporaryFile temporary;
+    const auto root = temporary.getFile();
+    const auto indexFile = root.getSiblingFile (root.getFileName() + ".index");
+    createLibrary (root);
+
+    Service::PresetIndex warm (root, "Default", "ddsp");
+    warm.refresh();
+    REQUIRE (countPresets (warm) == numCategories * presetsPerCategory);
+    REQUIRE (warm.save (indexFile));
+
+    BENCHMARK ("Scan and parse every preset")
+    {
+        return scanEverything (root);
+    };
+
+    BENCHMARK ("Index, cold refresh")
+    {
+        Service::PresetIndex index (root, "Default", "ddsp");
+        index.refresh();
+        return countPresets (index);
+    };
+
+    BENCHMARK ("Index, load and refresh")
+    {
+        Service::PresetIndex index (root, "Default", "ddsp");
+        index.load (indexFile);
+        index.refresh();
+        return index.getNumFilesParsed();
+    };
+
+    BENCHMARK ("Index, refresh unchanged")
+    {
+        return warm.refresh();
+    };
+
+    BENCHMARK ("Index, refresh changed directories, none")
+    {
+        return warm.refreshChangedDirectories();
+    };
+
+    BENCHMARK ("Index, refresh changed directories, one category")
+    {
+        warm.invalidate ("Category 42");
+        return warm.refreshChangedDirectories();
+    };
+
+    BENCHMARK ("Index, save")
+    {
+        return warm.save (indexFile);
+    };
+
+    indexFile.deleteFile();
+    root.deleteRecursively();
+}
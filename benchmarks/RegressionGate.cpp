@@ -0,0 +1,49 @@
+/* The regression gate over the [throughput] results, see BenchmarkResults.h.
+ * Both test cases are hidden, so a plain Benchmarks run doesn't touch the
+ * baseline; the BenchmarkGate and BenchmarkBaseline targets run them.
+ */
+
+#include "BenchmarkResults.h"
+#include "catch2/catch_test_macros.hpp"
+
+#include <iostream>
+
+TEST_CASE ("Throughput regression gate", "[.][regression]")
+{
+    const auto baselineFile = BenchmarkResults::getBaselineFile();
+    const auto latestFile = BenchmarkResults::getLatestFile();
+
+    INFO ("machine: " << BenchmarkResults::getMachineDescription());
+    INFO ("baseline: " << baselineFile.getFullPathName());
+    INFO ("results: " << latestFile.getFullPathName());
+
+    if (! baselineFile.existsAsFile())
+        SKIP ("No baseline for this machine yet, store one with the BenchmarkBaseline target");
+
+    REQUIRE (latestFile.existsAsFile());
+
+    const auto baseline = BenchmarkResults::load (baselineFile);
+    const auto latest = BenchmarkResults::load (latestFile);
+    const auto comparisons = BenchmarkResults::compare (baseline, latest);
+
+    REQUIRE_FALSE (comparisons.empty());
+
+    const auto modules = BenchmarkResults::compareModules (comparisons);
+    BenchmarkResults::printSummary (std::cout, comparisons, modules);
+
+    const auto regressions = std::count_if (modules.begin(), modules.end(), [] (const auto& m) { return m.isRegression(); });
+    CHECK (regressions == 0);
+}
+
+TEST_CASE ("Store throughput baseline", "[.][update-baseline]")
+{
+    const auto latestFile = BenchmarkResults::getLatestFile();
+    const auto baselineFile = BenchmarkResults::getBaselineFile();
+
+    INFO ("results: " << latestFile.getFullPathName());
+    REQUIRE (latestFile.existsAsFile());
+    REQUIRE (baselineFile.getParentDirectory().createDirectory());
+    REQUIRE (latestFile.copyFileTo (baselineFile));
+
+    std::cout << "Stored " << baselineFile.getFullPathName() << " for " << BenchmarkResults::getMachineDescription() << std::endl;
+}
@@ -0,0 +1,113 @@
+/* Cost of each ChasmDSPProcessor stage under different settings, so it is
+ * visible which knobs make the processor expensive. Needs a build configured
+ * with -DCHASM_STAGE_PROFILING=ON; run with `Benchmarks "[stages]"`.
+ */
+
+#include "DSP/ChasmDSP.h"
+#include "catch2/catch_test_macros.hpp"
+
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+#if CHASM_STAGE_PROFILING
+
+namespace
+{
+    using Processor = DSP::Core::ChasmDSPProcessor<float>;
+    using Parameter = Processor::Parameter;
+    using Stage = Processor::Stage;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int numBlocks = 2000;
+
+    struct Setting
+    {
+        const char* name;
+        std::function<void (Processor&)> apply;
+    };
+
+    void printStageCosts (const Setting& setting)
+    {
+        Processor processor;
+        setting.apply (processor);
+        processor.prepare ({ sampleRate, (juce::uint32) blockSize, 2 });
+
+        juce::Random random (42);
+        juce::AudioBuffer<float> noise (2, blockSize), buffer (2, blockSize);
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                noise.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        // warm up, then only count the rest
+        for (int block = 0; block < numBlocks / 10; ++block)
+        {
+            buffer.makeCopyOf (noise, true);
+            processor.processBlock (buffer);
+        }
+
+        auto& profiler = processor.getStageProfiler();
+        profiler.reset();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            buffer.makeCopyOf (noise, true);
+            processor.processBlock (buffer);
+        }
+
+        const auto totalSamples = static_cast<double> (numBlocks * blockSize);
+        const auto totalTicks = static_cast<double> (juce::jmax<juce::int64> (1, profiler.getTotalTicks()));
+
+        std::cout << "\n" << setting.name << "\n"
+                  << std::left << std::setw (24) << "stage" << std::right << std::setw (12) << "ns/sample" << std::setw (9) << "share"
+                  << std::setw (14) << "worst us" << "\n";
+
+        for (size_t stage = 0; stage < Processor::numStages; ++stage)
+        {
+            const auto stats = profiler.getStats (stage);
+
+            std::cout << std::left << std::setw (24) << Processor::getStageName (static_cast<Stage> (stage)) << std::right << std::fixed
+                      << std::setprecision (2) << std::setw (12) << stats.getSeconds() * 1.0e9 / totalSamples
+                      << std::setprecision (1) << std::setw (8) << static_cast<double> (stats.ticks) / totalTicks * 100.0 << "%"
+                      << std::setprecision (2) << std::setw (14) << juce::Time::highResolutionTicksToSeconds (stats.worstTicks) * 1.0e6 << "\n"
+                      << std::defaultfloat;
+        }
+
+        std::cout << std::left << std::setw (24) << "total" << std::right << std::fixed << std::setprecision (2) << std::setw (12)
+                  << juce::Time::highResolutionTicksToSeconds (profiler.getTotalTicks()) * 1.0e9 / totalSamples << "\n"
+                  << std::defaultfloat << std::flush;
+    }
+}
+
+TEST_CASE ("Processor stage costs", "[stages]")
+{
+    const std::vector<Setting> settings {
+        { "defaults", [] (Processor&) {} },
+        { "cut filters on", [] (Processor& p) {
+             p.setParameter (Parameter::lowCut, 80.0f);
+             p.setParameter (Parameter::highCut, 12000.0f);
+         } },
+        { "Haas 10 ms, width 150%", [] (Processor& p) {
+             p.setParameter (Parameter::haas, 10.0f);
+             p.setParameter (Parameter::width, 150.0f);
+         } },
+        { "Further, 2x oversampling", [] (Processor& p) {
+             p.setCompressorMode (2);
+             p.setOversampling (1, Processor::OversamplingFilter::PolyphaseIIR);
+         } },
+        { "Crunchy, 8x linear phase", [] (Processor& p) {
+             p.setCompressorMode (3);
+             p.setOversampling (3, Processor::OversamplingFilter::LinearPhaseFIR);
+         } },
+        { "mix 100%", [] (Processor& p) { p.setParameter (Parameter::mix, 100.0f); } },
+        // only the dry delay and output gain run, all of it counted as the mix stage
+        { "mix 0%", [] (Processor& p) { p.setParameter (Parameter::mix, 0.0f); } },
+    };
+
+    for (const auto& setting : settings)
+        printStageCosts (setting);
+}
+
+#endif
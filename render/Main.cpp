@@ -0,0 +1,315 @@
+/* Offline renderer: runs the plugin's processor over audio files, faster
+ * than real time and without a DAW.
+ *
+ *   ChasmRender [options] <input files...>
+ *
+ *   --preset <file.ddsp>    preset saved by the plugin
+ *   --params <file.json>    parameters as { "ID": value }, in the parameter's own units
+ *   --param ID=value        one parameter, may be repeated; applied after the preset
+ *   --output <directory>    where results go, default next to each input
+ *   --block <samples>       block size, default 1024
+ *   --jobs <count>          files rendered in parallel, default one per core
+ *   --tail                  keep rendering until the processor's tail has died away
+ *   --double                process in double precision
+ *
+ * Results are written as "<name>_chasm" in the input's format (WAV or AIFF) and
+ * bit depth, always stereo. The processor's latency is compensated, so the
+ * output lines up with the input sample for sample.
+ *
+ * Files are streamed one block at a time, so memory use doesn't depend on their
+ * length (see Renderer.h). Each worker thread owns one PluginProcessor and renders
+ * files from a shared queue until it is empty, while the main thread runs the
+ * message loop the processors' timers need.
+ */
+
+#include "PluginProcessor.h"
+#include "Renderer.h"
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    struct Settings
+    {
+        juce::File preset;
+        juce::StringPairArray parameters; ///< parameter ID -> value, in the parameter's units
+        juce::File outputDirectory;
+        int blockSize = 1024;
+        int numJobs = juce::SystemStats::getNumCpus();
+        bool includeTail = false;
+        bool doublePrecision = false;
+        juce::Array<juce::File> inputs;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: ChasmRender [--preset file.ddsp] [--params file.json] [--param ID=value ...]\n"
+                     "                   [--output dir] [--block samples] [--jobs count] [--tail] [--double]\n"
+                     "                   <input.wav|input.aiff ...>\n";
+    }
+
+    /** Parses the command line; an empty string on success, the problem otherwise. */
+    juce::String parseArguments (const juce::ArgumentList& args, Settings& settings)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+
+            auto nextValue = [&]() -> juce::String {
+                return i + 1 < args.size() ? args[++i].text : juce::String();
+            };
+
+            if (arg == "--preset")
+                settings.preset = juce::File::getCurrentWorkingDirectory().getChildFile (nextValue());
+            else if (arg == "--params")
+            {
+                const auto file = juce::File::getCurrentWorkingDirectory().getChildFile (nextValue());
+                const auto json = juce::JSON::parse (file);
+
+                if (auto* object = json.getDynamicObject())
+                    for (const auto& property : object->getProperties())
+                        settings.parameters.set (property.name.toString(), property.value.toString());
+                else
+                    return "Could not read parameters from " + file.getFullPathName();
+            }
+            else if (arg == "--param")
+            {
+                const auto assignment = nextValue();
+
+                if (! assignment.containsChar ('='))
+                    return "Expected ID=value after --param, got \"" + assignment + "\"";
+
+                settings.parameters.set (assignment.upToFirstOccurrenceOf ("=", false, false).trim(),
+                                         assignment.fromFirstOccurrenceOf ("=", false, false).trim());
+            }
+            else if (arg == "--output")
+                settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile (nextValue());
+            else if (arg == "--block")
+                settings.blockSize = nextValue().getIntValue();
+            else if (arg == "--jobs")
+                settings.numJobs = nextValue().getIntValue();
+            else if (arg == "--tail")
+                settings.includeTail = true;
+            else if (arg == "--double")
+                settings.doublePrecision = true;
+            else if (arg.isLongOption() || arg.isShortOption())
+                return "Unknown option " + arg.text;
+            else
+                settings.inputs.add (arg.resolveAsFile());
+        }
+
+        if (settings.inputs.isEmpty())
+            return "No input files";
+
+        if (settings.blockSize < 16 || settings.blockSize > 65536)
+            return "The block size must be between 16 and 65536";
+
+        if (settings.preset != juce::File() && ! settings.preset.existsAsFile())
+            return "No preset at " + settings.preset.getFullPathName();
+
+        for (const auto& input : settings.inputs)
+            if (! input.existsAsFile())
+                return "No input file at " + input.getFullPathName();
+
+        settings.numJobs = juce::jlimit (1, settings.inputs.size(), settings.numJobs);
+        return {};
+    }
+
+    //==============================================================================
+    /** Loads the preset, then the single parameters, into a processor. */
+    juce::String applySettings (PluginProcessor& processor, const Settings& settings)
+    {
+        auto& apvts = processor.getApvts();
+
+        if (settings.preset != juce::File())
+        {
+            // the same XML the PresetManager writes and reads
+            const auto xml = juce::XmlDocument::parse (settings.preset);
+
+            if (xml == nullptr || ! xml->hasTagName (apvts.state.getType()))
+                return "Not a preset: " + settings.preset.getFullPathName();
+
+            apvts.replaceState (juce::ValueTree::fromXml (*xml));
+        }
+
+        for (const auto& id : settings.parameters.getAllKeys())
+        {
+            auto* parameter = apvts.getParameter (id);
+
+            if (parameter == nullptr)
+                return "Unknown parameter " + id;
+
+            // choices take their index
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (settings.parameters[id].getFloatValue()));
+        }
+
+        return {};
+    }
+
+    juce::File getOutputFile (const juce::File& input, const Settings& settings)
+    {
+        const auto directory = settings.outputDirectory != juce::File() ? settings.outputDirectory : input.getParentDirectory();
+        return directory.getChildFile (input.getFileNameWithoutExtension() + "_chasm" + input.getFileExtension());
+    }
+
+    /** Renders one file; an empty string on success, the problem otherwise. */
+    juce::String renderFile (PluginProcessor& processor, juce::AudioFormatManager& formats, const juce::File& input, const Settings& settings)
+    {
+        const std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (input));
+
+        if (reader == nullptr)
+            return "Could not read " + input.getFullPathName();
+
+        if (reader->numChannels > 2)
+            return input.getFileName() + " has more than two channels";
+
+        auto* format = formats.findFormatForFileExtension (input.getFileExtension());
+
+        if (format == nullptr || ! (format->getFormatName() == "WAV file" || format->getFormatName() == "AIFF file"))
+            format = formats.findFormatForFileExtension (".wav");
+
+        const auto output = getOutputFile (input, settings);
+        output.getParentDirectory().createDirectory();
+
+        // rendered next to the output and moved over it once complete, so a
+        // failure leaves any previous result in place
+        const juce::TemporaryFile temporary (output);
+        auto stream = std::make_unique<juce::FileOutputStream> (temporary.getFile());
+
+        if (stream->failedToOpen())
+            return "Could not write " + temporary.getFile().getFullPathName();
+
+        const auto possibleDepths = format->getPossibleBitDepths();
+        const auto bitDepth = possibleDepths.contains ((int) reader->bitsPerSample) ? (int) reader->bitsPerSample : 24;
+
+        // the writer owns the stream once it exists
+        std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(), reader->sampleRate, 2, bitDepth, {}, 0));
+
+        if (writer == nullptr)
+            return "No " + juce::String (bitDepth) + " bit stereo " + format->getFormatName() + " writer for " + output.getFullPathName();
+
+        stream.release();
+
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+
+        if (settings.doublePrecision)
+            Render::renderStream<double> (processor, *reader, *writer, settings.blockSize, settings.includeTail);
+        else
+            Render::renderStream<float> (processor, *reader, *writer, settings.blockSize, settings.includeTail);
+
+        // flushes and closes the file before it is moved into place
+        writer.reset();
+
+        if (! temporary.overwriteTargetFileWithTemporary())
+            return "Could not replace " + output.getFullPathName();
+
+        const auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+        const auto audioSeconds = static_cast<double> (reader->lengthInSamples) / reader->sampleRate;
+
+        std::cout << input.getFileName() << " -> " << output.getFullPathName() << " (" << juce::String (audioSeconds, 1) << " s in "
+                  << juce::String (seconds, 1) << " s, " << juce::String (audioSeconds / juce::jmax (seconds, 1.0e-3), 1) << "x real time)"
+                  << std::endl;
+
+        return {};
+    }
+
+    //==============================================================================
+    /** Renders files from the shared queue with its own processor until none are left. */
+    class RenderWorker : public juce::ThreadPoolJob
+    {
+    public:
+        RenderWorker (PluginProcessor& processorToUse, const Settings& settingsToUse,
+                      std::atomic<int>& nextInputToUse, std::atomic<int>& numFailedToUse, std::atomic<int>& numRunningToUse)
+            : juce::ThreadPoolJob ("Render worker"),
+              processor (processorToUse),
+              settings (settingsToUse),
+              nextInput (nextInputToUse),
+              numFailed (numFailedToUse),
+              numRunning (numRunningToUse)
+        {
+            formats.registerBasicFormats();
+        }
+
+        JobStatus runJob() override
+        {
+            for (int index = nextInput++; index < settings.inputs.size() && ! shouldExit(); index = nextInput++)
+            {
+                const auto error = renderFile (processor, formats, settings.inputs[index], settings);
+
+                if (error.isNotEmpty())
+                {
+                    std::cerr << "Error: " << error << std::endl;
+                    ++numFailed;
+                }
+            }
+
+            // the last worker to finish ends main()'s message loop
+            if (--numRunning == 0)
+                juce::MessageManager::getInstance()->stopDispatchLoop();
+
+            return jobHasFinished;
+        }
+
+    private:
+        PluginProcessor& processor;
+        const Settings& settings;
+        std::atomic<int>& nextInput;
+        std::atomic<int>& numFailed;
+        std::atomic<int>& numRunning;
+        juce::AudioFormatManager formats;
+    };
+}
+
+int main (int argc, char* argv[])
+{
+    // the processor uses timers and value trees, which expect JUCE to be up
+    juce::ScopedJuceInitialiser_GUI juce;
+
+    const juce::ArgumentList args (argc, argv);
+
+    if (args.size() == 0 || args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return args.size() == 0 ? 1 : 0;
+    }
+
+    Settings settings;
+
+    if (const auto error = parseArguments (args, settings); error.isNotEmpty())
+    {
+        std::cerr << "Error: " << error << "\n";
+        printUsage();
+        return 1;
+    }
+
+    // processors are created, configured and destroyed here on the message thread, as their timers expect;
+    // the workers only borrow one each, and their preset managers share one scanner
+    std::vector<std::unique_ptr<PluginProcessor>> processors;
+
+    for (int job = 0; job < settings.numJobs; ++job)
+    {
+        auto& processor = *processors.emplace_back (std::make_unique<PluginProcessor>());
+
+        if (const auto error = applySettings (processor, settings); error.isNotEmpty())
+        {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+    }
+
+    std::atomic<int> nextInput { 0 }, numFailed { 0 }, numRunning { settings.numJobs };
+    juce::ThreadPool pool (settings.numJobs);
+
+    for (auto& processor : processors)
+        pool.addJob (new RenderWorker (*processor, settings, nextInput, numFailed, numRunning), true);
+
+    // the processors' timers and async updates run here while the workers render;
+    // the last worker stops the loop, which also works if it finished first
+    juce::MessageManager::getInstance()->runDispatchLoop();
+
+    return numFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+/* The streaming part of the offline renderer (Main.cpp), on its own so the
+ * tests can render through it without files or a command line.
+ */
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+namespace Render
+{
+    /**
+     * Streams the reader through the processor into the writer, block by block,
+     * in the given precision. The first latency samples of output are dropped
+     * and made up for with as much silence at the end, so the output lines up
+     * with the input and is as long, plus the processor's tail if asked for.
+     * Mono input is fed to both channels; the output is always stereo.
+     */
+    template <typename SampleType>
+    void renderStream (juce::AudioProcessor& processor, juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer,
+                       int blockSize, bool includeTail)
+    {
+        const auto sampleRate = reader.sampleRate;
+
+        processor.setProcessingPrecision (std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                             : juce::AudioProcessor::singlePrecision);
+        processor.setNonRealtime (true);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        const auto latency = static_cast<juce::int64> (processor.getLatencySamples());
+        const auto tail = includeTail ? static_cast<juce::int64> (std::ceil (processor.getTailLengthSeconds() * sampleRate)) : 0;
+        const auto outputLength = reader.lengthInSamples + tail;
+
+        juce::AudioBuffer<float> io (2, blockSize);
+        juce::AudioBuffer<SampleType> processing (2, blockSize);
+        juce::MidiBuffer midi;
+
+        juce::int64 inputPosition = 0, written = 0, toSkip = latency;
+
+        while (written < outputLength)
+        {
+            const auto numInput = static_cast<int> (juce::jlimit<juce::int64> (0, blockSize, reader.lengthInSamples - inputPosition));
+
+            io.clear();
+
+            // a mono reader fills both channels
+            if (numInput > 0)
+                reader.read (&io, 0, numInput, inputPosition, true, true);
+
+            inputPosition += blockSize;
+
+            if constexpr (std::is_same_v<SampleType, double>)
+            {
+                processing.makeCopyOf (io, true);
+                processor.processBlock (processing, midi);
+                io.makeCopyOf (processing, true);
+            }
+            else
+            {
+                processor.processBlock (io, midi);
+            }
+
+            const auto skipped = static_cast<int> (juce::jmin<juce::int64> (toSkip, blockSize));
+            toSkip -= skipped;
+
+            const auto numOutput = static_cast<int> (juce::jmin<juce::int64> (blockSize - skipped, outputLength - written));
+
+            if (numOutput > 0)
+            {
+                writer.writeFromAudioSampleBuffer (io, skipped, numOutput);
+                written += numOutput;
+            }
+        }
+
+        processor.releaseResources();
+    }
+}
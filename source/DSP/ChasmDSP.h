@@ -4,20 +4,24 @@
  * Main DSP header for PluginTemplate - includes all DSP components.
  * 
  * This header provides easy access to all DSP functionality:
- * - Schroeder Allpass Filter Chain for reverb/delay effects
+ * - Schroeder Allpass Filter Chain for reverb/delay effects (scalar and lane-packed)
  * - Stereo Enhancer for width control and frequency-dependent processing
  * - Parameter smoothing utilities
  */
 
 // Utility classes
 #include "Utils/ParameterSmoother.h"
+#include "Utils/Saturation.h"
+#include "Utils/VectorOps.h"
 
 // Filter components
 #include "Filters/AllpassFilter.h"
 #include "Filters/SchroederAllpassChain.h"
+#include "Filters/PackedSchroederAllpassChain.h"
 
 // Effect components
 #include "Effects/StereoEnhancer.h"
+#include "Effects/Limiter.h"
 
 // Core DSP processor
 #include "Core/ChasmDSPProcessor.h"
@@ -39,6 +43,11 @@ using DoubleAllpassFilter = Filters::AllpassFilter<double>;
 using FloatAllpassChain = Filters::SchroederAllpassChain<float>;
 using DoubleAllpassChain = Filters::SchroederAllpassChain<double>;
 
+using FloatStereoAllpassChain = Filters::PackedSchroederAllpassChain<float, 2>;
+using DoubleStereoAllpassChain = Filters::PackedSchroederAllpassChain<double, 2>;
+using FloatQuadAllpassChain = Filters::PackedSchroederAllpassChain<float, 4>;
+using DoubleQuadAllpassChain = Filters::PackedSchroederAllpassChain<double, 4>;
+
 using FloatStereoEnhancer = Effects::StereoEnhancer<float>;
 using DoubleStereoEnhancer = Effects::StereoEnhancer<double>;
 
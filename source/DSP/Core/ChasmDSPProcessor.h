@@ -3,15 +3,23 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include <array>
+#include <atomic>
+#include <optional>
+#include <utility>
+
 // DSP Components
 #include "../Effects/MakeItLoud.h"
 #include "../Effects/StereoEnhancer.h"
-#include "../Effects/StereoEnhancer.h"
 #include "../Effects/HaasEffect.h"
+#include "../Filters/DelayLine.h"
 #include "../Filters/EQFilters.h"
-#include "../Filters/SchroederAllpassChain.h"
+#include "../Filters/PackedSchroederAllpassChain.h"
+#include "../Utils/CpuDispatch.h"
 #include "../Utils/DSPUtils.h"
-#include "../Utils/ParameterSmoother.h"
+#include "../Utils/SmootherBank.h"
+#include "../Utils/StageProfiler.h"
+#include "../Utils/VectorOps.h"
 
 namespace DSP
 {
@@ -22,357 +30,765 @@ namespace DSP
         class ChasmDSPProcessor
         {
         public:
+            /** Smoothed parameters, in the units setParameter() expects. */
+            enum class Parameter
+            {
+                inputGain,    ///< dB
+                outputGain,   ///< dB
+                mix,          ///< percent
+                delay,        ///< ms
+                brightness,   ///< dB
+                character,    ///< 0.1 - 10
+                lowCut,       ///< Hz, <= 1 is off
+                highCut,      ///< Hz, >= 19999 is off
+                width,        ///< percent
+                haas,         ///< ms
+                milInputGain, ///< dB
+                milBoost,     ///< dB
+                numParameters
+            };
+
+            static constexpr size_t numParameters = static_cast<size_t> (Parameter::numParameters);
+
+            /** Parts of processBlock() timed separately when CHASM_STAGE_PROFILING is on. */
+            enum class Stage
+            {
+                parameters,      ///< smoother ramps and coefficient updates
+                inputAndAllpass, ///< input gain and the allpass chains
+                cutFilters,
+                brightnessEQ,
+                haasEffect,
+                stereoEnhancer,
+                makeItLoud,
+                mix,             ///< dry delay, mix and output gain; at a settled 0% mix, all that runs
+                numStages
+            };
+
+            static constexpr size_t numStages = static_cast<size_t> (Stage::numStages);
+
+            static const char* getStageName (Stage stage)
+            {
+                switch (stage)
+                {
+                    case Stage::parameters: return "parameters";
+                    case Stage::inputAndAllpass: return "input gain + allpass";
+                    case Stage::cutFilters: return "cut filters";
+                    case Stage::brightnessEQ: return "brightness EQ";
+                    case Stage::haasEffect: return "Haas effect";
+                    case Stage::stereoEnhancer: return "stereo enhancer";
+                    case Stage::makeItLoud: return "MakeItLoud";
+                    case Stage::mix: return "mix";
+                    case Stage::numStages: break;
+                }
+
+                return "";
+            }
+
+            using OversamplingFilter = typename Effects::MakeItLoud<SampleType>::OversamplingFilter;
+
             ChasmDSPProcessor()
             {
-                using FilterType = juce::dsp::StateVariableTPTFilterType;
+                using FilterType = typename Filters::CutFilter<SampleType>::Type;
 
                 lowCutFilter.setType (FilterType::highpass);
                 highCutFilter.setType (FilterType::lowpass);
 
                 lowCutFilter.setResonance (static_cast<SampleType> (0.707));
                 highCutFilter.setResonance (static_cast<SampleType> (0.707));
+
+                smoothers.setSmoothingTime (Parameter::inputGain, 1.0);
+                smoothers.setSmoothingTime (Parameter::outputGain, 1.0);
+                smoothers.setSmoothingTime (Parameter::mix, 5.0);
+                smoothers.setSmoothingTime (Parameter::delay, 5.0);
+                smoothers.setSmoothingTime (Parameter::brightness, 5.0);
+                smoothers.setSmoothingTime (Parameter::character, 5.0);
+                smoothers.setSmoothingTime (Parameter::lowCut, 5.0);
+                smoothers.setSmoothingTime (Parameter::highCut, 5.0);
+                smoothers.setSmoothingTime (Parameter::width, 5.0);
+                smoothers.setSmoothingTime (Parameter::haas, 1.0);
+                smoothers.setSmoothingTime (Parameter::milInputGain, 1.0);
+                smoothers.setSmoothingTime (Parameter::milBoost, 1.0);
+
+                setParameter (Parameter::inputGain, SampleType { 0.0 });
+                setParameter (Parameter::outputGain, SampleType { 0.0 });
+                setParameter (Parameter::mix, SampleType { 50.0 });
+                setParameter (Parameter::delay, SampleType { 30.0 });
+                setParameter (Parameter::brightness, SampleType { 0.0 });
+                setParameter (Parameter::character, SampleType { 1.0 });
+                setParameter (Parameter::lowCut, SampleType { 0.0 });
+                setParameter (Parameter::highCut, SampleType { 20000.0 });
+                setParameter (Parameter::width, SampleType { 100.0 });
+                setParameter (Parameter::haas, SampleType { 0.0 });
+                setParameter (Parameter::milInputGain, SampleType { 0.0 });
+                setParameter (Parameter::milBoost, SampleType { 0.0 });
+                smoothers.snapToTargetValues();
             }
 
-            void prepare (const juce::dsp::ProcessSpec& spec,
-                          SampleType inputGain = SampleType{1.0},
-                          SampleType outputGain = SampleType{1.0},
-                          SampleType mix = SampleType{0.5},
-                          SampleType delayMs = SampleType{30.0},
-                          SampleType brightness = SampleType{0.0},
-                          SampleType character = SampleType{1.0},
-                          SampleType lowCut = SampleType{0.0},
-                          SampleType highCut = SampleType{0.0},
-                          SampleType width = SampleType{100.0},
-                          SampleType mil_InputGain = SampleType{1.0},
-                          SampleType mil_BoostValue = SampleType{0.0},
-                          int mil_Mode = 0,
-                          SampleType haasAmount = SampleType{0.0})
+            /**
+             * Allocates everything for the given spec. Parameters set before this
+             * call are applied immediately, without ramping.
+             */
+            void prepare (const juce::dsp::ProcessSpec& spec)
             {
                 sampleRate = spec.sampleRate;
                 samplesPerBlock = static_cast<int> (spec.maximumBlockSize);
                 numChannels = static_cast<int> (spec.numChannels);
 
-                leftAllpassChain.prepare (sampleRate, delayMs, character);
-                rightAllpassChain.prepare (sampleRate, delayMs, character);
+                smoothers.prepare (sampleRate, samplesPerBlock);
+
+                allpassChain.prepare (sampleRate, smoothers.getTargetValue (Parameter::delay), smoothers.getTargetValue (Parameter::character));
                 brightnessEQ.prepare (spec);
 
                 stereoEnhancer.setWidth (SampleType { 100.0 });
 
                 haasEffect.prepare(sampleRate, samplesPerBlock);
 
-                prepareParameterSmoothers();
-
-                // Snap all smoothers to current values to avoid ramping artifacts
-                inputGainSmoother.setTargetValue(inputGain);
-                inputGainSmoother.snapToTargetValue();
-                outputGainSmoother.setTargetValue(outputGain);
-                outputGainSmoother.snapToTargetValue();
-                mixSmoother.setTargetValue(mix);
-                mixSmoother.snapToTargetValue();
-                delaySmoother.setTargetValue(delayMs);
-                delaySmoother.snapToTargetValue();
-                brightnessSmoother.setTargetValue(brightness);
-                brightnessSmoother.snapToTargetValue();
-                characterSmoother.setTargetValue(character);
-                characterSmoother.snapToTargetValue();
-                lowCutSmoother.setTargetValue(lowCut);
-                lowCutSmoother.snapToTargetValue();
-                highCutSmoother.setTargetValue(highCut);
-                highCutSmoother.snapToTargetValue();
-                widthSmoother.setTargetValue(width);
-                widthSmoother.snapToTargetValue();
-                haasSmoother.setTargetValue(haasAmount);
-                haasSmoother.snapToTargetValue();
-                mil_InputGainSmoother.setTargetValue(mil_InputGain);
-                mil_InputGainSmoother.snapToTargetValue();
-                mil_BoostSmoother.setTargetValue(mil_BoostValue);
-                mil_BoostSmoother.snapToTargetValue();
-                makeItLoud.setCompressorMode(mil_Mode);
-
                 wetBuffer.setSize (numChannels, samplesPerBlock);
-                dryBuffer.setSize (numChannels, samplesPerBlock);
 
-                lowCutFilter.prepare (spec);
-                lowCutFilter.reset();
+                lowCutMax = static_cast<SampleType> (sampleRate * 0.5 - 1.0);
+                highCutMax = static_cast<SampleType> (sampleRate * 0.5 - 1.0);
 
+                lowCutFilter.prepare (spec);
                 highCutFilter.prepare (spec);
-                highCutFilter.reset();
 
                 makeItLoud.prepare (spec);
 
-                reset(inputGain, outputGain, mix, delayMs, brightness, character, lowCut, highCut, width, mil_InputGain, mil_BoostValue, mil_Mode, haasAmount);
+                // the dry signal is delayed to line up with the oversampled MakeItLoud
+                dryDelays.resize (spec.numChannels);
+
+                for (auto& delay : dryDelays)
+                    delay.prepare (makeItLoud.getMaximumLatencySamples());
+
+                dryDelaySamples = -1;
+
+                instructionSet = forcedInstructionSet.value_or (Utils::CpuDispatch::getBestInstructionSet());
+
+                reset();
+            }
+
+            /** Sets a parameter's target value; it is smoothed from the next block on. */
+            void setParameter (Parameter parameter, SampleType value)
+            {
+                switch (parameter)
+                {
+                    case Parameter::inputGain:
+                    case Parameter::outputGain:
+                    case Parameter::milInputGain:
+                    case Parameter::milBoost:
+                        value = Utils::DSPUtils::dbToGain (value);
+                        break;
+
+                    case Parameter::mix:
+                        value = Utils::DSPUtils::percentageToNormalized (value);
+                        break;
+
+                    default:
+                        break;
+                }
+
+                smoothers.setTargetValue (parameter, value);
+            }
+
+            /** 0 = MakeItLoud off, 1 = Clean, 2 = Further, 3 = Crunchy. */
+            void setCompressorMode (int mode)
+            {
+                if (mode != compressorMode)
+                {
+                    compressorMode = mode;
+                    makeItLoud.setCompressorMode (mode);
+                }
+            }
+
+            /**
+             * Oversampling around the MakeItLoud waveshaper, real-time safe once
+             * prepared. factorIndex 0 = off, 1 = 2x, 2 = 4x, 3 = 8x.
+             */
+            void setOversampling (int factorIndex, OversamplingFilter filter)
+            {
+                makeItLoud.setOversampling (factorIndex, filter);
+            }
+
+            /**
+             * Selects between the specialised cut filter kernels (the default) and
+             * the generic one that checks every filter's state per sample. Both give
+             * the same output; this exists for benchmarks and tests.
+             */
+            void setUseSpecialisedKernels (bool shouldUseSpecialisedKernels) noexcept
+            {
+                useSpecialisedKernels = shouldUseSpecialisedKernels;
+            }
+
+            /**
+             * Selects whether a mix settled at 0% or 100% skips the inaudible path
+             * (the default) or both paths always run and get mixed. The output is
+             * the same while the mix is settled; this exists for benchmarks and tests.
+             */
+            void setUseMixFastPaths (bool shouldUseMixFastPaths) noexcept
+            {
+                useMixFastPaths = shouldUseMixFastPaths;
+            }
+
+            /**
+             * Runs the given instruction set's variant instead of the best one this
+             * CPU supports, which prepare() picks otherwise. It must be supported
+             * here; this exists for tests and benchmarks.
+             */
+            void setInstructionSet (Utils::InstructionSet newInstructionSet)
+            {
+                jassert (Utils::CpuDispatch::isSupported (newInstructionSet));
+
+                forcedInstructionSet = newInstructionSet;
+                instructionSet = newInstructionSet;
+            }
+
+            /** The instruction set processBlock() runs with. */
+            Utils::InstructionSet getInstructionSet() const noexcept
+            {
+                return instructionSet;
+            }
+
+            /** Latency the host should compensate for, in samples. */
+            int getLatencySamples() const
+            {
+                return makeItLoud.getLatencySamples();
             }
 
-            void updateParameters (SampleType inputGainDb, SampleType outputGainDb, SampleType mixPercent, SampleType delayMs, SampleType brightnessDb, SampleType characterQ, SampleType lowCutPercent, SampleType highCutPercent, SampleType widthPercent, SampleType mil_InputGain, SampleType mil_BoostValue, int mil_Mode, SampleType haasAmount)
+            /**
+             * How long the output keeps ringing after the input stops, in seconds,
+             * until it is below -120 dB. Derived from the current allpass delay and
+             * character, the Haas delay and the cut filters' ring-out; latency is
+             * not included. Safe to call from any thread.
+             */
+            double getTailLengthSeconds() const
             {
-                inputGainSmoother.setTargetValue (Utils::DSPUtils::dbToGain (inputGainDb));
-                outputGainSmoother.setTargetValue (Utils::DSPUtils::dbToGain (outputGainDb));
-                mixSmoother.setTargetValue (Utils::DSPUtils::percentageToNormalized (mixPercent));
-                delaySmoother.setTargetValue (delayMs);
-                brightnessSmoother.setTargetValue (brightnessDb);
-                characterSmoother.setTargetValue (characterQ);
-                lowCutSmoother.setTargetValue (lowCutPercent);
-                highCutSmoother.setTargetValue (highCutPercent);
-                widthSmoother.setTargetValue (widthPercent);
+                return tailLengthSeconds.load (std::memory_order_relaxed);
+            }
 
-                haasSmoother.setTargetValue(haasAmount);
+           #if CHASM_STAGE_PROFILING
+            /** Time spent per Stage since the last reset; read and reset from any thread. */
+            Utils::StageProfiler<numStages>& getStageProfiler() noexcept
+            {
+                return stageProfiler;
+            }
+           #endif
 
-                mil_BoostSmoother.setTargetValue (Utils::DSPUtils::dbToGain (mil_BoostValue));
-                mil_InputGainSmoother.setTargetValue (Utils::DSPUtils::dbToGain (mil_InputGain));
-                makeItLoud.setCompressorMode (mil_Mode);
+            /** True while the input is silent and the tail has died away, so processing is skipped. */
+            bool isSleeping() const noexcept
+            {
+                return sleeping;
             }
 
+            /**
+             * Whether the processor may sleep on silent input (the default). With
+             * false every chunk is processed; this exists for tests and benchmarks.
+             */
+            void setCanSleep (bool shouldBeAbleToSleep) noexcept
+            {
+                canSleep = shouldBeAbleToSleep;
+                sleeping = sleeping && canSleep;
+            }
+
+            /**
+             * Processes the buffer in chunks of at most the prepared block size,
+             * so the preallocated buffers are never resized on the audio thread.
+             *
+             * All smoothers are rendered for the whole chunk at once. Input gain,
+             * mix, output gain and the cut frequencies are applied per sample from
+             * their ramps, while delay, brightness, character, width and Haas are
+             * sampled at the start of each subBlockSize sub-block.
+             *
+             * Tolerance: while those control-rate parameters are settled, the
+             * output is independent of how the host splits the buffer; any block
+             * size matches processing one sample at a time to within 1e-6 max abs
+             * for float and 1e-12 for double (bit for bit in practice, the bound
+             * leaves room for the compiler contracting the two loops differently).
+             * tests/BlockProcessing.cpp checks this.
+             *
+             * While the mix is settled at 0% the wet path is skipped entirely and
+             * restarts from silence when the mix moves again; at 100% the dry
+             * delay and mix are skipped.
+             *
+             * Once the input has been below silenceThreshold for longer than the
+             * tail (plus latency), the processor sleeps: silent chunks are cleared
+             * without running any DSP until a chunk with signal arrives. The
+             * filters have rung out by then, so processing just resumes.
+             *
+             * The DSP itself runs in the variant compiled for getInstructionSet().
+             */
             void processBlock (juce::AudioBuffer<SampleType>& buffer)
             {
                 jassert (buffer.getNumChannels() >= 1);
+                jassert (wetBuffer.getNumSamples() > 0); // call prepare() first
+
+                if (wetBuffer.getNumSamples() == 0)
+                    return;
 
                 const int numSamples = buffer.getNumSamples();
 
-                if (wetBuffer.getNumSamples() != numSamples)
+                for (int start = 0; start < numSamples; start += samplesPerBlock)
                 {
-                    wetBuffer.setSize (numChannels, numSamples, false, false, true);
-                    dryBuffer.setSize (numChannels, numSamples, false, false, true);
-                }
+                    const int chunkLength = juce::jmin (samplesPerBlock, numSamples - start);
+                    juce::AudioBuffer<SampleType> chunk (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, chunkLength);
 
-                dryBuffer.makeCopyOf (buffer);
+                    if (chunk.getMagnitude (0, chunkLength) <= silenceThreshold)
+                    {
+                        if (sleeping)
+                        {
+                            chunk.clear();
+                            continue;
+                        }
 
-                for (int i = 0; i < numSamples; ++i)
-                {
-                    const auto inputGain = inputGainSmoother.getNextValue();
-                    const auto delay = delaySmoother.getNextValue();
-                    const auto brightness = brightnessSmoother.getNextValue();
-                    const auto character = characterSmoother.getNextValue();
-                    const auto width = widthSmoother.getNextValue();
-                    const auto haasAmount = haasSmoother.getNextValue();
-
-                    auto lowCutFreq = lowCutSmoother.getNextValue();
-                    if (!juce::approximatelyEqual (lowCutFreq, lastLowCut))
+                        silentSamples += chunkLength;
+                    }
+                    else
                     {
-                        lowCutFreq = juce::jlimit(lowCutMin, lowCutMax, lowCutFreq);
-                        lowCutFilter.setCutoffFrequency (lowCutFreq);
-                        lowCutActive = lowCutFreq > SampleType { 1.0 };
-                        lastLowCut = lowCutFreq;
+                        sleeping = false;
+                        silentSamples = 0;
                     }
 
-                    auto highCutFreq = highCutSmoother.getNextValue();
-                    if (!juce::approximatelyEqual (highCutFreq, lastHighCut))
+                    switch (instructionSet)
                     {
-                        highCutFreq = juce::jlimit(highCutMin, highCutMax, highCutFreq);
-                        highCutFilter.setCutoffFrequency (highCutFreq);
-                        highCutActive = highCutFreq < SampleType { 19999.0 };
-                        lastHighCut = highCutFreq;
+                        case Utils::InstructionSet::avx512: processChunkAvx512 (chunk); break;
+                        case Utils::InstructionSet::avx2:   processChunkAvx2 (chunk); break;
+                        default:                            processChunkBaseline (chunk); break;
                     }
 
-                    if (i == 0 || shouldUpdateDSPComponents (i))
-                        updateDSPComponents (delay, brightness, character, width, haasAmount);
+                    sleeping = canSleep && silentSamples > tailLengthSamples + makeItLoud.getLatencySamples();
+                }
+            }
 
-                    if (buffer.getNumChannels() == 1)
-                    {
-                        // mono
-                        processSingleSampleMono (buffer, i, inputGain);
-                    }
-                    else
-                    {
-                        // something other than mono, assume stereo
-                        processSingleSample (buffer, i, inputGain);
-                    }
+            /** Clears all filter state and jumps every parameter to its target. */
+            void reset()
+            {
+                smoothers.snapToTargetValues();
+
+                resetWetPath (smoothers.getTargetValue (Parameter::delay),
+                              smoothers.getTargetValue (Parameter::character),
+                              smoothers.getTargetValue (Parameter::haas));
+
+                for (auto& delay : dryDelays)
+                    delay.reset();
+
+                wetPathIdle = false;
+                dryPathIdle = false;
+
+                sleeping = false;
+                silentSamples = 0;
+                updateTailLength (smoothers.getTargetValue (Parameter::delay),
+                                  smoothers.getTargetValue (Parameter::character),
+                                  smoothers.getTargetValue (Parameter::haas));
+            }
+
+        private:
+            /**
+             * processChunk() with every kernel below it (smoother ramps, input
+             * gain, allpass chain, cut filters, brightness EQ, Haas delay, M/S
+             * width, waveshaper, dry delay, mix and output gain) inlined and
+             * compiled for one instruction set, see CpuDispatch.h.
+             */
+            CHASM_TARGET_BASELINE void processChunkBaseline (juce::AudioBuffer<SampleType>& buffer) { processChunk (buffer); }
+            CHASM_TARGET_AVX2 void processChunkAvx2 (juce::AudioBuffer<SampleType>& buffer) { processChunk (buffer); }
+            CHASM_TARGET_AVX512 void processChunkAvx512 (juce::AudioBuffer<SampleType>& buffer) { processChunk (buffer); }
+
+            void processChunk (juce::AudioBuffer<SampleType>& buffer)
+            {
+                const int numSamples = buffer.getNumSamples();
+                const int numWetChannels = juce::jmin (wetBuffer.getNumChannels(), buffer.getNumChannels());
+
+                // view of the first numSamples of the preallocated wet buffer, no allocation
+                juce::AudioBuffer<SampleType> wet (wetBuffer.getArrayOfWritePointers(), wetBuffer.getNumChannels(), numSamples);
+
+                for (int channel = numWetChannels; channel < wet.getNumChannels(); ++channel)
+                    wet.clear (channel, 0, numSamples);
+
+                // A mix settled at exactly 0 or 1 makes one path inaudible for the whole chunk
+                const bool mixSettled = useMixFastPaths && ! smoothers.isSmoothing (Parameter::mix);
+                const bool dryOnly = mixSettled && smoothers.getTargetValue (Parameter::mix) <= SampleType { 0.0 };
+                const bool wetOnly = mixSettled && smoothers.getTargetValue (Parameter::mix) >= SampleType { 1.0 };
+
+                {
+                    CHASM_PROFILE_STAGE (stageProfiler, Stage::parameters, numSamples);
+                    smoothers.fillRamps (numSamples);
                 }
 
-                // After allpasschains to tr regain some high end.
-                brightnessEQ.processBlock (wetBuffer);
+                if (dryOnly)
+                {
+                    wetPathIdle = true;
 
-                // Apply stereo enhancement
-                haasEffect.processBlock(wetBuffer);
-                stereoEnhancer.processBlock (wetBuffer);
+                    // nothing gets mixed, but the dry delay and output gain are the mix stage's work
+                    CHASM_PROFILE_STAGE (stageProfiler, Stage::mix, numSamples);
+                    processDryDelay (buffer, numWetChannels);
+                    processOutputGain (buffer, numWetChannels);
+                    return;
+                }
 
-                // Apply MakeItLoud effect
-                makeItLoud.setInputGain (mil_InputGainSmoother.getNextValue());
-                makeItLoud.setBoost (mil_BoostSmoother.getNextValue());
-                makeItLoud.processBlock (wetBuffer);
+                // The wet state is stale after being skipped, so start it from
+                // silence; the mix ramps up from 0, which fades it back in.
+                if (wetPathIdle)
+                {
+                    resetWetPath (smoothers.getRamp (Parameter::delay)[0],
+                                  smoothers.getRamp (Parameter::character)[0],
+                                  smoothers.getRamp (Parameter::haas)[0]);
+                    wetPathIdle = false;
+                }
+
+                for (int start = 0; start < numSamples; start += subBlockSize)
+                {
+                    const int subBlockLength = juce::jmin (subBlockSize, numSamples - start);
+                    processSubBlockWet (buffer, wet, start, subBlockLength, numWetChannels);
+                }
 
-                for (int i = 0; i < numSamples; ++i)
+                // After allpasschains to tr regain some high end.
+                {
+                    CHASM_PROFILE_STAGE (stageProfiler, Stage::brightnessEQ, numSamples);
+                    brightnessEQ.processBlock (wet);
+                }
+
+                // Apply stereo enhancement, which needs a right channel
+                if (wet.getNumChannels() >= 2)
                 {
-                    const auto mix = mixSmoother.getNextValue();
-                    const auto outputGain = outputGainSmoother.getNextValue();
-                    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
                     {
-                        auto* channelData = buffer.getWritePointer (channel);
-                        const auto drySample = dryBuffer.getSample (channel, i);
-                        const auto wetSample = wetBuffer.getSample (channel, i);
-                        channelData[i] = (drySample * (SampleType { 1.0 } - mix) + wetSample * mix) * outputGain;
+                        CHASM_PROFILE_STAGE (stageProfiler, Stage::haasEffect, numSamples);
+                        haasEffect.processBlock(wet);
                     }
+
+                    CHASM_PROFILE_STAGE (stageProfiler, Stage::stereoEnhancer, numSamples);
+                    stereoEnhancer.processBlock (wet);
+                }
+
+                // Apply MakeItLoud effect
+                {
+                    CHASM_PROFILE_STAGE (stageProfiler, Stage::makeItLoud, numSamples);
+                    makeItLoud.setInputGain (smoothers.getRamp (Parameter::milInputGain)[0]);
+                    makeItLoud.setBoost (smoothers.getRamp (Parameter::milBoost)[0]);
+                    makeItLoud.processBlock (wet);
                 }
+
+                CHASM_PROFILE_STAGE (stageProfiler, Stage::mix, numSamples);
+
+                if (wetOnly)
+                {
+                    dryPathIdle = true;
+                    processWetOnly (buffer, wet, numWetChannels);
+                    return;
+                }
+
+                // likewise the dry delays, which only matter with oversampling
+                if (dryPathIdle)
+                {
+                    for (auto& delay : dryDelays)
+                        delay.reset();
+
+                    dryPathIdle = false;
+                }
+
+                // The input buffer is left untouched by the wet path, so it
+                // still holds the dry signal and can be mixed in place.
+                processDryDelay (buffer, numWetChannels);
+                processMix (buffer, wet, numWetChannels);
             }
 
-            void reset(SampleType inputGain = SampleType{1.0},
-                       SampleType outputGain = SampleType{1.0},
-                       SampleType mix = SampleType{0.5},
-                       SampleType delayMs = SampleType{30.0},
-                       SampleType brightness = SampleType{0.0},
-                       SampleType character = SampleType{1.0},
-                       SampleType lowCut = SampleType{0.0},
-                       SampleType highCut = SampleType{0.0},
-                       SampleType width = SampleType{100.0},
-                       SampleType mil_InputGain = SampleType{1.0},
-                       SampleType mil_BoostValue = SampleType{0.0},
-                       int mil_Mode = 0,
-                       SampleType haasAmount = SampleType{0.0})
-            {
-                leftAllpassChain.reset(delayMs, character);
-                rightAllpassChain.reset(delayMs, character);
+            /** Clears every stage of the wet path; the allpass chain and Haas delay restart at the given settings. */
+            void resetWetPath (SampleType delay, SampleType character, SampleType haasAmount)
+            {
+                allpassChain.reset (delay, character);
                 brightnessEQ.reset();
                 stereoEnhancer.reset();
+                haasEffect.reset (haasAmount);
+                lowCutFilter.reset();
+                highCutFilter.reset();
+                makeItLoud.reset();
 
-                inputGainSmoother.reset(inputGain);
-                inputGainSmoother.setTargetValue(inputGain);
-                inputGainSmoother.snapToTargetValue();
-                outputGainSmoother.reset(outputGain);
-                outputGainSmoother.setTargetValue(outputGain);
-                outputGainSmoother.snapToTargetValue();
-                mixSmoother.reset(mix);
-                mixSmoother.setTargetValue(mix);
-                mixSmoother.snapToTargetValue();
-                delaySmoother.reset(delayMs);
-                delaySmoother.setTargetValue(delayMs);
-                delaySmoother.snapToTargetValue();
-                brightnessSmoother.reset(brightness);
-                brightnessSmoother.setTargetValue(brightness);
-                brightnessSmoother.snapToTargetValue();
-                characterSmoother.reset(character);
-                characterSmoother.setTargetValue(character);
-                characterSmoother.snapToTargetValue();
-                lowCutSmoother.reset(lowCut);
-                lowCutSmoother.setTargetValue(lowCut);
-                lowCutSmoother.snapToTargetValue();
-                highCutSmoother.reset(highCut);
-                highCutSmoother.setTargetValue(highCut);
-                highCutSmoother.snapToTargetValue();
-                widthSmoother.reset(width);
-                widthSmoother.setTargetValue(width);
-                widthSmoother.snapToTargetValue();
-                haasSmoother.reset(haasAmount);
-                haasSmoother.setTargetValue(haasAmount);
-                haasSmoother.snapToTargetValue();
-                mil_BoostSmoother.reset(mil_BoostValue);
-                mil_BoostSmoother.setTargetValue(mil_BoostValue);
-                mil_BoostSmoother.snapToTargetValue();
-                mil_InputGainSmoother.reset(mil_InputGain);
-                mil_InputGainSmoother.setTargetValue(mil_InputGain);
-                mil_InputGainSmoother.snapToTargetValue();
-                makeItLoud.setCompressorMode(mil_Mode);
-            }
-
-        private:
-            void prepareParameterSmoothers()
-            {
-                inputGainSmoother.prepare (sampleRate, 1.0);
-                outputGainSmoother.prepare (sampleRate, 1.0);
-                mixSmoother.prepare (sampleRate, 5.0);
-                delaySmoother.prepare (sampleRate, 5.0);
-                brightnessSmoother.prepare (sampleRate, 5.0);
-                characterSmoother.prepare (sampleRate, 5.0);
-                lowCutSmoother.prepare (sampleRate, 5.0);
-                highCutSmoother.prepare (sampleRate, 5.0);
-                widthSmoother.prepare (sampleRate, 5.0);
-                haasSmoother.prepare (sampleRate, 1.0);
-
-                mil_BoostSmoother.prepare (sampleRate, 1.0);
-                mil_InputGainSmoother.prepare (sampleRate, 1.0);
+                componentsNeedUpdate = true;
             }
 
-            bool shouldUpdateDSPComponents (int sampleIndex) { return (sampleIndex % 32) == 0; }
-
             void updateDSPComponents (SampleType delay, SampleType brightness, SampleType character, SampleType width, SampleType haasAmount)
             {
-                leftAllpassChain.setDelayTime (delay);
-                rightAllpassChain.setDelayTime (delay);
-                leftAllpassChain.setCharacter (character);
-                rightAllpassChain.setCharacter (character);
+                allpassChain.setDelayTime (delay);
+                allpassChain.setCharacter (character);
                 brightnessEQ.setBrightness (brightness);
                 stereoEnhancer.setWidth (width);
                 haasEffect.setDelayMs(haasAmount);
+
+                updateTailLength (delay, character, haasAmount);
             }
 
-            void processSingleSample (juce::AudioBuffer<SampleType>& buffer, int sampleIndex, SampleType inputGain)
+            void updateTailLength (SampleType delay, SampleType character, SampleType haasAmount)
             {
-                for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-                    buffer.getWritePointer (channel)[sampleIndex] *= inputGain;
+                const auto seconds = Filters::PackedSchroederAllpassChain<SampleType, 2>::getTailLengthSeconds (delay, character)
+                                   + static_cast<double> (juce::jlimit (SampleType { 0.0 }, SampleType { 50.0 }, haasAmount)) * 0.001
+                                   + filterRingOutSeconds;
 
-                for (int channel = 0; channel < juce::jmin (wetBuffer.getNumChannels(), buffer.getNumChannels()); ++channel)
-                    wetBuffer.setSample (channel, sampleIndex, buffer.getSample (channel, sampleIndex));
+                tailLengthSamples = static_cast<juce::int64> (std::ceil (seconds * sampleRate));
+                tailLengthSeconds.store (seconds, std::memory_order_relaxed);
+            }
 
-                auto leftSample = wetBuffer.getSample (0, sampleIndex);
-                auto rightSample = wetBuffer.getSample (1, sampleIndex);
+            void updateCutFilters (SampleType lowCutFreq, SampleType highCutFreq)
+            {
+                // the requested values are kept, so a cutoff beyond the limits isn't re-applied every sample
+                if (!juce::approximatelyEqual (lowCutFreq, lastLowCut))
+                {
+                    lastLowCut = lowCutFreq;
+                    lowCutFreq = juce::jlimit(lowCutMin, lowCutMax, lowCutFreq);
+                    lowCutFilter.setCutoffFrequency (lowCutFreq);
+                    lowCutActive = lowCutFreq > SampleType { 1.0 };
+                }
 
-                leftSample = leftAllpassChain.processSample (leftSample);
-                rightSample = rightAllpassChain.processSample (rightSample);
+                if (!juce::approximatelyEqual (highCutFreq, lastHighCut))
+                {
+                    lastHighCut = highCutFreq;
+                    highCutFreq = juce::jlimit(highCutMin, highCutMax, highCutFreq);
+                    highCutFilter.setCutoffFrequency (highCutFreq);
+                    highCutActive = highCutFreq < SampleType { 19999.0 };
+                }
+            }
 
-                if (lowCutActive)
+            /** Input gain, allpass chains and cut filters for one sub-block, written into wet. */
+            void processSubBlockWet (const juce::AudioBuffer<SampleType>& buffer, juce::AudioBuffer<SampleType>& wet, int start, int length, int numWetChannels)
+            {
+                const std::array<SampleType, numControlParameters> controls {
+                    smoothers.getRamp (Parameter::delay)[start],
+                    smoothers.getRamp (Parameter::brightness)[start],
+                    smoothers.getRamp (Parameter::character)[start],
+                    smoothers.getRamp (Parameter::width)[start],
+                    smoothers.getRamp (Parameter::haas)[start]
+                };
+
+                // Once everything has settled the components already hold the final
+                // values, so skip the coefficient work.
+                if (componentsNeedUpdate || controls != appliedControls)
                 {
-                    leftSample = lowCutFilter.processSample (0, leftSample);
-                    rightSample = lowCutFilter.processSample (1, rightSample);
+                    CHASM_PROFILE_STAGE (stageProfiler, Stage::parameters, 0);
+                    updateDSPComponents (controls[0], controls[1], controls[2], controls[3], controls[4]);
+                    appliedControls = controls;
+                    componentsNeedUpdate = false;
                 }
 
-                if (highCutActive)
+                const auto* inputGain = smoothers.getRamp (Parameter::inputGain) + start;
+                const auto* lowCut = smoothers.getRamp (Parameter::lowCut) + start;
+                const auto* highCut = smoothers.getRamp (Parameter::highCut) + start;
+
+                // only the first two channels go through the allpass chain and cut filters
+                const int numLaneChannels = juce::jmin (numWetChannels, 2);
+                std::array<SampleType*, 2> lanes {};
+
                 {
-                    leftSample = highCutFilter.processSample (0, leftSample);
-                    rightSample = highCutFilter.processSample (1, rightSample);
+                    CHASM_PROFILE_STAGE (stageProfiler, Stage::inputAndAllpass, length);
+
+                    for (int channel = 0; channel < numWetChannels; ++channel)
+                    {
+                        auto* wetChannel = wet.getWritePointer (channel, start);
+                        Utils::VectorOps::multiply (wetChannel, buffer.getReadPointer (channel, start), inputGain, length);
+
+                        if (channel < numLaneChannels)
+                            lanes[(size_t) channel] = wetChannel;
+                    }
+
+                    allpassChain.processBlock (lanes.data(), numLaneChannels, length);
                 }
 
-                wetBuffer.setSample (0, sampleIndex, leftSample);
-                wetBuffer.setSample (1, sampleIndex, rightSample);
+                if (numLaneChannels == 0)
+                    return;
+
+                CHASM_PROFILE_STAGE (stageProfiler, Stage::cutFilters, length);
+
+                // Settled cutoffs leave the filters' on/off state fixed for the whole
+                // sub-block, so a kernel specialised for it can run; moving cutoffs
+                // need the generic, per-frame one.
+                auto features = static_cast<unsigned> (cutoffModulation);
+
+                if (useSpecialisedKernels && ! cutoffsMove (lowCut, highCut, length))
+                    features = (lowCutActive ? lowCutFeature : 0u) | (highCutActive ? highCutFeature : 0u);
+
+                if (numLaneChannels == 1)
+                    runCutKernel<1> (features, lanes.data(), lowCut, highCut, length);
+                else
+                    runCutKernel<2> (features, lanes.data(), lowCut, highCut, length);
             }
 
-            void processSingleSampleMono (juce::AudioBuffer<SampleType>& buffer, int sampleIndex, SampleType inputGain)
+            /** True if updateCutFilters() would change anything during these ramps (which are monotonic). */
+            bool cutoffsMove (const SampleType* lowCut, const SampleType* highCut, int length) const
             {
-                buffer.getWritePointer (0)[sampleIndex] *= inputGain;
-                // since we setup the wetbuffer using numChannels, we dont need to worry about having more than one in mono
-                wetBuffer.setSample (0, sampleIndex, buffer.getSample (0, sampleIndex));
+                return ! juce::approximatelyEqual (lowCut[0], lastLowCut) || ! juce::approximatelyEqual (lowCut[length - 1], lastLowCut)
+                    || ! juce::approximatelyEqual (highCut[0], lastHighCut) || ! juce::approximatelyEqual (highCut[length - 1], lastHighCut);
+            }
+
+            /**
+             * Runs the cut filters over NumChannels lanes.
+             *
+             * With cutoffModulation the cutoffs are updated frame by frame, to pick
+             * up changes at the exact sample (the filters share their coefficients
+             * between channels), and the on/off state is checked per sample. Without
+             * it the coefficients are fixed and Features says which filters run, each
+             * as one block loop without branches over a fixed channel count.
+             */
+            template <int NumChannels, unsigned Features>
+            void processCutFilters (SampleType* const* lanes, const SampleType* lowCut, const SampleType* highCut, int length)
+            {
+                if constexpr ((Features & cutoffModulation) != 0)
+                {
+                    for (int i = 0; i < length; ++i)
+                    {
+                        updateCutFilters (lowCut[i], highCut[i]);
+
+                        for (int channel = 0; channel < NumChannels; ++channel)
+                        {
+                            auto& sample = lanes[channel][i];
 
-                SampleType workSample = wetBuffer.getSample (0, sampleIndex);
-                workSample = leftAllpassChain.processSample (workSample); // default to left since in mono does it even matter
+                            if (lowCutActive)
+                                sample = lowCutFilter.processSample (channel, sample);
 
-                if (lowCutActive)
+                            if (highCutActive)
+                                sample = highCutFilter.processSample (channel, sample);
+                        }
+                    }
+                }
+                else
+                {
+                    juce::ignoreUnused (lowCut, highCut);
+
+                    // The stages are independent, so running one over the whole
+                    // sub-block before the other gives the same samples.
+                    if constexpr ((Features & lowCutFeature) != 0)
+                        lowCutFilter.template processBlock<NumChannels> (lanes, length);
+
+                    if constexpr ((Features & highCutFeature) != 0)
+                        highCutFilter.template processBlock<NumChannels> (lanes, length);
+                }
+            }
+
+            /**
+             * Calls the processCutFilters() specialisation for the feature mask directly.
+             * A table of member function pointers can't be inlined, so its kernels stayed
+             * baseline code inside the AVX2 and AVX-512 variants of processChunk().
+             */
+            template <int NumChannels>
+            void runCutKernel (unsigned features, SampleType* const* lanes, const SampleType* lowCut, const SampleType* highCut, int length)
+            {
+                switch (features)
+                {
+                    case 0:
+                        break; // both filters off
+
+                    case lowCutFeature:
+                        processCutFilters<NumChannels, lowCutFeature> (lanes, lowCut, highCut, length);
+                        break;
+
+                    case highCutFeature:
+                        processCutFilters<NumChannels, highCutFeature> (lanes, lowCut, highCut, length);
+                        break;
+
+                    case lowCutFeature | highCutFeature:
+                        processCutFilters<NumChannels, lowCutFeature | highCutFeature> (lanes, lowCut, highCut, length);
+                        break;
+
+                    default:
+                        jassert (features == cutoffModulation);
+                        processCutFilters<NumChannels, cutoffModulation> (lanes, lowCut, highCut, length);
+                        break;
+                }
+            }
+
+            /** Delays the dry signal in place by the wet path latency. */
+            void processDryDelay (juce::AudioBuffer<SampleType>& buffer, int numWetChannels)
+            {
+                const int latency = makeItLoud.getLatencySamples();
+
+                if (latency != dryDelaySamples)
                 {
-                    workSample = lowCutFilter.processSample (0, workSample);
+                    dryDelaySamples = latency;
+
+                    for (auto& delay : dryDelays)
+                        delay.setDelaySamples (static_cast<double> (juce::jmax (1, latency)));
                 }
-                if (highCutActive)
+
+                if (dryDelaySamples == 0)
+                    return;
+
+                const int numChannelsToDelay = juce::jmin (numWetChannels, static_cast<int> (dryDelays.size()));
+
+                for (int channel = 0; channel < numChannelsToDelay; ++channel)
                 {
-                    workSample = highCutFilter.processSample (0, workSample);
+                    auto& delay = dryDelays[(size_t) channel];
+                    auto* channelData = buffer.getWritePointer (channel);
+
+                    for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    {
+                        const auto delayed = delay.readSample();
+                        delay.writeSample (channelData[i]);
+                        channelData[i] = delayed;
+                    }
                 }
+            }
+
+            /** Dry/wet mix and output gain, written back into buffer. */
+            void processMix (juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>& wet, int numWetChannels)
+            {
+                const auto* mix = smoothers.getRamp (Parameter::mix);
+                const auto* outputGain = smoothers.getRamp (Parameter::outputGain);
+
+                for (int channel = 0; channel < numWetChannels; ++channel)
+                    Utils::VectorOps::mix (buffer.getWritePointer (channel), wet.getReadPointer (channel), mix, outputGain, buffer.getNumSamples());
+            }
+
+            /** Output gain only, in place: mix is settled at 0. */
+            void processOutputGain (juce::AudioBuffer<SampleType>& buffer, int numWetChannels)
+            {
+                const auto* outputGain = smoothers.getRamp (Parameter::outputGain);
+
+                for (int channel = 0; channel < numWetChannels; ++channel)
+                    Utils::VectorOps::multiply (buffer.getWritePointer (channel), outputGain, buffer.getNumSamples());
+            }
+
+            /** Wet signal times output gain, written into buffer: mix is settled at 1. */
+            void processWetOnly (juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>& wet, int numWetChannels)
+            {
+                const auto* outputGain = smoothers.getRamp (Parameter::outputGain);
 
-                wetBuffer.setSample (0, sampleIndex, workSample);
+                for (int channel = 0; channel < numWetChannels; ++channel)
+                    Utils::VectorOps::multiply (buffer.getWritePointer (channel), wet.getReadPointer (channel), outputGain, buffer.getNumSamples());
             }
 
-            Filters::SchroederAllpassChain<SampleType> leftAllpassChain;
-            Filters::SchroederAllpassChain<SampleType> rightAllpassChain;
+            // L and R run as two lanes of one chain, they always share delay and character
+            Filters::PackedSchroederAllpassChain<SampleType, 2> allpassChain;
             Filters::BrightnessEQ<SampleType> brightnessEQ;
             Effects::StereoEnhancer<SampleType> stereoEnhancer;
             DSP::Effects::HaasEffect<SampleType> haasEffect;
 
-            juce::dsp::StateVariableTPTFilter<SampleType> lowCutFilter;
-            juce::dsp::StateVariableTPTFilter<SampleType> highCutFilter;
+            Filters::CutFilter<SampleType> lowCutFilter;
+            Filters::CutFilter<SampleType> highCutFilter;
 
-            Utils::ParameterSmoother<SampleType> inputGainSmoother;
-            Utils::ParameterSmoother<SampleType> outputGainSmoother;
-            Utils::ParameterSmoother<SampleType> mixSmoother;
-            Utils::ParameterSmoother<SampleType> delaySmoother;
-            Utils::ParameterSmoother<SampleType> brightnessSmoother;
-            Utils::ParameterSmoother<SampleType> characterSmoother;
-            Utils::ParameterSmoother<SampleType> lowCutSmoother;
-            Utils::ParameterSmoother<SampleType> highCutSmoother;
-            Utils::ParameterSmoother<SampleType> widthSmoother;
-            Utils::ParameterSmoother<SampleType> haasSmoother;
+            Utils::SmootherBank<SampleType, numParameters> smoothers;
 
             // MakeItLoud
 
             Effects::MakeItLoud<SampleType> makeItLoud;
+            int compressorMode = -1;
+
+            static constexpr int subBlockSize = 32;
+
+            /** Feature bits of the cut filter kernels, see processCutFilters(). */
+            enum CutFeatures : unsigned
+            {
+                lowCutFeature = 1,
+                highCutFeature = 2,
+                cutoffModulation = 4
+            };
+
+            bool useSpecialisedKernels = true;
+            bool useMixFastPaths = true;
+
+            Utils::InstructionSet instructionSet = Utils::InstructionSet::baseline;
+            std::optional<Utils::InstructionSet> forcedInstructionSet;
 
-            Utils::ParameterSmoother<SampleType> mil_InputGainSmoother;
-            Utils::ParameterSmoother<SampleType> mil_BoostSmoother;
+            // delay, brightness, character, width, haas as last passed to updateDSPComponents()
+            static constexpr size_t numControlParameters = 5;
+            std::array<SampleType, numControlParameters> appliedControls {};
 
             juce::AudioBuffer<SampleType> wetBuffer;
-            juce::AudioBuffer<SampleType> dryBuffer;
+
+            std::vector<Filters::DelayLine<SampleType>> dryDelays;
+            int dryDelaySamples = -1;
 
             double sampleRate = 44100.0;
             int samplesPerBlock = 512;
@@ -386,12 +802,33 @@ namespace DSP
 
             // subtract one to ensure that the value is always
             // LOWER than the upper limit
-            SampleType lowCutMax = (sampleRate*0.5) - 1;
-            SampleType highCutMax = (sampleRate*0.5) - 1;
+            SampleType lowCutMax = static_cast<SampleType> (sampleRate * 0.5 - 1.0);
+            SampleType highCutMax = static_cast<SampleType> (sampleRate * 0.5 - 1.0);
+
+
+            // -120 dB; quieter input counts as silence
+            static constexpr SampleType silenceThreshold = static_cast<SampleType> (1.0e-6);
 
+            // a 20 Hz low cut (Q 0.707) takes ~0.16 s to decay by 120 dB, the rest far less
+            static constexpr double filterRingOutSeconds = 0.2;
+
+            std::atomic<double> tailLengthSeconds { 0.0 };
+            juce::int64 tailLengthSamples = 0;
+            juce::int64 silentSamples = 0;
+            bool sleeping = false;
+            bool canSleep = true;
 
             bool lowCutActive = false;
             bool highCutActive = false;
+            bool componentsNeedUpdate = true;
+
+            // set while a settled mix of 0 or 1 lets processChunk() skip that path
+            bool wetPathIdle = false;
+            bool dryPathIdle = false;
+
+           #if CHASM_STAGE_PROFILING
+            Utils::StageProfiler<numStages> stageProfiler;
+           #endif
         };
 
     } // namespace Core
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "../Filters/AllpassFilter.h"
+#include "../Filters/DelayLine.h"
 #include "../Utils/ParameterSmoother.h"
 #include <juce_audio_basics/juce_audio_basics.h>
 
@@ -19,13 +19,13 @@ public:
 
         const double maxDelayMs = 50.0;
         rightDelay.prepare(sampleRate, maxDelayMs);
-        rightDelay.setFeedback(SampleType{0.0});  // No feedback for Haas
 
         delaySmoother.prepare(sampleRate, 20.0);
         delaySmoother.setTargetValue(SampleType{20.0});  // Default 20ms
         delaySmoother.snapToTargetValue();
 
         reset();
+        updateParameters();
     }
 
     void setDelayMs(SampleType delayMs)
@@ -39,34 +39,38 @@ public:
         const int numSamples = buffer.getNumSamples();
         jassert(buffer.getNumChannels() >= 2);
 
-        auto* left = buffer.getWritePointer(0);
         auto* right = buffer.getWritePointer(1);
 
         for (int i = 0; i < numSamples; ++i)
         {
-            updateParameters();
+            if (delaySmoother.isSmoothing())
+                updateParameters();
 
             // Process only right channel through delay
-            right[i] = rightDelay.processSample(right[i]);
+            const auto delayed = rightDelay.readSample();
+            rightDelay.writeSample(right[i]);
+            right[i] = delayed;
         }
     }
 
-    void reset()
+    /** Clears the delay line and jumps straight to the given delay, without gliding. */
+    void reset(SampleType delayMs = SampleType{20.0})
     {
         rightDelay.reset();
-        delaySmoother.reset(SampleType{20.0});
+        delaySmoother.reset(juce::jlimit(SampleType{0.0}, SampleType{50.0}, delayMs));
+        updateParameters();
     }
 
 private:
     double sampleRate = 44100.0;
 
-    DSP::Filters::AllpassFilter<SampleType> rightDelay;
+    DSP::Filters::DelayLine<SampleType, 1> rightDelay;
     Utils::ParameterSmoother<SampleType> delaySmoother;
 
     void updateParameters()
     {
         auto delayMs = delaySmoother.getNextValue();
-        rightDelay.setDelayTime(delayMs);
+        rightDelay.setDelaySamples(delayMs * 0.001 * sampleRate);
     }
 };
 
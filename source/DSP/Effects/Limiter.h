@@ -4,173 +4,307 @@
 #include <juce_dsp/juce_dsp.h>
 #include <cmath>
 
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include "../Utils/SlidingWindowMinimum.h"
+
 namespace DSP {
 namespace Effects {
 
 /**
- * Smooth Limiter for preventing clipping and adding character.
- * Uses a combination of soft clipping and dynamic range compression.
+ * Lookahead true-peak limiter.
+ *
+ * All channels share one gain (stereo link), derived from:
+ * - the peak across channels, optionally including inter-sample peaks found
+ *   by 4x polyphase interpolation of the detector signal,
+ * - the gain each sample needs to stay under the ceiling, held over the
+ *   lookahead window with a sliding minimum (monotonic deque, O(1)),
+ * - a one-pole release, and a moving average over the lookahead window.
+ *
+ * Holding the minimum for the lookahead window and then averaging over the
+ * same window means the gain has fully ramped down by the time the peak
+ * leaves the delay line, so sample peaks never pass the ceiling and there is
+ * no attack overshoot. The audio is delayed by lookahead plus the
+ * interpolator's group delay, see getLatencySamples().
  */
 template<typename SampleType>
-class SmoothLimiter
+class LookaheadLimiter
 {
 public:
-    SmoothLimiter() = default;
-        
-    /** Prepares the limiter with sample rate. */
-        void prepare(double newSampleRate)
-        {
-            _sampleRate = newSampleRate;
-            
-            // Prepare the compressor for the limiting stage
-            _compressor.prepare({_sampleRate, 256, 2});
-            
-            // Configure compressor for limiting
-            _compressor.setAttack(static_cast<SampleType>(0.1));   // 0.1ms attack
-            _compressor.setRelease(static_cast<SampleType>(10.0)); // 10ms release
-            _compressor.setThreshold(static_cast<SampleType>(-0.0)); // -0.0dB threshold
-            _compressor.setRatio(static_cast<SampleType>(20.0));   // High ratio for limiting
-    
-            reset();
-        }
-    
-    /** Enables or disables the limiter. */
-    void setEnabled(bool shouldBeEnabled)
+    LookaheadLimiter()
     {
-        _enabled = shouldBeEnabled;
+        designInterpolator();
     }
-    
-    /** Sets the output ceiling level in dB. */
+
+    /**
+     * Allocates for the given spec. The lookahead is fixed here because it
+     * sets the latency.
+     */
+    void prepare(const juce::dsp::ProcessSpec& spec, double lookaheadMs = 1.5)
+    {
+        sampleRate = spec.sampleRate;
+        numChannels = static_cast<int>(spec.numChannels);
+        maxBlockSize = static_cast<int>(spec.maximumBlockSize);
+        lookaheadSamples = juce::jmax(1, juce::roundToInt(lookaheadMs * 0.001 * sampleRate));
+
+        // the whole chunk is written before any of it is read back
+        const auto delayLength = juce::nextPowerOfTwo(getLatencySamples() + maxBlockSize);
+        delayMask = delayLength - 1;
+        delayBuffer.setSize(numChannels, delayLength);
+
+        detectorHistory.assign(static_cast<size_t>(numChannels * 2 * tapsPerPhase), SampleType{0.0});
+
+        peaks.resize(static_cast<size_t>(maxBlockSize));
+        gains.resize(static_cast<size_t>(maxBlockSize));
+
+        heldGain.prepare(lookaheadSamples + 1);
+        averagingBuffer.resize(static_cast<size_t>(lookaheadSamples));
+
+        updateReleaseCoefficient();
+        reset();
+    }
+
+    /** Sets the output ceiling level in dB (dBTP when true peak detection is on). */
     void setCeiling(SampleType ceilingDb)
     {
-        _ceiling = juce::Decibels::decibelsToGain(ceilingDb);
+        ceiling = static_cast<SampleType>(juce::Decibels::decibelsToGain(ceilingDb));
     }
-    
-    /** Processes a single sample. */
-    SampleType processSample(SampleType input)
+
+    /** Sets the release time in ms. */
+    void setRelease(SampleType releaseMs)
     {
-        if (!_enabled)
-            return input;
-            
-        // First stage: soft clipping for harmonic coloration
-        SampleType softClipped = softClip(input);
-        
-        // Second stage: dynamic limiting
-        SampleType limited = dynamicLimit(softClipped);
-        
-        // Final stage: hard ceiling
-        return juce::jlimit(-_ceiling, _ceiling, limited);
+        releaseTimeMs = juce::jmax(SampleType{1.0}, releaseMs);
+        updateReleaseCoefficient();
     }
-    
-    /** Processes a stereo pair of samples. */
-    void processStereoSample(SampleType& left, SampleType& right)
+
+    /** Detect inter-sample peaks (default) or only sample peaks. Does not change the latency. */
+    void setTruePeak(bool shouldDetectTruePeaks)
     {
-        if (!_enabled)
-            return;
-            
-        left = processSample(left);
-        right = processSample(right);
+        truePeak = shouldDetectTruePeaks;
     }
-    
-    /** Processes a buffer. */
+
+    /** Enables or disables the limiter; disabled still delays by the latency. */
+    void setEnabled(bool shouldBeEnabled)
+    {
+        enabled = shouldBeEnabled;
+    }
+
+    /** Delay between input and output, in samples. */
+    int getLatencySamples() const
+    {
+        return lookaheadSamples + interpolatorDelay;
+    }
+
+    /** Processes a buffer in place. */
     void processBlock(juce::AudioBuffer<SampleType>& buffer)
     {
-        if (!_enabled)
-            return;
-            
-        int numChannels = buffer.getNumChannels();
-        int numSamples = buffer.getNumSamples();
-        
-        // Process each channel
-        for (int channel = 0; channel < numChannels; ++channel)
-        {
-            auto* channelData = buffer.getWritePointer(channel);
-            
-            for (int i = 0; i < numSamples; ++i)
-            {
-                channelData[i] = processSample(channelData[i]);
-            }
-        }
-        
-        // Apply compressor for final limiting stage
-        if (numChannels > 0)
-        {
-            juce::dsp::AudioBlock<SampleType> block(buffer);
-            juce::dsp::ProcessContextReplacing<SampleType> context(block);
-            _compressor.process(context);
-        }
+        jassert(buffer.getNumChannels() <= numChannels);
+
+        const auto channels = juce::jmin(buffer.getNumChannels(), numChannels);
+        const auto numSamples = buffer.getNumSamples();
+        auto* const* io = buffer.getArrayOfWritePointers();
+        auto minimumGain = SampleType{1.0};
+
+        for (int start = 0; start < numSamples; start += maxBlockSize)
+            minimumGain = juce::jmin(minimumGain, processChunk(io, channels, start, juce::jmin(maxBlockSize, numSamples - start)));
+
+        gainReductionDb.store(static_cast<float>(-juce::Decibels::gainToDecibels(minimumGain, SampleType{-144.0})));
     }
-    
+
     /** Resets the limiter state. */
     void reset()
     {
-        _compressor.reset();
-        _envelopeFollower = SampleType{0};
+        delayBuffer.clear();
+        writePosition = 0;
+        std::fill(detectorHistory.begin(), detectorHistory.end(), SampleType{0.0});
+        historyPosition = 0;
+        heldGain.reset();
+        previousPeak = SampleType{0.0};
+        releasedGain = SampleType{1.0};
+        std::fill(averagingBuffer.begin(), averagingBuffer.end(), SampleType{1.0});
+        averagingPosition = 0;
+        averagingSum = static_cast<double>(averagingBuffer.size());
+        gainReductionDb.store(0.0f);
     }
-    
-    /** Gets the current gain reduction in dB. */
-    SampleType getGainReduction() const
+
+    /**
+     * Largest gain reduction actually applied during the last block, in dB
+     * (0 = untouched). Safe to call from any thread.
+     */
+    float getGainReduction() const
     {
-        // This would typically come from the compressor
-        // For now, estimate based on envelope follower
-        return juce::Decibels::gainToDecibels(std::max(_envelopeFollower, SampleType{0.001}));
+        return gainReductionDb.load();
     }
 
 private:
-    SampleType softClip(SampleType input)
+    /**
+     * Detection per channel, gain per frame, then gain per channel, so the
+     * detector and the output multiply run as tight channel loops.
+     * Returns the smallest gain applied.
+     */
+    SampleType processChunk(SampleType* const* io, int channels, int start, int length)
     {
-        // Smooth soft clipping using tanh
-        return std::tanh(input * SampleType{2.0}) * SampleType{0.5};
-    }
-    
-    SampleType dynamicLimit(SampleType input)
-    {
-        // Simple envelope follower for dynamic limiting
-        SampleType inputLevel = std::abs(input);
-        
-        // Update envelope
-        if (inputLevel > _envelopeFollower)
+        auto* const* delayed = delayBuffer.getArrayOfWritePointers();
+        std::fill(peaks.begin(), peaks.begin() + length, SampleType{0.0});
+
+        for (int channel = 0; channel < channels; ++channel)
         {
-            // Fast attack
-            _envelopeFollower += (inputLevel - _envelopeFollower) * _attackCoeff;
+            const auto* input = io[channel] + start;
+            auto* ring = delayed[channel];
+            auto* history = detectorHistory.data() + channel * 2 * tapsPerPhase;
+            auto position = historyPosition;
+
+            for (int i = 0; i < length; ++i)
+            {
+                ring[(writePosition + i) & delayMask] = input[i];
+
+                // written twice, so the last tapsPerPhase inputs are always contiguous
+                history[position] = history[position + tapsPerPhase] = input[i];
+                position = position + 1 == tapsPerPhase ? 0 : position + 1;
+
+                peaks[(size_t) i] = juce::jmax(peaks[(size_t) i], detectPeak(history + position));
+            }
         }
-        else
+
+        historyPosition = (historyPosition + length) % tapsPerPhase;
+
+        auto minimumGain = SampleType{1.0};
+
+        for (int i = 0; i < length; ++i)
         {
-            // Slower release
-            _envelopeFollower += (inputLevel - _envelopeFollower) * _releaseCoeff;
+            // an inter-sample peak constrains the samples on both sides of it
+            const auto framePeak = juce::jmax(peaks[(size_t) i], previousPeak);
+            previousPeak = peaks[(size_t) i];
+
+            const auto requiredGain = enabled && framePeak > ceiling ? ceiling / framePeak : SampleType{1.0};
+            const auto held = heldGain.push(requiredGain);
+
+            releasedGain = held < releasedGain ? held : releasedGain + (held - releasedGain) * releaseCoefficient;
+
+            averagingSum += static_cast<double>(releasedGain) - static_cast<double>(averagingBuffer[averagingPosition]);
+            averagingBuffer[averagingPosition] = releasedGain;
+            averagingPosition = averagingPosition + 1 == averagingBuffer.size() ? 0 : averagingPosition + 1;
+
+            gains[(size_t) i] = juce::jmin(SampleType{1.0}, static_cast<SampleType>(averagingSum / static_cast<double>(lookaheadSamples)));
+            minimumGain = juce::jmin(minimumGain, gains[(size_t) i]);
         }
-        
-        // Calculate gain reduction
-        SampleType gainReduction = SampleType{1.0};
-        if (_envelopeFollower > _threshold)
+
+        const auto readStart = writePosition - getLatencySamples();
+
+        for (int channel = 0; channel < channels; ++channel)
         {
-            gainReduction = static_cast<SampleType>(_threshold / (_envelopeFollower + static_cast<SampleType>(1e-6)));
+            auto* output = io[channel] + start;
+            const auto* ring = delayed[channel];
+
+            for (int i = 0; i < length; ++i)
+            {
+                const auto sample = ring[(readStart + i) & delayMask] * gains[(size_t) i];
+                output[i] = enabled ? juce::jlimit(-ceiling, ceiling, sample) : sample;
+            }
         }
-        
-        return input * gainReduction;
+
+        writePosition = (writePosition + length) & delayMask;
+        return minimumGain;
     }
-    
-    void updateCoefficients()
+
+    /**
+     * Peak of the sample interpolatorDelay frames back, or of the four 4x
+     * phases around it. window holds the last tapsPerPhase inputs, oldest first.
+     */
+    SampleType detectPeak(const SampleType* window) const
     {
-        if (_sampleRate > 0.0)
+        if (!truePeak)
+            return std::abs(window[tapsPerPhase - 1 - interpolatorDelay]);
+
+        auto peak = SampleType{0.0};
+
+        for (const auto& phase : interpolator)
         {
-            // Calculate smoothing coefficients
-            SampleType attackTimeMs = SampleType{0.1};  // 0.1ms attack
-            SampleType releaseTimeMs = SampleType{10.0}; // 10ms release
-            _attackCoeff = SampleType{1.0} - std::exp(-SampleType{1.0} / (attackTimeMs * SampleType{0.001} * _sampleRate));
-            _releaseCoeff = SampleType{1.0} - std::exp(-SampleType{1.0} / (releaseTimeMs * SampleType{0.001} * _sampleRate));
+            auto value = SampleType{0.0};
+
+            for (int tap = 0; tap < tapsPerPhase; ++tap)
+                value += phase[static_cast<size_t>(tap)] * window[tap];
+
+            peak = juce::jmax(peak, std::abs(value));
         }
+
+        return peak;
     }
 
-    double _sampleRate = 44100.0;
-    bool _enabled = true;
-    SampleType _ceiling = SampleType{1.0};
-    SampleType _threshold = static_cast<SampleType>(0.8);
-    SampleType _envelopeFollower = SampleType{0};
-    SampleType _attackCoeff = SampleType{static_cast<SampleType>(0.9)};
-    SampleType _releaseCoeff = SampleType{static_cast<SampleType>(0.01)};
+    /**
+     * Windowed-sinc 4x interpolator (48 taps, Blackman) split into phases.
+     * Phase p interpolates interpolatorDelay - p / 4 samples back; phase 0 is
+     * the plain delayed sample.
+     */
+    void designInterpolator()
+    {
+        constexpr int length = static_cast<int>(oversamplingFactor) * tapsPerPhase;
+        constexpr double centre = length / 2;
+
+        for (size_t phase = 0; phase < oversamplingFactor; ++phase)
+        {
+            double sum = 0.0;
+            std::array<double, tapsPerPhase> taps {};
+
+            for (int tap = 0; tap < tapsPerPhase; ++tap)
+            {
+                const auto index = tap * static_cast<int>(oversamplingFactor) + static_cast<int>(phase);
+                const auto x = (index - centre) / static_cast<double>(oversamplingFactor);
+                const auto sinc = index == static_cast<int>(centre) ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+                const auto w = juce::MathConstants<double>::twoPi * index / length;
+                const auto window = 0.42 - 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w);
+
+                taps[static_cast<size_t>(tap)] = sinc * window;
+                sum += taps[static_cast<size_t>(tap)];
+            }
+
+            // unity gain at DC for every phase; stored oldest tap first to match the history window
+            for (int tap = 0; tap < tapsPerPhase; ++tap)
+                interpolator[phase][static_cast<size_t>(tapsPerPhase - 1 - tap)] = static_cast<SampleType>(taps[static_cast<size_t>(tap)] / sum);
+        }
+    }
+
+    void updateReleaseCoefficient()
+    {
+        releaseCoefficient = static_cast<SampleType>(1.0 - std::exp(-1.0 / (static_cast<double>(releaseTimeMs) * 0.001 * sampleRate)));
+    }
+
+    static constexpr size_t oversamplingFactor = 4;
+    static constexpr int tapsPerPhase = 12;
+    static constexpr int interpolatorDelay = tapsPerPhase / 2;
+
+    std::array<std::array<SampleType, tapsPerPhase>, oversamplingFactor> interpolator {};
+
+    double sampleRate = 44100.0;
+    int numChannels = 0;
+    int maxBlockSize = 0;
+    int lookaheadSamples = 1;
+
+    juce::AudioBuffer<SampleType> delayBuffer;
+    int delayMask = 0;
+    int writePosition = 0;
+
+    std::vector<SampleType> peaks, gains;
+    std::vector<SampleType> detectorHistory;
+    int historyPosition = 0;
+
+    Utils::SlidingWindowMinimum<SampleType> heldGain;
+    SampleType previousPeak = SampleType{0.0};
+    SampleType releasedGain = SampleType{1.0};
+
+    std::vector<SampleType> averagingBuffer;
+    size_t averagingPosition = 0;
+    double averagingSum = 0.0;
+
+    SampleType ceiling = SampleType{1.0};
+    SampleType releaseTimeMs = SampleType{50.0};
+    SampleType releaseCoefficient = SampleType{0.0};
+    bool truePeak = true;
+    bool enabled = true;
 
-    juce::dsp::Compressor<SampleType> _compressor;
+    std::atomic<float> gainReductionDb { 0.0f };
 };
 
 /**
@@ -2,7 +2,13 @@
 
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_dsp/juce_dsp.h>
+#include <array>
 #include <cmath>
+#include <memory>
+#include <vector>
+
+#include "../Filters/DelayLine.h"
+#include "../Utils/Saturation.h"
 
 namespace DSP {
 namespace Effects {
@@ -11,7 +17,7 @@ namespace Effects {
  * @brief MakeItLoud is a dynamic waveshaping effect chain consisting of:
  * - Pre-compressor (with selectable mode)
  * - Input gain + boost gain
- * - Waveshaper using tanh
+ * - Waveshaper using tanh, optionally oversampled 2x/4x/8x
  * - Post-compressor (same settings as pre)
  * 
  * Parameters:
@@ -19,6 +25,11 @@ namespace Effects {
  * - Boost gain (linear, 0.0 to 2.0)
  * - Compressor mode (Clean, Further, Crunchy)
  * - Bypass mode / Enabled state
+ * - Oversampling factor and filter (polyphase IIR or linear phase FIR)
+ *
+ * Only the waveshaper runs at the oversampled rate. The latency of the
+ * selected oversampling setting is kept while disabled too, so the host
+ * sees a constant delay when the compressor mode is switched.
  *
  * Designed to be loud and punchy, with tone control via compressor modes.
  *
@@ -41,6 +52,18 @@ public:
         Crunchy  ///< -8dB threshold, 5:1 ratio, strong saturation
     };
 
+    /**
+     * @brief Oversampling anti-aliasing filter.
+     */
+    enum class OversamplingFilter
+    {
+        PolyphaseIIR, ///< low latency, non-linear phase
+        LinearPhaseFIR ///< linear phase, higher latency
+    };
+
+    /** Highest supported oversampling factor index (2^3 = 8x). */
+    static constexpr int maxOversamplingIndex = 3;
+
     /**
      * @brief Prepare the processor for playback.
      * @param spec The DSP processing spec (sample rate, block size, channels)
@@ -55,6 +78,31 @@ public:
         _preCompressor.prepare(spec);
         _postCompressor.prepare(spec);
 
+        // Every factor/filter combination is built up front, so switching
+        // on the audio thread never allocates.
+        for (size_t filter = 0; filter < _oversamplers.size(); ++filter)
+        {
+            for (size_t index = 0; index < _oversamplers[filter].size(); ++index)
+            {
+                auto& oversampler = _oversamplers[filter][index];
+                oversampler = std::make_unique<juce::dsp::Oversampling<SampleType>>(
+                    spec.numChannels,
+                    index + 1,
+                    filter == static_cast<size_t>(OversamplingFilter::PolyphaseIIR)
+                        ? juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR
+                        : juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple,
+                    true,
+                    true);
+                oversampler->initProcessing(spec.maximumBlockSize);
+            }
+        }
+
+        _bypassDelays.resize(spec.numChannels);
+
+        for (auto& delay : _bypassDelays)
+            delay.prepare(getMaximumLatencySamples());
+
+        updateLatency();
         reset();
     }
 
@@ -67,6 +115,12 @@ public:
         _boostGain.reset();
         _preCompressor.reset();
         _postCompressor.reset();
+
+        if (auto* oversampler = getOversampler())
+            oversampler->reset();
+
+        for (auto& delay : _bypassDelays)
+            delay.reset();
     }
 
     /**
@@ -75,11 +129,14 @@ public:
      */
     void processBlock(juce::AudioBuffer<SampleType>& buffer)
     {
-        if (!_enabled)
+        if (buffer.getNumChannels() == 0 || buffer.getNumSamples() == 0)
             return;
 
-        if (buffer.getNumChannels() == 0 || buffer.getNumSamples() == 0)
+        if (!_enabled)
+        {
+            processBypassDelay(buffer);
             return;
+        }
 
         // Wrap buffer into DSP context
         juce::dsp::AudioBlock<SampleType> block(buffer);
@@ -95,20 +152,16 @@ public:
         _boostGain.setGainLinear(_boostValue);
         _boostGain.process(context);
 
-        // Apply tanh waveshaping to all samples
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        // Apply tanh waveshaping, at the oversampled rate if enabled
+        if (auto* oversampler = getOversampler())
         {
-            auto* channelData = buffer.getWritePointer(channel);
-            for (int i = 0; i < buffer.getNumSamples(); ++i)
-            {
-                SampleType sample = channelData[i];
-                sample = std::tanh(sample * _boostValue);
-
-                if (std::isnan(sample) || std::isinf(sample))
-                    sample = SampleType{ 0.0 };
-
-                channelData[i] = sample;
-            }
+            auto oversampledBlock = oversampler->processSamplesUp(block);
+            applyWaveshaper(oversampledBlock);
+            oversampler->processSamplesDown(block);
+        }
+        else
+        {
+            applyWaveshaper(block);
         }
 
         // Post-compression
@@ -127,11 +180,7 @@ public:
         sample = _preCompressor.processSample(sample);
         sample = _inputGain.processSample(sample * _inputGainValue);
         sample = _boostGain.processSample(sample * _boostValue);
-        sample = std::tanh(sample);
-
-        if (std::isnan(sample) || std::isinf(sample))
-            sample = SampleType{ 0.0 };
-
+        sample = Utils::Saturation::tanhPade(sample);
         sample = _postCompressor.processSample(sample);
     }
 
@@ -155,9 +204,57 @@ public:
 
     void setEnabled(bool enabled)
     {
+        // don't replay stale audio from the last time it was bypassed
+        if (_enabled && !enabled)
+            for (auto& delay : _bypassDelays)
+                delay.reset();
+
         _enabled = enabled;
     }
 
+    /**
+     * @brief Select the oversampling used around the waveshaper.
+     * @param factorIndex 0 = off, 1 = 2x, 2 = 4x, 3 = 8x
+     * @param filter Anti-aliasing filter type
+     *
+     * Real-time safe once prepared; the newly selected stage starts from a
+     * cleared state and getLatencySamples() changes accordingly.
+     */
+    void setOversampling(int factorIndex, OversamplingFilter filter)
+    {
+        factorIndex = juce::jlimit(0, maxOversamplingIndex, factorIndex);
+
+        if (factorIndex == _oversamplingIndex && filter == _oversamplingFilter)
+            return;
+
+        _oversamplingIndex = factorIndex;
+        _oversamplingFilter = filter;
+
+        if (auto* oversampler = getOversampler())
+            oversampler->reset();
+
+        updateLatency();
+    }
+
+    /** Latency in samples added by the current oversampling setting, 0 when off. */
+    int getLatencySamples() const
+    {
+        return _latencySamples;
+    }
+
+    /** Largest latency any oversampling setting can report, valid after prepare(). */
+    int getMaximumLatencySamples() const
+    {
+        int maximum = 0;
+
+        for (const auto& filterOversamplers : _oversamplers)
+            for (const auto& oversampler : filterOversamplers)
+                if (oversampler != nullptr)
+                    maximum = juce::jmax(maximum, juce::roundToInt(oversampler->getLatencyInSamples()));
+
+        return maximum;
+    }
+
     /**
      * @brief Set compressor mode using enum.
      * @param mode CompressorMode (Clean, Further, Crunchy)
@@ -185,14 +282,59 @@ public:
     void setCompressorMode(int mode)
     {
         if (mode == 0){
-            _enabled = false;
+            setEnabled(false);
         } else {
-            _enabled = true;
+            setEnabled(true);
             setCompressorMode(static_cast<CompressorMode>(juce::jlimit(0, 2, mode+1))); // +1 offset from 0->disabled
         }
     }
 
 private:
+    juce::dsp::Oversampling<SampleType>* getOversampler() const
+    {
+        if (_oversamplingIndex == 0)
+            return nullptr;
+
+        return _oversamplers[static_cast<size_t>(_oversamplingFilter)][static_cast<size_t>(_oversamplingIndex - 1)].get();
+    }
+
+    void updateLatency()
+    {
+        auto* oversampler = getOversampler();
+        _latencySamples = oversampler != nullptr ? juce::roundToInt(oversampler->getLatencyInSamples()) : 0;
+
+        for (auto& delay : _bypassDelays)
+            delay.setDelaySamples(static_cast<double>(juce::jmax(1, _latencySamples)));
+    }
+
+    void applyWaveshaper(juce::dsp::AudioBlock<SampleType>& block)
+    {
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+            Utils::Saturation::tanhPade(block.getChannelPointer(channel), static_cast<int>(block.getNumSamples()), _boostValue);
+    }
+
+    /** Delays the dry signal by the oversampling latency while disabled. */
+    void processBypassDelay(juce::AudioBuffer<SampleType>& buffer)
+    {
+        if (_latencySamples == 0)
+            return;
+
+        const auto numChannels = juce::jmin(buffer.getNumChannels(), static_cast<int>(_bypassDelays.size()));
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto& delay = _bypassDelays[static_cast<size_t>(channel)];
+            auto* channelData = buffer.getWritePointer(channel);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                const auto delayed = delay.readSample();
+                delay.writeSample(channelData[i]);
+                channelData[i] = delayed;
+            }
+        }
+    }
+
     /** Applies the same compressor settings to both pre and post compressors. */
     void applyCompressorSettings(float threshold, float ratio, float attack, float release)
     {
@@ -214,12 +356,19 @@ private:
     juce::dsp::Compressor<SampleType> _preCompressor;
     juce::dsp::Compressor<SampleType> _postCompressor;
 
+    // [filter][factor index - 1]
+    std::array<std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, maxOversamplingIndex>, 2> _oversamplers;
+    std::vector<Filters::DelayLine<SampleType>> _bypassDelays;
+
     // Parameters
     SampleType _boostValue { 1.0 };
     SampleType _inputGainValue { 1.0 };
     double _sampleRate { 44100.0 };
     int _blockSize { 512 };
     bool _enabled { true };
+    int _oversamplingIndex { 0 };
+    OversamplingFilter _oversamplingFilter { OversamplingFilter::PolyphaseIIR };
+    int _latencySamples { 0 };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MakeItLoud<SampleType>)
 };
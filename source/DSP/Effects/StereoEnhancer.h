@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Utils/ParameterSmoother.h"
+#include "../Utils/VectorOps.h"
 #include <juce_audio_basics/juce_audio_basics.h>
 
 namespace DSP {
@@ -45,30 +46,20 @@ public:
         jassert(buffer.getNumChannels() >= 2);
         
         auto numSamples = buffer.getNumSamples();
+        auto* left = buffer.getWritePointer(0);
+        auto* right = buffer.getWritePointer(1);
         
-        for (int i = 0; i < numSamples; ++i)
+        int i = 0;
+        
+        // Per-sample width only while the smoother is moving
+        for (; widthSmoother.isSmoothing() && i < numSamples; ++i)
         {
             updateParameters();
-            
-            // Get current sample values
-            auto leftSample = buffer.getSample(0, i);
-            auto rightSample = buffer.getSample(1, i);
-            
-            // Calculate mid and side signals
-            auto midSignal = (leftSample + rightSample) * SampleType{0.5};
-            auto sideSignal = (leftSample - rightSample) * SampleType{0.5};
-            
-            
-            // Apply width control to side signal
-            sideSignal *= currentWidthGain;
-            
-            // Convert back to left/right
-            auto newLeft = midSignal + sideSignal;
-            auto newRight = midSignal - sideSignal;
-            
-            buffer.setSample(0, i, newLeft);
-            buffer.setSample(1, i, newRight);
+            processSample(left[i], right[i]);
         }
+        
+        if (i < numSamples)
+            Utils::VectorOps::midSideWidth(left + i, right + i, currentWidthGain, numSamples - i);
     }
     
     /** Resets the stereo enhancer state. */
@@ -87,6 +78,20 @@ private:
     // Current parameter values
     SampleType currentWidthGain = SampleType{1.0};
     
+    void processSample(SampleType& left, SampleType& right) const
+    {
+        // Calculate mid and side signals
+        auto midSignal = (left + right) * SampleType{0.5};
+        auto sideSignal = (left - right) * SampleType{0.5};
+        
+        // Apply width control to side signal
+        sideSignal *= currentWidthGain;
+        
+        // Convert back to left/right
+        left = midSignal + sideSignal;
+        right = midSignal - sideSignal;
+    }
+    
     void updateParameters()
     {
         // Update width (convert percentage to gain)
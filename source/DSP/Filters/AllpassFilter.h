@@ -1,7 +1,7 @@
 #pragma once
 
+#include "DelayLine.h"
 #include <juce_audio_basics/juce_audio_basics.h>
-#include <vector>
 
 namespace DSP {
 namespace Filters {
@@ -20,9 +20,7 @@ public:
     void prepare(double newSampleRate, double maxDelayMs)
     {
         _sampleRate = newSampleRate;
-        
-        auto maxDelaySamples = static_cast<size_t>(maxDelayMs * 0.001 * _sampleRate) + 1;
-        delayLine.resize(maxDelaySamples, SampleType{0});
+        delayLine.prepare(_sampleRate, maxDelayMs);
         
         reset();
     }
@@ -30,8 +28,7 @@ public:
     /** Sets the delay time in milliseconds. */
     void setDelayTime(double delayMs)
     {
-        auto newDelaySamples = static_cast<double>(delayMs * 0.001 * _sampleRate);
-        this->delaySamples = juce::jlimit(1.0, static_cast<double>(delayLine.size() - 1), newDelaySamples);
+        delayLine.setDelaySamples(delayMs * 0.001 * _sampleRate);
     }
     
     /** Sets the feedback coefficient (-1.0 to 1.0). */
@@ -40,24 +37,22 @@ public:
         feedback = juce::jlimit((SampleType)(-0.99f), (SampleType)(0.99f), newFeedback);
     }
     
+    /** Selects how fractional delays are interpolated. */
+    void setInterpolation(DelayInterpolation newInterpolation)
+    {
+        delayLine.setInterpolation(newInterpolation);
+    }
+    
     /** Processes a single sample. */
     SampleType processSample(SampleType input)
     {
-        if (delayLine.empty())
-            return 0;
-        
-        // Get delayed sample with interpolation
-        auto delayedSample = getInterpolatedSample();
+        auto delayedSample = delayLine.readSample();
         
         // Allpass equation: y[n] = -g*x[n] + x[n-d] + g*y[n-d]
         auto output = -feedback * input + delayedSample;
         
         // Store input + feedback into delay line
-        auto feedbackInput = input + feedback * delayedSample;
-        delayLine[writeIndex] = feedbackInput;
-        
-        // Advance write index
-        writeIndex = (writeIndex + 1) % delayLine.size();
+        delayLine.writeSample(input + feedback * delayedSample);
         
         return output;
     }
@@ -65,36 +60,15 @@ public:
     /** Resets the filter state. */
     void reset()
     {
-        std::fill(delayLine.begin(), delayLine.end(), SampleType{0});
-        writeIndex = 0;
+        delayLine.setDelaySamples(1.0);
+        delayLine.reset();
         feedback = SampleType{0};
-        delaySamples = 1.0;
     }
 
 private:
-    std::vector<SampleType> delayLine;
-    size_t writeIndex = 0;
+    DelayLine<SampleType, 1> delayLine;
     double _sampleRate = 44100.0;
-    double delaySamples = 1.0;
     SampleType feedback = SampleType{0};
-    
-    SampleType getInterpolatedSample() const
-    {
-        if (delayLine.empty())
-            return 0;
-        
-        auto readPosition = static_cast<double>(writeIndex) - delaySamples;
-        if (readPosition < 0.0)
-            readPosition += static_cast<double>(delayLine.size());
-            
-        auto readIndex1 = static_cast<size_t>(readPosition) % delayLine.size();
-        auto readIndex2 = (readIndex1 + 1) % delayLine.size();
-        
-        auto fraction = readPosition - std::floor(readPosition);
-        
-        return static_cast<SampleType>((1.0 - fraction) * delayLine[readIndex1] + 
-                                       fraction * delayLine[readIndex2]);
-    }
 };
 
 } // namespace Filters
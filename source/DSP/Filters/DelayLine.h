@@ -0,0 +1,226 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace DSP {
+namespace Filters {
+
+/**
+ * One sample per lane, aligned so a whole frame fits a single SIMD register
+ * (2 x double or 4 x float with SSE/NEON, 4 x double with AVX).
+ */
+template<typename SampleType, size_t NumLanes>
+struct alignas(sizeof(SampleType) * NumLanes) LaneFrame
+{
+    static_assert((NumLanes & (NumLanes - 1)) == 0, "Lane count must be a power of two");
+
+    SampleType& operator[](size_t lane) { return samples[lane]; }
+    SampleType operator[](size_t lane) const { return samples[lane]; }
+
+    std::array<SampleType, NumLanes> samples {};
+};
+
+/** Fractional delay interpolation used by DelayLine. */
+enum class DelayInterpolation
+{
+    Linear,      ///< 2 taps, cheapest, slight high-frequency loss at fractional delays
+    Lagrange3rd, ///< 4 taps, flatter magnitude response, needs at least 2 samples of delay
+    Thiran       ///< 1st order allpass, flat magnitude, one sample of state per lane, needs at least 2 samples of delay
+};
+
+/**
+ * A multi-lane fractional delay line with power-of-two capacity.
+ *
+ * Wrapping is a mask instead of a modulo, and the delay is stored as an
+ * integer tap offset plus a fractional part that are only recomputed in
+ * setDelaySamples(), so reading a sample is a couple of masked loads and
+ * a few multiply-adds per lane.
+ *
+ * Usage per sample is read() followed by write(): a delay of D samples
+ * returns the frame written D calls to write() earlier.
+ */
+template<typename SampleType, size_t NumLanes = 1>
+class DelayLine
+{
+public:
+    using Frame = LaneFrame<SampleType, NumLanes>;
+
+    DelayLine() = default;
+
+    /** Allocates the buffer for the given maximum delay in samples. */
+    void prepare(double maxDelaySamples)
+    {
+        // extra room for the interpolator taps behind the integer offset
+        const auto required = static_cast<int>(std::ceil(maxDelaySamples)) + 4;
+        const auto capacity = static_cast<size_t>(juce::nextPowerOfTwo(juce::jmax(required, 8)));
+
+        buffer.resize(capacity);
+        mask = capacity - 1;
+
+        reset();
+    }
+
+    /** Allocates the buffer for the given maximum delay in milliseconds. */
+    void prepare(double sampleRate, double maxDelayMs)
+    {
+        prepare(maxDelayMs * 0.001 * sampleRate);
+    }
+
+    /** Selects the interpolator; clears the Thiran state. */
+    void setInterpolation(DelayInterpolation newInterpolation)
+    {
+        interpolation = newInterpolation;
+        thiranState = Frame {};
+        setDelaySamples(delaySamples);
+    }
+
+    DelayInterpolation getInterpolation() const { return interpolation; }
+
+    /** Sets the delay in samples, clamped to what the buffer and interpolator support. */
+    void setDelaySamples(double newDelaySamples)
+    {
+        delaySamples = juce::jlimit(getMinimumDelaySamples(), getMaximumDelaySamples(), newDelaySamples);
+
+        auto integerPart = static_cast<size_t>(delaySamples);
+        auto fractionalPart = delaySamples - static_cast<double>(integerPart);
+
+        // Keep the fractional part where each interpolator is best behaved:
+        // centred between the middle taps for Lagrange, in [0.618, 1.618) for Thiran.
+        if (interpolation == DelayInterpolation::Lagrange3rd
+            || (interpolation == DelayInterpolation::Thiran && fractionalPart < 0.618))
+        {
+            --integerPart;
+            fractionalPart += 1.0;
+        }
+
+        tapOffset = integerPart;
+        fraction = static_cast<SampleType>(fractionalPart);
+
+        if (interpolation == DelayInterpolation::Thiran)
+            thiranCoefficient = static_cast<SampleType>((1.0 - fractionalPart) / (1.0 + fractionalPart));
+        else if (interpolation == DelayInterpolation::Lagrange3rd)
+            updateLagrangeCoefficients(fractionalPart);
+    }
+
+    double getDelaySamples() const { return delaySamples; }
+
+    /** The smallest delay the current interpolator can produce with read-before-write. */
+    double getMinimumDelaySamples() const
+    {
+        return interpolation == DelayInterpolation::Linear ? 1.0 : 2.0;
+    }
+
+    /** The largest delay the buffer can hold. */
+    double getMaximumDelaySamples() const
+    {
+        return buffer.empty() ? getMinimumDelaySamples() : static_cast<double>(buffer.size() - 4);
+    }
+
+    /** Returns the delayed frame; call before write() for the current sample. */
+    Frame read()
+    {
+        Frame output;
+
+        if (buffer.empty())
+            return output;
+
+        // a delay of k samples reads the frame written k calls to write() ago
+        const auto& newer = buffer[(writeIndex - tapOffset) & mask];
+        const auto& older = buffer[(writeIndex - tapOffset - 1) & mask];
+
+        switch (interpolation)
+        {
+            case DelayInterpolation::Linear:
+                for (size_t lane = 0; lane < NumLanes; ++lane)
+                    output[lane] = newer[lane] + fraction * (older[lane] - newer[lane]);
+                break;
+
+            case DelayInterpolation::Lagrange3rd:
+            {
+                const auto& third = buffer[(writeIndex - tapOffset - 2) & mask];
+                const auto& fourth = buffer[(writeIndex - tapOffset - 3) & mask];
+
+                for (size_t lane = 0; lane < NumLanes; ++lane)
+                    output[lane] = newer[lane] * lagrange[0] + older[lane] * lagrange[1]
+                                 + third[lane] * lagrange[2] + fourth[lane] * lagrange[3];
+                break;
+            }
+
+            case DelayInterpolation::Thiran:
+                for (size_t lane = 0; lane < NumLanes; ++lane)
+                {
+                    output[lane] = older[lane] + thiranCoefficient * (newer[lane] - thiranState[lane]);
+                    thiranState[lane] = output[lane];
+                }
+                break;
+        }
+
+        return output;
+    }
+
+    /** Stores the current input frame and advances the write head. */
+    void write(const Frame& input)
+    {
+        if (buffer.empty())
+            return;
+
+        buffer[writeIndex] = input;
+        writeIndex = (writeIndex + 1) & mask;
+    }
+
+    /** Single-lane convenience wrappers. */
+    SampleType readSample()
+    {
+        static_assert(NumLanes == 1, "readSample() is only available on single-lane delay lines");
+        return read()[0];
+    }
+
+    void writeSample(SampleType input)
+    {
+        static_assert(NumLanes == 1, "writeSample() is only available on single-lane delay lines");
+        Frame frame;
+        frame[0] = input;
+        write(frame);
+    }
+
+    /** Clears the buffer and interpolator state; the delay setting is kept. */
+    void reset()
+    {
+        std::fill(buffer.begin(), buffer.end(), Frame {});
+        thiranState = Frame {};
+        writeIndex = 0;
+        setDelaySamples(delaySamples);
+    }
+
+private:
+    void updateLagrangeCoefficients(double delta)
+    {
+        // Taps sit at delays tapOffset .. tapOffset + 3, delta in [1, 2) is measured from the first one
+        const auto d1 = delta - 1.0;
+        const auto d2 = delta - 2.0;
+        const auto d3 = delta - 3.0;
+
+        lagrange[0] = static_cast<SampleType>(-d1 * d2 * d3 / 6.0);
+        lagrange[1] = static_cast<SampleType>(delta * d2 * d3 * 0.5);
+        lagrange[2] = static_cast<SampleType>(-delta * d1 * d3 * 0.5);
+        lagrange[3] = static_cast<SampleType>(delta * d1 * d2 / 6.0);
+    }
+
+    std::vector<Frame> buffer;
+    size_t mask = 0;
+    size_t writeIndex = 0;
+
+    DelayInterpolation interpolation = DelayInterpolation::Linear;
+    double delaySamples = 1.0;
+    size_t tapOffset = 1;
+    SampleType fraction = SampleType{0};
+    SampleType thiranCoefficient = SampleType{0};
+    std::array<SampleType, 4> lagrange {};
+    Frame thiranState;
+};
+
+} // namespace Filters
+} // namespace DSP
@@ -3,61 +3,297 @@
 #include <juce_dsp/juce_dsp.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 
+#include <array>
+#include <vector>
+
+#include "../Utils/VectorOps.h"
+
 namespace DSP {
 namespace Filters {
 
 /**
  * High shelf filter for brightness.
+ *
+ * Coefficients are computed in place (same RBJ shelf as
+ * IIR::Coefficients::makeHighShelf), so setBrightness() never allocates.
+ * Frequency and Q are fixed, so only the gain dependent terms are
+ * recomputed, and only when the value actually changes. The filtering
+ * itself runs on Utils::BiquadCascade, IPP's when available.
  */
 template<typename SampleType>
 class BrightnessEQ
 {
 public:
     BrightnessEQ() = default;
-    
+
     /** Prepares the EQ with sample rate. */
     void prepare(const juce::dsp::ProcessSpec& spec)
     {
         sampleRate = spec.sampleRate;
-        highShelfFilterDuplicator.prepare(spec);
-        reset();
+        numChannels = static_cast<int>(spec.numChannels);
+        biquad.prepare(numChannels);
 
+        const auto omega = juce::MathConstants<double>::twoPi * shelfFrequency / sampleRate;
+        cosOmega = static_cast<SampleType>(std::cos(omega));
+        sinOmegaOverQ = static_cast<SampleType>(std::sin(omega) / shelfQ);
+
+        updateCoefficients(currentBrightness);
+        reset();
     }
-    
+
     /** Sets the brightness amount in dB (-12 to +12). */
     void setBrightness(SampleType brightnessDb)
     {
         brightnessDb = juce::jlimit(SampleType{-12.0}, SampleType{12.0}, brightnessDb);
-        
-        // High shelf filter at 3kHz
-        auto coeffs = juce::dsp::IIR::Coefficients<SampleType>::makeHighShelf(
-            sampleRate,
-            SampleType{3000.0}, // 3kHz cutoff
-            static_cast<SampleType>(1.2),  // Q factor
-            static_cast<SampleType>(juce::Decibels::decibelsToGain(brightnessDb))
-        );
-        
-        *highShelfFilterDuplicator.state = *coeffs;
+
+        if (juce::exactlyEqual(brightnessDb, currentBrightness))
+            return;
+
+        currentBrightness = brightnessDb;
+        updateCoefficients(brightnessDb);
     }
-        
+
     /** Processes a block of samples. */
     void processBlock(juce::AudioBuffer<SampleType>& buffer)
     {
-        juce::dsp::AudioBlock<SampleType> block(buffer);
-        juce::dsp::ProcessContextReplacing<SampleType> context(block);
-        highShelfFilterDuplicator.process(context);
+        jassert(buffer.getNumChannels() <= numChannels);
+
+        const auto channelsToProcess = juce::jmin(buffer.getNumChannels(), numChannels);
+
+        for (int channel = 0; channel < channelsToProcess; ++channel)
+            biquad.process(channel, buffer.getWritePointer(channel), buffer.getNumSamples());
     }
-    
+
     /** Resets the filter state. */
     void reset()
     {
-        highShelfFilterDuplicator.reset();
+        biquad.reset();
     }
 
 private:
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<SampleType>,
-        juce::dsp::IIR::Coefficients<SampleType>> highShelfFilterDuplicator;
+    void updateCoefficients(SampleType brightnessDb)
+    {
+        // A = sqrt(gain) = 10^(dB / 40)
+        const auto A = static_cast<SampleType>(std::pow(10.0, static_cast<double>(brightnessDb) / 40.0));
+        const auto aminus1 = A - SampleType{1.0};
+        const auto aplus1 = A + SampleType{1.0};
+        const auto beta = sinOmegaOverQ * std::sqrt(A);
+        const auto aminus1TimesCoso = aminus1 * cosOmega;
+
+        const auto a0 = aplus1 - aminus1TimesCoso + beta;
+        const auto a0Inv = SampleType{1.0} / a0;
+
+        biquad.setCoefficients(0,
+                               A * (aplus1 + aminus1TimesCoso + beta) * a0Inv,
+                               A * SampleType{-2.0} * (aminus1 + aplus1 * cosOmega) * a0Inv,
+                               A * (aplus1 + aminus1TimesCoso - beta) * a0Inv,
+                               SampleType{2.0} * (aminus1 - aplus1 * cosOmega) * a0Inv,
+                               (aplus1 - aminus1TimesCoso - beta) * a0Inv);
+    }
+
+    static constexpr double shelfFrequency = 3000.0;
+    static constexpr double shelfQ = 1.2;
+
     double sampleRate = 44100.0;
+    SampleType currentBrightness = SampleType{0.0};
+
+    SampleType cosOmega = SampleType{0.0};
+    SampleType sinOmegaOverQ = SampleType{0.0};
+
+    int numChannels = 0;
+
+    // unity until prepared
+    Utils::BiquadCascade<SampleType> biquad;
+};
+
+/**
+ * Lookup table for the bilinear prewarp g = tan(pi * f / fs).
+ *
+ * Built once per sample rate in prepare(). Frequencies up to
+ * tableLimit * fs are linearly interpolated (relative error below 1e-5),
+ * the few above fall back to std::tan.
+ */
+template<typename SampleType>
+class PrewarpTable
+{
+public:
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        step = tableLimit * sampleRate / tableSize;
+        stepInv = static_cast<SampleType>(1.0 / step);
+
+        table.resize(tableSize + 2);
+
+        for (size_t i = 0; i < table.size(); ++i)
+            table[i] = static_cast<SampleType>(std::tan(juce::MathConstants<double>::pi * step * static_cast<double>(i) / sampleRate));
+    }
+
+    SampleType get(SampleType frequency) const
+    {
+        jassert(!table.empty());
+
+        const auto position = juce::jmax(SampleType{0.0}, frequency) * stepInv;
+
+        if (position >= static_cast<SampleType>(tableSize))
+            return static_cast<SampleType>(std::tan(juce::MathConstants<double>::pi * static_cast<double>(frequency) / sampleRate));
+
+        const auto index = static_cast<size_t>(position);
+        const auto fraction = position - static_cast<SampleType>(index);
+
+        return table[index] + fraction * (table[index + 1] - table[index]);
+    }
+
+private:
+    static constexpr double tableLimit = 0.45;
+    static constexpr size_t tableSize = 2048;
+
+    double sampleRate = 44100.0;
+    double step = 1.0;
+    SampleType stepInv = SampleType{1.0};
+    std::vector<SampleType> table;
+};
+
+/**
+ * Two-pole TPT low/high pass for the cut filters.
+ *
+ * Same topology and response as juce::dsp::StateVariableTPTFilter, but the
+ * prewarp comes from a PrewarpTable instead of a tan() per cutoff change,
+ * and coefficients are only touched when the cutoff really moves.
+ */
+template<typename SampleType>
+class CutFilter
+{
+public:
+    enum class Type
+    {
+        lowpass,
+        highpass
+    };
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        prewarp.prepare(spec.sampleRate);
+        s1.assign(spec.numChannels, SampleType{0.0});
+        s2.assign(spec.numChannels, SampleType{0.0});
+        update();
+    }
+
+    void setType(Type newType) { type = newType; }
+
+    void setResonance(SampleType newResonance)
+    {
+        jassert(newResonance > SampleType{0.0});
+        R2 = SampleType{1.0} / newResonance;
+        update();
+    }
+
+    void setCutoffFrequency(SampleType newCutoff)
+    {
+        if (juce::exactlyEqual(newCutoff, cutoff))
+            return;
+
+        cutoff = newCutoff;
+        update();
+    }
+
+    SampleType processSample(int channel, SampleType input)
+    {
+        auto& ls1 = s1[(size_t) channel];
+        auto& ls2 = s2[(size_t) channel];
+
+        const auto yHP = h * (input - ls1 * (g + R2) - ls2);
+
+        const auto yBP = yHP * g + ls1;
+        ls1 = yHP * g + yBP;
+
+        const auto yLP = yBP * g + ls2;
+        ls2 = yBP * g + yLP;
+
+        return type == Type::lowpass ? yLP : yHP;
+    }
+
+    /**
+     * Filters NumChannels channels in place with the current coefficients.
+     * Same result as processSample() frame by frame, but the state stays in
+     * registers and the filter type is resolved once per block.
+     */
+    template<int NumChannels>
+    void processBlock(SampleType* const* channels, int numSamples)
+    {
+        jassert(static_cast<size_t>(NumChannels) <= s1.size());
+
+        if (type == Type::lowpass)
+            processBlockAs<NumChannels, true>(channels, numSamples);
+        else
+            processBlockAs<NumChannels, false>(channels, numSamples);
+    }
+
+    void reset()
+    {
+        std::fill(s1.begin(), s1.end(), SampleType{0.0});
+        std::fill(s2.begin(), s2.end(), SampleType{0.0});
+    }
+
+private:
+    template<int NumChannels, bool IsLowpass>
+    void processBlockAs(SampleType* const* channels, int numSamples)
+    {
+        std::array<SampleType, NumChannels> z1, z2;
+
+        for (size_t channel = 0; channel < NumChannels; ++channel)
+        {
+            z1[channel] = s1[channel];
+            z2[channel] = s2[channel];
+        }
+
+        const auto gLocal = g;
+        const auto gPlusR2 = g + R2;
+        const auto hLocal = h;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (size_t channel = 0; channel < NumChannels; ++channel)
+            {
+                const auto input = channels[channel][i];
+                const auto yHP = hLocal * (input - z1[channel] * gPlusR2 - z2[channel]);
+
+                const auto yBP = yHP * gLocal + z1[channel];
+                z1[channel] = yHP * gLocal + yBP;
+
+                const auto yLP = yBP * gLocal + z2[channel];
+                z2[channel] = yBP * gLocal + yLP;
+
+                channels[channel][i] = IsLowpass ? yLP : yHP;
+            }
+        }
+
+        for (size_t channel = 0; channel < NumChannels; ++channel)
+        {
+            s1[channel] = z1[channel];
+            s2[channel] = z2[channel];
+        }
+    }
+
+    void update()
+    {
+        // not prepared yet, prepare() calls back in
+        if (s1.empty())
+            return;
+
+        g = prewarp.get(cutoff);
+        h = SampleType{1.0} / (SampleType{1.0} + R2 * g + g * g);
+    }
+
+    PrewarpTable<SampleType> prewarp;
+
+    Type type = Type::lowpass;
+    SampleType cutoff = SampleType{1000.0};
+    SampleType R2 = static_cast<SampleType>(juce::MathConstants<double>::sqrt2);
+    SampleType g = SampleType{0.0};
+    SampleType h = SampleType{1.0};
+
+    std::vector<SampleType> s1, s2;
 };
 
 } // namespace Filters
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "DelayLine.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace DSP {
+namespace Filters {
+
+/**
+ * An AllpassFilter that runs NumLanes channels with identical delay and
+ * feedback in lock step. The delay line is interleaved by frame, so every
+ * lane shares the read/write index and interpolation coefficients, and the
+ * per-lane arithmetic is a fixed-length loop the compiler turns into a
+ * single vector operation.
+ */
+template<typename SampleType, size_t NumLanes>
+class PackedAllpassFilter
+{
+public:
+    using Frame = LaneFrame<SampleType, NumLanes>;
+
+    PackedAllpassFilter() = default;
+    
+    /** Prepares the filter with sample rate and maximum delay time. */
+    void prepare(double newSampleRate, double maxDelayMs)
+    {
+        _sampleRate = newSampleRate;
+        delayLine.prepare(_sampleRate, maxDelayMs);
+        
+        reset();
+    }
+    
+    /** Sets the delay time in milliseconds. */
+    void setDelayTime(double delayMs)
+    {
+        delayLine.setDelaySamples(delayMs * 0.001 * _sampleRate);
+    }
+    
+    /** Sets the feedback coefficient (-1.0 to 1.0), shared by all lanes. */
+    void setFeedback(SampleType newFeedback)
+    {
+        feedback = juce::jlimit((SampleType)(-0.99f), (SampleType)(0.99f), newFeedback);
+    }
+    
+    /** Selects how fractional delays are interpolated. */
+    void setInterpolation(DelayInterpolation newInterpolation)
+    {
+        delayLine.setInterpolation(newInterpolation);
+    }
+    
+    /** Processes one frame in place. */
+    void processFrame(Frame& frame)
+    {
+        const auto delayed = delayLine.read();
+        Frame stored;
+        
+        for (size_t lane = 0; lane < NumLanes; ++lane)
+        {
+            // Allpass equation: y[n] = -g*x[n] + x[n-d] + g*y[n-d]
+            const auto input = frame[lane];
+            
+            stored[lane] = input + feedback * delayed[lane];
+            frame[lane] = -feedback * input + delayed[lane];
+        }
+        
+        delayLine.write(stored);
+    }
+    
+    /** Resets the filter state. */
+    void reset()
+    {
+        delayLine.setDelaySamples(1.0);
+        delayLine.reset();
+        feedback = SampleType{0};
+    }
+
+private:
+    DelayLine<SampleType, NumLanes> delayLine;
+    double _sampleRate = 44100.0;
+    SampleType feedback = SampleType{0};
+};
+
+} // namespace Filters
+} // namespace DSP
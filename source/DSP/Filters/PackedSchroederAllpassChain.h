@@ -0,0 +1,208 @@
+#pragma once
+
+#include "PackedAllpassFilter.h"
+#include "../Utils/ParameterSmoother.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cmath>
+
+namespace DSP {
+namespace Filters {
+
+/**
+ * A SchroederAllpassChain that processes NumLanes channels as lanes of one
+ * frame. All lanes always share delay time and character, so the parameter
+ * smoothing and coefficient updates are done once for the whole frame
+ * instead of once per channel.
+ *
+ * Use NumLanes = 2 for stereo; 4 is available for quad/ambisonic layouts.
+ */
+template<typename SampleType, size_t NumLanes>
+class PackedSchroederAllpassChain
+{
+public:
+    static constexpr size_t NumAllpassFilters = 4;
+    static constexpr size_t numLanes = NumLanes;
+
+    using Frame = LaneFrame<SampleType, NumLanes>;
+    
+    PackedSchroederAllpassChain() = default;
+    
+    /** Prepares the chain with sample rate. */
+    void prepare(double newSampleRate, SampleType initialDelayMs = SampleType{30.0}, SampleType initialCharacter = SampleType{1.0})
+    {
+        _sampleRate = newSampleRate;
+
+        // Prime delay times for diffusion (in milliseconds)
+        std::array<double, NumAllpassFilters> delayTimes = {12.3, 19.7, 29.1, 37.4};
+
+        for (size_t i = 0; i < NumAllpassFilters; ++i)
+        {
+            allpassFilters[i].prepare(_sampleRate, maxDelayMs);
+            allpassFilters[i].setDelayTime(delayTimes[i]);
+            allpassFilters[i].setFeedback(static_cast<SampleType>(0.7)); // Default feedback
+        }
+
+        // Prepare parameter smoothers
+        delayTimeSmoother.prepare(_sampleRate, 50.0); // 50ms smoothing
+        characterSmoother.prepare(_sampleRate, 10.0); // 10ms smoothing
+
+        // Set and snap to initial values to avoid ramping artifacts
+        delayTimeSmoother.setTargetValue(initialDelayMs);
+        delayTimeSmoother.snapToTargetValue();
+        characterSmoother.setTargetValue(initialCharacter);
+        characterSmoother.snapToTargetValue();
+
+        parametersNeedUpdate = true;
+    }
+    
+    /** Sets the base delay time (will be scaled for each filter). */
+    void setDelayTime(SampleType delayMs)
+    {
+        delayTimeSmoother.setTargetValue(juce::jlimit(SampleType{1.0}, SampleType{100.0}, delayMs));
+    }
+    
+    /** Sets the character (feedback amount) - higher values = more resonant. */
+    void setCharacter(SampleType character)
+    {
+        characterSmoother.setTargetValue(juce::jlimit(static_cast<SampleType>(0.1), static_cast<SampleType>(10.0), static_cast<SampleType>(character)));
+    }
+    
+    /** Processes one frame (one sample per lane) through the allpass chain. */
+    void processFrame(Frame& frame)
+    {
+        // Coefficients only change while a smoother is moving
+        if (parametersNeedUpdate || delayTimeSmoother.isSmoothing() || characterSmoother.isSmoothing())
+            updateParameters();
+        
+        for (auto& filter : allpassFilters)
+        {
+            filter.processFrame(frame);
+        }
+    }
+    
+    /**
+     * Processes numChannels planar channels in place. Channels beyond the
+     * lane count are left untouched; unused lanes are fed silence.
+     */
+    void processBlock(SampleType* const* channels, int numChannels, int numSamples)
+    {
+        // mono and full width get their own loops, with the lane count known at compile time
+        if (numChannels == 1)
+            processBlock<1>(channels, numSamples);
+        else if (numChannels >= static_cast<int>(NumLanes))
+            processBlock<NumLanes>(channels, numSamples);
+        else if (numChannels > 0)
+            processLanes(channels, static_cast<size_t>(numChannels), numSamples);
+    }
+
+    /** processBlock() for a fixed number of active lanes. */
+    template<size_t NumActiveLanes>
+    void processBlock(SampleType* const* channels, int numSamples)
+    {
+        static_assert(NumActiveLanes >= 1 && NumActiveLanes <= NumLanes);
+        processLanes(channels, NumActiveLanes, numSamples);
+    }
+    
+    /**
+     * Time for the chain's impulse response to decay by decayDb at the given
+     * settings (clamped as setDelayTime() and setCharacter() do).
+     *
+     * Each allpass loses a factor of feedback per trip around its delay, so
+     * it needs ln(decay) / ln(feedback) trips to ring out. The filters are in
+     * series, so their ring-out times are added, plus one extra trip each for
+     * the build-up. That bounds the real tail from above: measured decays are
+     * 2 to 3.5 times shorter, closest at high character.
+     */
+    static double getTailLengthSeconds(SampleType baseDelayMs, SampleType character, double decayDb = 120.0)
+    {
+        baseDelayMs = juce::jlimit(SampleType{1.0}, SampleType{100.0}, baseDelayMs);
+        character = juce::jlimit(static_cast<SampleType>(0.1), static_cast<SampleType>(10.0), character);
+
+        const auto feedback = static_cast<double>(feedbackForCharacter(character));
+        const auto trips = std::ceil(decayDb / 20.0 * std::log(10.0) / -std::log(feedback)) + 1.0;
+
+        double tailMs = 0.0;
+
+        for (auto scale : delayScales)
+            tailMs += trips * juce::jmin(maxDelayMs, static_cast<double>(baseDelayMs * scale));
+
+        return tailMs * 0.001;
+    }
+
+    /** Resets the filter chain. */
+    void reset(SampleType initialDelayMs = SampleType{30.0}, SampleType initialCharacter = SampleType{1.0})
+    {
+        for (auto& filter : allpassFilters)
+        {
+            filter.reset();
+        }
+
+        delayTimeSmoother.reset(initialDelayMs);
+        delayTimeSmoother.setTargetValue(initialDelayMs);
+        delayTimeSmoother.snapToTargetValue();
+        characterSmoother.reset(initialCharacter);
+        characterSmoother.setTargetValue(initialCharacter);
+        characterSmoother.snapToTargetValue();
+
+        parametersNeedUpdate = true;
+    }
+
+private:
+    std::array<PackedAllpassFilter<SampleType, NumLanes>, NumAllpassFilters> allpassFilters;
+    Utils::ParameterSmoother<SampleType> delayTimeSmoother;
+    Utils::ParameterSmoother<SampleType> characterSmoother;
+    
+    static constexpr double maxDelayMs = 100.0;
+
+    double _sampleRate = 44100.0;
+    bool parametersNeedUpdate = true;
+
+    // Scale delay times with different ratios for each filter
+    static constexpr std::array<SampleType, NumAllpassFilters> delayScales = {
+        static_cast<SampleType>(0.41), static_cast<SampleType>(0.66), static_cast<SampleType>(0.97), static_cast<SampleType>(1.25)
+    };
+
+    /** Feedback from the character parameter (logarithmic scaling). */
+    static SampleType feedbackForCharacter(SampleType character)
+    {
+        auto feedback = static_cast<SampleType>(0.3 + 0.6 * (std::log(character) / std::log(10.0)));
+        return juce::jlimit(static_cast<SampleType>(0.1), static_cast<SampleType>(0.9), feedback);
+    }
+    
+    // forced inline, so a constant lane count from processBlock<N>() unrolls the lane loops
+    JUCE_FORCEINLINE void processLanes(SampleType* const* channels, size_t numActiveLanes, int numSamples)
+    {
+        Frame frame;
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (size_t lane = 0; lane < numActiveLanes; ++lane)
+                frame[lane] = channels[lane][i];
+            
+            processFrame(frame);
+            
+            for (size_t lane = 0; lane < numActiveLanes; ++lane)
+                channels[lane][i] = frame[lane];
+        }
+    }
+
+    void updateParameters()
+    {
+        parametersNeedUpdate = false;
+
+        auto baseDelayTime = delayTimeSmoother.getNextValue();
+        auto character = characterSmoother.getNextValue();
+        auto feedback = feedbackForCharacter(character);
+        
+        for (size_t i = 0; i < NumAllpassFilters; ++i)
+        {
+            auto scaledDelay = baseDelayTime * delayScales[i];
+            allpassFilters[i].setDelayTime(static_cast<double>(scaledDelay));
+            allpassFilters[i].setFeedback(feedback);
+        }
+    }
+};
+
+} // namespace Filters
+} // namespace DSP
@@ -44,6 +44,8 @@ public:
         delayTimeSmoother.snapToTargetValue();
         characterSmoother.setTargetValue(initialCharacter);
         characterSmoother.snapToTargetValue();
+
+        parametersNeedUpdate = true;
     }
     
     /** Sets the base delay time (will be scaled for each filter). */
@@ -61,7 +63,9 @@ public:
     /** Processes a single sample through the allpass chain. */
     SampleType processSample(SampleType input)
     {
-        updateParameters();
+        // Coefficients only change while a smoother is moving
+        if (parametersNeedUpdate || delayTimeSmoother.isSmoothing() || characterSmoother.isSmoothing())
+            updateParameters();
         
         auto output = input;
         
@@ -97,6 +101,8 @@ public:
         characterSmoother.reset(initialCharacter);
         characterSmoother.setTargetValue(initialCharacter);
         characterSmoother.snapToTargetValue();
+
+        parametersNeedUpdate = true;
     }
 
 private:
@@ -105,9 +111,12 @@ private:
     Utils::ParameterSmoother<SampleType> characterSmoother;
     
     double _sampleRate = 44100.0;
+    bool parametersNeedUpdate = true;
     
     void updateParameters()
     {
+        parametersNeedUpdate = false;
+
         auto baseDelayTime = delayTimeSmoother.getNextValue();
         auto character = characterSmoother.getNextValue();
         
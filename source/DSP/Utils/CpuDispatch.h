@@ -0,0 +1,124 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+
+#if JUCE_INTEL && JUCE_64BIT && (JUCE_GCC || JUCE_CLANG)
+    #include <cpuid.h>
+#endif
+
+/**
+ * Function attributes that compile one function, and everything it inlines,
+ * for a given instruction set. Only GCC and Clang on x86-64 can retarget a
+ * single function; elsewhere each variant is the baseline build (NEON on
+ * ARM, the /arch setting on MSVC), so dispatching is harmless but pointless.
+ *
+ * flatten makes the whole call tree below the function inline into it, so
+ * the header-only kernels are recompiled for the target rather than called
+ * in their baseline versions.
+ */
+#if JUCE_INTEL && JUCE_64BIT && (JUCE_GCC || JUCE_CLANG)
+    #define CHASM_CPU_DISPATCH 1
+    #define CHASM_TARGET_BASELINE __attribute__ ((flatten))
+    #define CHASM_TARGET_AVX2 __attribute__ ((flatten, target ("avx2,fma")))
+    #define CHASM_TARGET_AVX512 __attribute__ ((flatten, target ("avx512f,avx512vl,avx512bw,avx512dq,avx2,fma")))
+#else
+    #define CHASM_CPU_DISPATCH 0
+    #define CHASM_TARGET_BASELINE
+    #define CHASM_TARGET_AVX2
+    #define CHASM_TARGET_AVX512
+#endif
+
+namespace DSP {
+namespace Utils {
+
+/** The instruction sets hot code is compiled for, in order of preference. */
+enum class InstructionSet
+{
+    baseline, ///< whatever the build targets, SSE2 on x86-64
+    avx2,     ///< AVX2 and FMA3
+    avx512,   ///< AVX-512 F, VL, BW and DQ
+    numInstructionSets
+};
+
+/**
+ * Runtime selection between the InstructionSet variants, from the CPU's
+ * cpuid feature bits as reported by juce::SystemStats, and whether the OS
+ * saves the wider registers on a context switch (XCR0).
+ */
+class CpuDispatch
+{
+public:
+    /** True if this machine can run code compiled for the given instruction set. */
+    static bool isSupported(InstructionSet instructionSet)
+    {
+        using Stats = juce::SystemStats;
+
+        switch (instructionSet)
+        {
+            case InstructionSet::baseline:
+                return true;
+
+           #if CHASM_CPU_DISPATCH
+            case InstructionSet::avx2:
+                return Stats::hasAVX2() && Stats::hasFMA3() && osSavesState(ymmState);
+
+            case InstructionSet::avx512:
+                return isSupported(InstructionSet::avx2) && Stats::hasAVX512F() && Stats::hasAVX512VL()
+                    && Stats::hasAVX512BW() && Stats::hasAVX512DQ() && osSavesState(ymmState | zmmState);
+           #endif
+
+            default:
+                return false;
+        }
+    }
+
+    /** The most capable instruction set this machine supports. */
+    static InstructionSet getBestInstructionSet()
+    {
+        for (auto index = static_cast<int>(InstructionSet::numInstructionSets) - 1; index > 0; --index)
+            if (isSupported(static_cast<InstructionSet>(index)))
+                return static_cast<InstructionSet>(index);
+
+        return InstructionSet::baseline;
+    }
+
+    static const char* getName(InstructionSet instructionSet)
+    {
+        static constexpr std::array<const char*, 3> names { "baseline", "AVX2", "AVX-512" };
+
+        jassert(instructionSet < InstructionSet::numInstructionSets);
+        return names[static_cast<size_t>(instructionSet)];
+    }
+
+private:
+   #if CHASM_CPU_DISPATCH
+    // XCR0 bits: SSE and AVX registers; AVX-512 opmask, upper ZMM0-15 and ZMM16-31
+    static constexpr unsigned long long ymmState = 0x06;
+    static constexpr unsigned long long zmmState = 0xe0;
+
+    /**
+     * True if the OS has enabled XSAVE and saves all the given register state.
+     * A CPU can report AVX while the OS (or a hypervisor) leaves the registers
+     * unsaved, in which case using them faults or corrupts other threads.
+     */
+    static bool osSavesState(unsigned long long stateMask)
+    {
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0 || (ecx & bit_OSXSAVE) == 0)
+            return false;
+
+        // xgetbv directly, as _xgetbv() needs the function compiled for XSAVE
+        unsigned int low = 0, high = 0;
+        __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+
+        const auto xcr0 = (static_cast<unsigned long long>(high) << 32) | low;
+        return (xcr0 & stateMask) == stateMask;
+    }
+   #endif
+};
+
+} // namespace Utils
+} // namespace DSP
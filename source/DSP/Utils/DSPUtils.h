@@ -3,89 +3,103 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <cmath>
 
+#include "Saturation.h"
+
 namespace DSP {
 namespace Utils {
 
 /**
- * Utility functions for DSP processing.
+ * Utility functions for DSP processing, for float and double.
  */
 class DSPUtils
 {
 public:
     /** Converts decibels to linear gain. */
-    static inline float dbToGain(float db)
+    template<typename SampleType>
+    static inline SampleType dbToGain(SampleType db)
     {
-        return std::pow(10.0f, db * 0.05f);
+        return std::pow(SampleType{10.0}, db * SampleType{0.05});
     }
     
     /** Converts linear gain to decibels. */
-    static inline float gainToDb(float gain)
+    template<typename SampleType>
+    static inline SampleType gainToDb(SampleType gain)
     {
-        return 20.0f * std::log10(std::max(gain, 1e-6f));
+        return SampleType{20.0} * std::log10(std::max(gain, SampleType{1e-6}));
     }
     
     /** Converts percentage (0-100) to normalized value (0-1). */
-    static inline float percentageToNormalized(float percentage)
+    template<typename SampleType>
+    static inline SampleType percentageToNormalized(SampleType percentage)
     {
-        return juce::jlimit(0.0f, 1.0f, percentage * 0.01f);
+        return juce::jlimit(SampleType{0.0}, SampleType{1.0}, percentage * SampleType{0.01});
     }
     
     /** Converts normalized value (0-1) to percentage (0-100). */
-    static inline float normalizedToPercentage(float normalized)
+    template<typename SampleType>
+    static inline SampleType normalizedToPercentage(SampleType normalized)
     {
-        return juce::jlimit(0.0f, 100.0f, normalized * 100.0f);
+        return juce::jlimit(SampleType{0.0}, SampleType{100.0}, normalized * SampleType{100.0});
     }
     
     /** Logarithmic scaling for delay time (1-100ms range). */
-    static inline float normalizedToDelayMs(float normalized)
+    template<typename SampleType>
+    static inline SampleType normalizedToDelayMs(SampleType normalized)
     {
         // Logarithmic scaling from 1ms to 100ms
-        return 1.0f + (99.0f * std::pow(normalized, 2.0f));
+        return SampleType{1.0} + (SampleType{99.0} * std::pow(normalized, SampleType{2.0}));
     }
     
     /** Inverse logarithmic scaling for delay time. */
-    static inline float delayMsToNormalized(float delayMs)
+    template<typename SampleType>
+    static inline SampleType delayMsToNormalized(SampleType delayMs)
     {
         // Inverse of logarithmic scaling
-        return std::sqrt((delayMs - 1.0f) / 99.0f);
+        return std::sqrt((delayMs - SampleType{1.0}) / SampleType{99.0});
     }
     
     /** Logarithmic scaling for Q factor (0.1-10 range). */
-    static inline float normalizedToQFactor(float normalized)
+    template<typename SampleType>
+    static inline SampleType normalizedToQFactor(SampleType normalized)
     {
         // Logarithmic scaling from 0.1 to 10
-        return 0.1f * std::pow(100.0f, normalized);
+        return SampleType{0.1} * std::pow(SampleType{100.0}, normalized);
     }
     
     /** Inverse logarithmic scaling for Q factor. */
-    static inline float qFactorToNormalized(float qFactor)
+    template<typename SampleType>
+    static inline SampleType qFactorToNormalized(SampleType qFactor)
     {
         // Inverse of logarithmic scaling
-        return std::log10(qFactor / 0.1f) / 2.0f;
+        return std::log10(qFactor / SampleType{0.1}) / SampleType{2.0};
     }
     
     /** Soft clipping for audio signals. */
-    static inline float softClip(float input)
+    template<typename SampleType>
+    static inline SampleType softClip(SampleType input)
     {
-        return std::tanh(input);
+        return Saturation::tanhPade(input);
     }
     
     /** Hard clipping for audio signals. */
-    static inline float hardClip(float input, float threshold = 1.0f)
+    template<typename SampleType>
+    static inline SampleType hardClip(SampleType input, SampleType threshold = SampleType{1.0})
     {
         return juce::jlimit(-threshold, threshold, input);
     }
     
     /** Linear interpolation between two values. */
-    static inline float lerp(float a, float b, float t)
+    template<typename SampleType>
+    static inline SampleType lerp(SampleType a, SampleType b, SampleType t)
     {
         return a + t * (b - a);
     }
     
     /** Check if a floating point number is denormal and flush to zero if needed. */
-    static inline float flushDenormalToZero(float input)
+    template<typename SampleType>
+    static inline SampleType flushDenormalToZero(SampleType input)
     {
-        return std::abs(input) < 1e-30f ? 0.0f : input;
+        return std::abs(input) < SampleType{1e-30} ? SampleType{0.0} : input;
     }
 };
 
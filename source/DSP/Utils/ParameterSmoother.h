@@ -9,11 +9,18 @@ namespace Utils {
 /**
  * A parameter smoother with configurable smoothing time.
  * Uses exponential smoothing for natural parameter transitions.
+ *
+ * Once the value is within settleEpsilon (relative to the target, or
+ * absolute below 1.0), or stops moving because the step has dropped below
+ * the sample type's precision, it snaps to the target and isSmoothing()
+ * returns false, so callers can skip recomputing anything derived from it.
  */
 template<typename SampleType>
 class ParameterSmoother
 {
 public:
+    static constexpr double settleEpsilon = 1.0e-6;
+
     ParameterSmoother() = default;
     
     /** Prepares the smoother with sample rate and smoothing time. */
@@ -40,30 +47,57 @@ public:
     void setTargetValue(SampleType newTargetValue)
     {
         targetValue = newTargetValue;
+        settleThreshold = getSettleThreshold(targetValue);
+        smoothing = std::abs(targetValue - currentValue) > settleThreshold;
+
+        if (!smoothing)
+            currentValue = targetValue;
     }
     
     /** Gets the next smoothed sample. */
     SampleType getNextValue()
     {
-        currentValue += smoothingCoeff * (targetValue - currentValue);
+        if (smoothing)
+            advance();
+
         return currentValue;
     }
     
+    /** Renders the next numSamples smoothed values into a buffer. */
+    void getNextValues(SampleType* destination, int numSamples)
+    {
+        int i = 0;
+
+        for (; smoothing && i < numSamples; ++i)
+        {
+            advance();
+            destination[i] = currentValue;
+        }
+
+        std::fill(destination + i, destination + numSamples, currentValue);
+    }
+    
+    /** Advances the smoother by numSamples without returning the values. */
+    void skip(int numSamples)
+    {
+        for (int i = 0; smoothing && i < numSamples; ++i)
+        {
+            advance();
+        }
+    }
+    
     /** Processes a block of samples with the same target value. */
     void processBlock(SampleType* samples, int numSamples, SampleType newTargetValue)
     {
         setTargetValue(newTargetValue);
-        
-        for (int i = 0; i < numSamples; ++i)
-        {
-            samples[i] = getNextValue();
-        }
+        getNextValues(samples, numSamples);
     }
     
     /** Skips to the target value immediately (useful for initialization). */
     void snapToTargetValue()
     {
         currentValue = targetValue;
+        smoothing = false;
     }
     
     /** Gets the current smoothed value without advancing. */
@@ -72,18 +106,43 @@ public:
     /** Gets the target value. */
     SampleType getTargetValue() const { return targetValue; }
     
+    /** True while the value is still moving towards the target. */
+    bool isSmoothing() const { return smoothing; }
+    
     /** Resets the smoother to a specific value. */
     void reset(SampleType initialValue = SampleType{0})
     {
         currentValue = targetValue = initialValue;
+        settleThreshold = getSettleThreshold(targetValue);
+        smoothing = false;
     }
 
 private:
+    static SampleType getSettleThreshold(SampleType target)
+    {
+        return static_cast<SampleType>(settleEpsilon * std::max(1.0, std::abs(static_cast<double>(target))));
+    }
+
+    void advance()
+    {
+        const auto previousValue = currentValue;
+        currentValue += smoothingCoeff * (targetValue - currentValue);
+
+        if (std::abs(targetValue - currentValue) <= settleThreshold || juce::exactlyEqual(currentValue, previousValue))
+        {
+            currentValue = targetValue;
+            smoothing = false;
+        }
+    }
+
+
     double _sampleRate = 44100.0;
     double _smoothingTimeMs = 0.0;
     SampleType smoothingCoeff = SampleType{1};
     SampleType currentValue = SampleType{0};
     SampleType targetValue = SampleType{0};
+    SampleType settleThreshold = static_cast<SampleType>(settleEpsilon);
+    bool smoothing = false;
 };
 
 } // namespace Utils
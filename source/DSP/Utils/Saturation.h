@@ -0,0 +1,258 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace DSP {
+namespace Utils {
+
+/**
+ * Saturation curves shared by the waveshapers and clippers.
+ *
+ * Every curve has a scalar version and a block version working in place on
+ * a channel. The block loops are branch free (integer clamps, selects and
+ * plain arithmetic, see clampMagnitude()) so the compiler turns them into
+ * SIMD code; apart from tanhTable's lookup none of them touch memory or
+ * call into libm.
+ *
+ * All curves map NaN to zero and clamp their input, so infinities saturate
+ * to the curve's limits and the output is always finite.
+ *
+ * Maximum absolute error against the exact curve, measured over the whole
+ * real line in double precision (float adds ~1 ulp of rounding):
+ * - tanhPade:  1.0e-4  (largest just below the clamp point, |x| ~ 4.97)
+ * - tanhTable: 1.6e-6  (linear interpolation, 2048 points over [0, 8])
+ * - softKnee, cubic, asymmetric: exact by definition (asymmetric inherits
+ *   the tanhPade error, twice)
+ */
+class Saturation
+{
+public:
+    /** Replaces NaN with zero, without branching. Infinities are left for the clamps. */
+    template<typename SampleType>
+    static inline SampleType scrubNaN(SampleType x) noexcept
+    {
+        using Bits = BitsOf<SampleType>;
+
+        const auto bits = Bits::from(x);
+        const auto isNumber = static_cast<typename Bits::Type>((bits & Bits::magnitudeMask) <= Bits::infinity);
+
+        return Bits::to(bits & (typename Bits::Type{0} - isNumber));
+    }
+
+    //==============================================================================
+    /**
+     * tanh from its [7/6] Pade approximant. The input is clamped at 4.97, where
+     * the approximant is 0.9999994 and still rising, so the output stays
+     * within [-1, 1] without a second clamp.
+     */
+    template<typename SampleType>
+    static inline SampleType tanhPade(SampleType x) noexcept
+    {
+        x = clampMagnitude(x, static_cast<SampleType>(4.97));
+        const auto x2 = x * x;
+
+        const auto numerator = x * (SampleType{135135.0} + x2 * (SampleType{17325.0} + x2 * (SampleType{378.0} + x2)));
+        const auto denominator = SampleType{135135.0} + x2 * (SampleType{62370.0} + x2 * (SampleType{3150.0} + x2 * SampleType{28.0}));
+
+        return numerator / denominator;
+    }
+
+    /** tanhPade(x * drive) over a block, in place. */
+    template<typename SampleType>
+    static void tanhPade(SampleType* data, int numSamples, SampleType drive = SampleType{1.0}) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = tanhPade(data[i] * drive);
+    }
+
+    //==============================================================================
+    /** tanh by linear interpolation in a precomputed table; odd symmetry is used, so only [0, 8] is stored. */
+    template<typename SampleType>
+    static inline SampleType tanhTable(SampleType x) noexcept
+    {
+        const auto& table = getTanhTable<SampleType>();
+
+        x = clampMagnitude(x, static_cast<SampleType>(tanhTableRange));
+        const auto position = std::abs(x) * static_cast<SampleType>(tanhTableScale);
+        const auto index = static_cast<size_t>(position);
+        const auto fraction = position - static_cast<SampleType>(index);
+        const auto magnitude = table[index] + fraction * (table[index + 1] - table[index]);
+
+        return std::copysign(magnitude, x);
+    }
+
+    /** tanhTable(x * drive) over a block, in place. */
+    template<typename SampleType>
+    static void tanhTable(SampleType* data, int numSamples, SampleType drive = SampleType{1.0}) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = tanhTable(data[i] * drive);
+    }
+
+    /**
+     * Builds the tanh table. It is built on first use otherwise, so call this
+     * from prepare() to keep the 2k tanh() calls off the audio thread.
+     */
+    template<typename SampleType>
+    static void prepareTanhTable() noexcept
+    {
+        juce::ignoreUnused(getTanhTable<SampleType>());
+    }
+
+    //==============================================================================
+    /**
+     * Linear up to 1 - knee, then a quadratic knee into a hard ceiling of 1 at
+     * 1 + knee. knee is in (0, 1]; the curve and its slope are continuous.
+     */
+    template<typename SampleType>
+    static inline SampleType softKnee(SampleType x, SampleType knee) noexcept
+    {
+        jassert(knee > SampleType{0.0} && knee <= SampleType{1.0});
+
+        x = clampMagnitude(x, SampleType{1.0} + knee);
+        const auto magnitude = std::abs(x);
+        const auto overKnee = positivePart(magnitude - (SampleType{1.0} - knee));
+
+        return std::copysign(magnitude - overKnee * overKnee / (SampleType{4.0} * knee), x);
+    }
+
+    template<typename SampleType>
+    static void softKnee(SampleType* data, int numSamples, SampleType knee, SampleType drive = SampleType{1.0}) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = softKnee(data[i] * drive, knee);
+    }
+
+    //==============================================================================
+    /**
+     * tanh(x + bias) - tanh(bias): a biased tanh with the DC offset at
+     * silence removed. Clips harder on the side the bias points to, which
+     * adds even harmonics. Output range is (-1 - tanh(bias), 1 - tanh(bias)).
+     */
+    template<typename SampleType>
+    static inline SampleType asymmetric(SampleType x, SampleType bias) noexcept
+    {
+        return tanhPade(scrubNaN(x) + bias) - tanhPade(bias);
+    }
+
+    template<typename SampleType>
+    static void asymmetric(SampleType* data, int numSamples, SampleType bias, SampleType drive = SampleType{1.0}) noexcept
+    {
+        const auto offset = tanhPade(bias);
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = tanhPade(scrubNaN(data[i] * drive) + bias) - offset;
+    }
+
+    //==============================================================================
+    /** 1.5 * (x - x^3 / 3) on [-1, 1], +-1 outside: the classic cubic soft clipper, scaled to unity ceiling. */
+    template<typename SampleType>
+    static inline SampleType cubic(SampleType x) noexcept
+    {
+        x = clampMagnitude(x, SampleType{1.0});
+        return SampleType{1.5} * x - SampleType{0.5} * x * x * x;
+    }
+
+    template<typename SampleType>
+    static void cubic(SampleType* data, int numSamples, SampleType drive = SampleType{1.0}) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = cubic(data[i] * drive);
+    }
+
+private:
+    static constexpr size_t tanhTableSize = 2049;
+    static constexpr double tanhTableRange = 8.0;
+    static constexpr double tanhTableScale = (tanhTableSize - 1) / tanhTableRange;
+
+    /**
+     * The clamps work on the IEEE bit patterns: for non-negative floats the
+     * integer order is the numeric order, so the magnitude can be limited
+     * with an integer min and the sign put back afterwards. Unlike float
+     * compares, integer compares cannot trap, so GCC if-converts and
+     * vectorises them without -fno-trapping-math (with SSE2 for float, AVX2
+     * for double). NaN is mapped to zero and infinities to the limit.
+     */
+    template<typename SampleType>
+    struct BitsOf
+    {
+        static_assert(std::is_same_v<SampleType, float> || std::is_same_v<SampleType, double>);
+
+        using Type = std::conditional_t<std::is_same_v<SampleType, float>, std::uint32_t, std::uint64_t>;
+        using SignedType = std::make_signed_t<Type>;
+
+        static constexpr int numBits = static_cast<int>(sizeof(Type) * 8);
+        static constexpr Type signMask = Type{1} << (numBits - 1);
+        static constexpr Type magnitudeMask = ~signMask;
+        static constexpr Type mantissaMask = (Type{1} << (std::numeric_limits<SampleType>::digits - 1)) - 1;
+        static constexpr Type infinity = magnitudeMask & ~mantissaMask; // all exponent bits set
+
+        static inline Type from(SampleType x) noexcept
+        {
+            Type bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            return bits;
+        }
+
+        static inline SampleType to(Type bits) noexcept
+        {
+            SampleType x;
+            std::memcpy(&x, &bits, sizeof(x));
+            return x;
+        }
+    };
+
+    /** NaN -> 0, otherwise sign(x) * min(|x|, limit). limit must be positive. */
+    template<typename SampleType>
+    static inline SampleType clampMagnitude(SampleType x, SampleType limit) noexcept
+    {
+        using Bits = BitsOf<SampleType>;
+
+        const auto bits = Bits::from(x);
+        const auto limitBits = Bits::from(limit);
+
+        auto magnitude = bits & Bits::magnitudeMask;
+        magnitude = magnitude > Bits::infinity ? typename Bits::Type{0} : magnitude;
+        magnitude = magnitude < limitBits ? magnitude : limitBits;
+
+        return Bits::to(magnitude | (bits & Bits::signMask));
+    }
+
+    /** max(x, 0) by masking out negative values. */
+    template<typename SampleType>
+    static inline SampleType positivePart(SampleType x) noexcept
+    {
+        using Bits = BitsOf<SampleType>;
+
+        const auto bits = Bits::from(x);
+        const auto negativeMask = static_cast<typename Bits::Type>(static_cast<typename Bits::SignedType>(bits) >> (Bits::numBits - 1));
+
+        return Bits::to(bits & ~negativeMask);
+    }
+
+    template<typename SampleType>
+    static const std::array<SampleType, tanhTableSize + 1>& getTanhTable() noexcept
+    {
+        static const auto table = []
+        {
+            std::array<SampleType, tanhTableSize + 1> values {};
+
+            for (size_t i = 0; i < values.size(); ++i)
+                values[i] = static_cast<SampleType>(std::tanh(static_cast<double>(i) / tanhTableScale));
+
+            return values;
+        }();
+
+        return table;
+    }
+};
+
+} // namespace Utils
+} // namespace DSP
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace DSP {
+namespace Utils {
+
+/**
+ * Minimum over the last windowLength values pushed, in amortised O(1).
+ *
+ * Keeps a monotonic deque of candidates (each value is pushed and popped
+ * at most once), stored in a preallocated power-of-two ring so push() never
+ * allocates.
+ */
+template<typename SampleType>
+class SlidingWindowMinimum
+{
+public:
+    /** Allocates for the given window; call before push(). */
+    void prepare(int newWindowLength)
+    {
+        jassert(newWindowLength > 0);
+
+        windowLength = newWindowLength;
+        const auto capacity = static_cast<size_t>(juce::nextPowerOfTwo(windowLength + 1)); // + 1 for the entry that expires during push()
+
+        values.resize(capacity);
+        indices.resize(capacity);
+        mask = capacity - 1;
+
+        reset();
+    }
+
+    /** Adds a value and returns the minimum of the current window. */
+    SampleType push(SampleType value) noexcept
+    {
+        // drop candidates that can never be the minimum again
+        while (back != front && values[(back - 1) & mask] >= value)
+            --back;
+
+        values[back & mask] = value;
+        indices[back & mask] = position;
+        ++back;
+
+        // and the one that just left the window
+        if (indices[front & mask] + static_cast<std::uint64_t>(windowLength) <= position)
+            ++front;
+
+        ++position;
+        return values[front & mask];
+    }
+
+    void reset() noexcept
+    {
+        front = back = 0;
+        position = 0;
+    }
+
+    int getWindowLength() const noexcept { return windowLength; }
+
+private:
+    std::vector<SampleType> values;
+    std::vector<std::uint64_t> indices;
+    size_t mask = 0;
+    size_t front = 0, back = 0;
+    std::uint64_t position = 0;
+    int windowLength = 1;
+};
+
+} // namespace Utils
+} // namespace DSP
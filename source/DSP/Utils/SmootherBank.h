@@ -0,0 +1,186 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+namespace DSP {
+namespace Utils {
+
+/**
+ * N exponential parameter smoothers stored as a struct of arrays.
+ *
+ * Each lane follows exactly the same recurrence and settling rule as
+ * ParameterSmoother, with current, target and coefficient values in
+ * contiguous aligned arrays. fillRamps() renders every lane's per-sample
+ * values for a whole block into preallocated ramp buffers, stepping only
+ * the lanes that are still moving; usually one or two are, so they are
+ * stepped one lane at a time rather than all lanes together.
+ *
+ * Lanes are addressed by index; pass a scoped enum whose enumerators run
+ * from 0 to N - 1 to address them by name.
+ */
+template<typename SampleType, size_t N>
+class SmootherBank
+{
+public:
+    static constexpr size_t numLanes = N;
+    static constexpr double settleEpsilon = 1.0e-6;
+
+    SmootherBank()
+    {
+        coefficient.fill(SampleType{1});
+        threshold.fill(static_cast<SampleType>(settleEpsilon));
+    }
+
+    /** Sets the sample rate and allocates ramp storage for maxBlockSize samples per lane. */
+    void prepare(double newSampleRate, int maxBlockSize)
+    {
+        jassert(newSampleRate > 0.0 && maxBlockSize > 0);
+
+        _sampleRate = newSampleRate;
+        rampLength = static_cast<size_t>(maxBlockSize);
+        ramps.assign(N * rampLength, SampleType{0});
+
+        for (size_t lane = 0; lane < N; ++lane)
+            updateCoefficient(lane);
+    }
+
+    /** Sets the smoothing time of one lane in milliseconds. */
+    template<typename Lane>
+    void setSmoothingTime(Lane lane, double newSmoothingTimeMs)
+    {
+        jassert(newSmoothingTimeMs >= 0.0);
+
+        smoothingTimesMs[index(lane)] = newSmoothingTimeMs;
+        updateCoefficient(index(lane));
+    }
+
+    /** Sets the value a lane smooths towards. */
+    template<typename Lane>
+    void setTargetValue(Lane lane, SampleType newTargetValue)
+    {
+        const auto i = index(lane);
+
+        target[i] = newTargetValue;
+        threshold[i] = static_cast<SampleType>(settleEpsilon * std::max(1.0, std::abs(static_cast<double>(newTargetValue))));
+
+        if (std::abs(target[i] - current[i]) <= threshold[i])
+            current[i] = target[i];
+    }
+
+    /** Jumps every lane to its target value. */
+    void snapToTargetValues()
+    {
+        current = target;
+    }
+
+    /** True while any lane is still moving towards its target. */
+    bool isSmoothing() const
+    {
+        for (size_t lane = 0; lane < N; ++lane)
+            if (!juce::exactlyEqual(current[lane], target[lane]))
+                return true;
+
+        return false;
+    }
+
+    template<typename Lane>
+    bool isSmoothing(Lane lane) const { return !juce::exactlyEqual(current[index(lane)], target[index(lane)]); }
+
+    template<typename Lane>
+    SampleType getCurrentValue(Lane lane) const { return current[index(lane)]; }
+
+    template<typename Lane>
+    SampleType getTargetValue(Lane lane) const { return target[index(lane)]; }
+
+    /**
+     * Renders the next numSamples values of every lane into the ramp buffers
+     * and advances the bank past them. numSamples must not exceed the block
+     * size given to prepare().
+     *
+     * The moving lanes are found once per call; each one is then stepped
+     * into its own ramp until it settles, and everything after that, like
+     * the ramps of settled lanes, is a plain fill. All writes are contiguous.
+     */
+    void fillRamps(int numSamples)
+    {
+        jassert(static_cast<size_t>(numSamples) <= rampLength);
+
+        const auto length = static_cast<size_t>(numSamples);
+
+        std::array<size_t, N> movingLanes;
+        size_t numMovingLanes = 0;
+
+        for (size_t lane = 0; lane < N; ++lane)
+        {
+            if (!juce::exactlyEqual(current[lane], target[lane]))
+                movingLanes[numMovingLanes++] = lane;
+            else
+                std::fill_n(ramps.data() + lane * rampLength, length, current[lane]);
+        }
+
+        for (size_t m = 0; m < numMovingLanes; ++m)
+        {
+            const auto lane = movingLanes[m];
+            auto* ramp = ramps.data() + lane * rampLength;
+            size_t i = 0;
+
+            // nextValue() lands exactly on the target once the lane has settled
+            for (; i < length && !juce::exactlyEqual(current[lane], target[lane]); ++i)
+            {
+                current[lane] = nextValue(lane);
+                ramp[i] = current[lane];
+            }
+
+            std::fill(ramp + i, ramp + length, current[lane]);
+        }
+    }
+
+    /** The values written by the last fillRamps() call for one lane. */
+    template<typename Lane>
+    const SampleType* getRamp(Lane lane) const { return ramps.data() + index(lane) * rampLength; }
+
+private:
+    template<typename Lane>
+    static constexpr size_t index(Lane lane)
+    {
+        static_assert(std::is_enum_v<Lane> || std::is_integral_v<Lane>, "Lanes are addressed by enum or index");
+
+        const auto i = static_cast<size_t>(lane);
+        jassert(i < N);
+        return i;
+    }
+
+    SampleType nextValue(size_t lane) const
+    {
+        const auto next = current[lane] + coefficient[lane] * (target[lane] - current[lane]);
+
+        // Same settling rule as ParameterSmoother: within epsilon, or stalled at the type's precision
+        const bool settled = std::abs(target[lane] - next) <= threshold[lane] || juce::exactlyEqual(next, current[lane]);
+        return settled ? target[lane] : next;
+    }
+
+    void updateCoefficient(size_t lane)
+    {
+        const auto samplesForSmoothingTime = smoothingTimesMs[lane] * 0.001 * _sampleRate;
+        coefficient[lane] = samplesForSmoothingTime > 0.0 ? static_cast<SampleType>(1.0 - std::exp(-1.0 / samplesForSmoothingTime))
+                                                          : SampleType{1};
+    }
+
+    alignas(64) std::array<SampleType, N> current {};
+    alignas(64) std::array<SampleType, N> target {};
+    alignas(64) std::array<SampleType, N> coefficient {};
+    alignas(64) std::array<SampleType, N> threshold {};
+    std::array<double, N> smoothingTimesMs {};
+
+    std::vector<SampleType> ramps;
+    size_t rampLength = 0;
+    double _sampleRate = 44100.0;
+};
+
+} // namespace Utils
+} // namespace DSP
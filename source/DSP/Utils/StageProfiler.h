@@ -0,0 +1,134 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+
+/**
+ * Per-stage timing of the DSP, for finding out which settings make the
+ * processor expensive. Off by default; configure with
+ * -DCHASM_STAGE_PROFILING=ON to compile it in. When off, CHASM_PROFILE_STAGE
+ * expands to nothing and the processors hold no profiler at all.
+ */
+#ifndef CHASM_STAGE_PROFILING
+    #define CHASM_STAGE_PROFILING 0
+#endif
+
+namespace DSP
+{
+    namespace Utils
+    {
+        /**
+         * Accumulated time per stage. Stages are timed on the audio thread with
+         * relaxed atomic adds only; any thread can read or reset the totals while
+         * it runs.
+         */
+        template <size_t NumStages>
+        class StageProfiler
+        {
+        public:
+            struct StageStats
+            {
+                juce::int64 calls = 0;
+                juce::int64 samples = 0;
+                juce::int64 ticks = 0;
+                juce::int64 worstTicks = 0; ///< slowest single call
+
+                double getSeconds() const { return juce::Time::highResolutionTicksToSeconds (ticks); }
+                double getNanosecondsPerSample() const { return samples > 0 ? getSeconds() * 1.0e9 / static_cast<double> (samples) : 0.0; }
+            };
+
+            /** Times the enclosing scope as one call of a stage over numSamples. */
+            class Scope
+            {
+            public:
+                Scope (StageProfiler& profilerToUse, size_t stageToTime, int numSamplesToTime) noexcept
+                    : profiler (profilerToUse), stage (stageToTime), numSamples (numSamplesToTime), start (juce::Time::getHighResolutionTicks())
+                {
+                }
+
+                ~Scope() noexcept
+                {
+                    profiler.add (stage, juce::Time::getHighResolutionTicks() - start, numSamples);
+                }
+
+            private:
+                StageProfiler& profiler;
+                const size_t stage;
+                const int numSamples;
+                const juce::int64 start;
+
+                JUCE_DECLARE_NON_COPYABLE (Scope)
+            };
+
+            StageProfiler() = default;
+
+            void add (size_t stage, juce::int64 ticks, int numSamples) noexcept
+            {
+                jassert (stage < NumStages);
+                auto& totals = stages[stage];
+
+                totals.calls.fetch_add (1, std::memory_order_relaxed);
+                totals.samples.fetch_add (numSamples, std::memory_order_relaxed);
+                totals.ticks.fetch_add (ticks, std::memory_order_relaxed);
+
+                if (ticks > totals.worstTicks.load (std::memory_order_relaxed))
+                    totals.worstTicks.store (ticks, std::memory_order_relaxed);
+            }
+
+            StageStats getStats (size_t stage) const noexcept
+            {
+                jassert (stage < NumStages);
+                const auto& totals = stages[stage];
+
+                StageStats stats;
+                stats.calls = totals.calls.load (std::memory_order_relaxed);
+                stats.samples = totals.samples.load (std::memory_order_relaxed);
+                stats.ticks = totals.ticks.load (std::memory_order_relaxed);
+                stats.worstTicks = totals.worstTicks.load (std::memory_order_relaxed);
+                return stats;
+            }
+
+            /** Time of every stage together. */
+            juce::int64 getTotalTicks() const noexcept
+            {
+                juce::int64 total = 0;
+
+                for (const auto& totals : stages)
+                    total += totals.ticks.load (std::memory_order_relaxed);
+
+                return total;
+            }
+
+            void reset() noexcept
+            {
+                for (auto& totals : stages)
+                {
+                    totals.calls.store (0, std::memory_order_relaxed);
+                    totals.samples.store (0, std::memory_order_relaxed);
+                    totals.ticks.store (0, std::memory_order_relaxed);
+                    totals.worstTicks.store (0, std::memory_order_relaxed);
+                }
+            }
+
+        private:
+            struct Totals
+            {
+                std::atomic<juce::int64> calls { 0 }, samples { 0 }, ticks { 0 }, worstTicks { 0 };
+            };
+
+            std::array<Totals, NumStages> stages;
+
+            JUCE_DECLARE_NON_COPYABLE (StageProfiler)
+        };
+    } // namespace Utils
+} // namespace DSP
+
+#if CHASM_STAGE_PROFILING
+    /** Times the rest of the enclosing scope as one call of a stage. */
+    #define CHASM_PROFILE_STAGE(profiler, stage, numSamples) \
+        const typename std::remove_reference_t<decltype (profiler)>::Scope JUCE_JOIN_MACRO (stageScope, __LINE__) ((profiler), static_cast<size_t> (stage), (numSamples))
+#else
+    #define CHASM_PROFILE_STAGE(profiler, stage, numSamples)
+#endif
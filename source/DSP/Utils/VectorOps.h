@@ -0,0 +1,336 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include <array>
+#include <type_traits>
+#include <vector>
+
+#ifdef CHASM_IPP
+    #include <ipps.h>
+    #include <memory>
+#endif
+
+namespace DSP {
+namespace Utils {
+
+/**
+ * Vector operations of the processor's mix and gain stages.
+ *
+ * Every operation exists twice, in PortableVectorOps (JUCE's
+ * FloatVectorOperations and loops the compiler vectorises) and, when the
+ * build defines CHASM_IPP, in IppVectorOps on top of Intel IPP. VectorOps
+ * names the one in use. Both take the same arguments and agree to within
+ * rounding; the IPP versions reorder some arithmetic, so they are not
+ * bit-exact.
+ *
+ * Ramps are per-sample values as rendered by SmootherBank.
+ */
+struct PortableVectorOps
+{
+    /** dest[i] = source[i] * gains[i] */
+    template<typename SampleType>
+    static void multiply(SampleType* dest, const SampleType* source, const SampleType* gains, int numSamples) noexcept
+    {
+        juce::FloatVectorOperations::multiply(dest, source, gains, numSamples);
+    }
+
+    /** data[i] *= gains[i] */
+    template<typename SampleType>
+    static void multiply(SampleType* data, const SampleType* gains, int numSamples) noexcept
+    {
+        juce::FloatVectorOperations::multiply(data, gains, numSamples);
+    }
+
+    /** dry[i] = (dry[i] * (1 - mix[i]) + wet[i] * mix[i]) * gains[i] */
+    template<typename SampleType>
+    static void mix(SampleType* dry, const SampleType* wet, const SampleType* mix, const SampleType* gains, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dry[i] = (dry[i] * (SampleType{1.0} - mix[i]) + wet[i] * mix[i]) * gains[i];
+    }
+
+    /** Scales the side signal of a stereo pair by width, in place. */
+    template<typename SampleType>
+    static void midSideWidth(SampleType* left, SampleType* right, SampleType width, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto mid = (left[i] + right[i]) * SampleType{0.5};
+            const auto side = (left[i] - right[i]) * SampleType{0.5} * width;
+
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+    }
+};
+
+/**
+ * NumStages biquads in series per channel, transposed direct form II as
+ * juce::dsp::IIR::Filter. Coefficients are normalised (a0 = 1) and shared
+ * by all channels; nothing allocates after prepare().
+ */
+template<typename SampleType, size_t NumStages = 1>
+class PortableBiquadCascade
+{
+public:
+    void prepare(int numChannels)
+    {
+        state.assign(static_cast<size_t>(numChannels), {});
+    }
+
+    void setCoefficients(int stage, SampleType b0, SampleType b1, SampleType b2, SampleType a1, SampleType a2) noexcept
+    {
+        coefficients[(size_t) stage] = { b0, b1, b2, a1, a2 };
+    }
+
+    void process(int channel, SampleType* data, int numSamples) noexcept
+    {
+        jassert(juce::isPositiveAndBelow(channel, static_cast<int>(state.size())));
+
+        for (size_t stage = 0; stage < NumStages; ++stage)
+        {
+            const auto [b0, b1, b2, a1, a2] = coefficients[stage];
+            auto& channelState = state[(size_t) channel][stage];
+            auto s1 = channelState[0];
+            auto s2 = channelState[1];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto input = data[i];
+                const auto output = input * b0 + s1;
+                s1 = input * b1 - output * a1 + s2;
+                s2 = input * b2 - output * a2;
+                data[i] = output;
+            }
+
+            juce::dsp::util::snapToZero(s1);
+            juce::dsp::util::snapToZero(s2);
+
+            channelState = { s1, s2 };
+        }
+    }
+
+    void reset() noexcept
+    {
+        for (auto& channelState : state)
+            channelState = {};
+    }
+
+private:
+    struct Coefficients
+    {
+        // unity until set
+        SampleType b0 = SampleType{1.0}, b1 = SampleType{0.0}, b2 = SampleType{0.0};
+        SampleType a1 = SampleType{0.0}, a2 = SampleType{0.0};
+    };
+
+    std::array<Coefficients, NumStages> coefficients {};
+    std::vector<std::array<std::array<SampleType, 2>, NumStages>> state;
+};
+
+#ifdef CHASM_IPP
+
+/** PortableVectorOps on Intel IPP, for float and double. */
+struct IppVectorOps
+{
+    template<typename SampleType>
+    static void multiply(SampleType* dest, const SampleType* source, const SampleType* gains, int numSamples) noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            ippsMul_32f(source, gains, dest, numSamples);
+        else
+            ippsMul_64f(source, gains, dest, numSamples);
+    }
+
+    template<typename SampleType>
+    static void multiply(SampleType* data, const SampleType* gains, int numSamples) noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            ippsMul_32f_I(gains, data, numSamples);
+        else
+            ippsMul_64f_I(gains, data, numSamples);
+    }
+
+    /** Computed as (dry + (wet - dry) * mix) * gains, in chunks through a stack buffer. */
+    template<typename SampleType>
+    static void mix(SampleType* dry, const SampleType* wet, const SampleType* mix, const SampleType* gains, int numSamples) noexcept
+    {
+        std::array<SampleType, scratchSize> difference;
+
+        for (int start = 0; start < numSamples; start += scratchSize)
+        {
+            const int length = juce::jmin(scratchSize, numSamples - start);
+            auto* out = dry + start;
+
+            if constexpr (std::is_same_v<SampleType, float>)
+            {
+                ippsSub_32f(out, wet + start, difference.data(), length);
+                ippsMul_32f_I(mix + start, difference.data(), length);
+                ippsAdd_32f_I(difference.data(), out, length);
+                ippsMul_32f_I(gains + start, out, length);
+            }
+            else
+            {
+                ippsSub_64f(out, wet + start, difference.data(), length);
+                ippsMul_64f_I(mix + start, difference.data(), length);
+                ippsAdd_64f_I(difference.data(), out, length);
+                ippsMul_64f_I(gains + start, out, length);
+            }
+        }
+    }
+
+    /** Computed as left' = a * left + b * right, right' = b * left + a * right. */
+    template<typename SampleType>
+    static void midSideWidth(SampleType* left, SampleType* right, SampleType width, int numSamples) noexcept
+    {
+        const auto a = (SampleType{1.0} + width) * SampleType{0.5};
+        const auto b = (SampleType{1.0} - width) * SampleType{0.5};
+        std::array<SampleType, scratchSize> originalLeft;
+
+        for (int start = 0; start < numSamples; start += scratchSize)
+        {
+            const int length = juce::jmin(scratchSize, numSamples - start);
+            auto* l = left + start;
+            auto* r = right + start;
+
+            if constexpr (std::is_same_v<SampleType, float>)
+            {
+                ippsCopy_32f(l, originalLeft.data(), length);
+                ippsMulC_32f_I(a, l, length);
+                ippsAddProductC_32f(r, b, l, length);
+                ippsMulC_32f_I(a, r, length);
+                ippsAddProductC_32f(originalLeft.data(), b, r, length);
+            }
+            else
+            {
+                ippsCopy_64f(l, originalLeft.data(), length);
+                ippsMulC_64f_I(a, l, length);
+                ippsAddProductC_64f(r, b, l, length);
+                ippsMulC_64f_I(a, r, length);
+                ippsAddProductC_64f(originalLeft.data(), b, r, length);
+            }
+        }
+    }
+
+private:
+    static constexpr int scratchSize = 256;
+};
+
+/** PortableBiquadCascade on IPP's biquad IIR, one IPP state per channel. */
+template<typename SampleType, size_t NumStages = 1>
+class IppBiquadCascade
+{
+public:
+    void prepare(int numChannels)
+    {
+        int stateSize = 0;
+
+        if constexpr (isFloat)
+            ippsIIRGetStateSize_BiQuad_32f(static_cast<int>(NumStages), &stateSize);
+        else
+            ippsIIRGetStateSize_BiQuad_64f(static_cast<int>(NumStages), &stateSize);
+
+        channels.clear();
+        channels.resize(static_cast<size_t>(numChannels));
+
+        for (auto& channel : channels)
+        {
+            channel.memory.reset(ippsMalloc_8u(stateSize));
+
+            if constexpr (isFloat)
+                ippsIIRInit_BiQuad_32f(&channel.state, taps.data(), static_cast<int>(NumStages), nullptr, channel.memory.get());
+            else
+                ippsIIRInit_BiQuad_64f(&channel.state, taps.data(), static_cast<int>(NumStages), nullptr, channel.memory.get());
+        }
+    }
+
+    void setCoefficients(int stage, SampleType b0, SampleType b1, SampleType b2, SampleType a1, SampleType a2) noexcept
+    {
+        auto* stageTaps = taps.data() + static_cast<size_t>(stage) * 6;
+        stageTaps[0] = b0;
+        stageTaps[1] = b1;
+        stageTaps[2] = b2;
+        stageTaps[3] = SampleType{1.0};
+        stageTaps[4] = a1;
+        stageTaps[5] = a2;
+
+        for (auto& channel : channels)
+        {
+            if constexpr (isFloat)
+                ippsIIRSetTaps_32f(taps.data(), channel.state);
+            else
+                ippsIIRSetTaps_64f(taps.data(), channel.state);
+        }
+    }
+
+    void process(int channel, SampleType* data, int numSamples) noexcept
+    {
+        jassert(juce::isPositiveAndBelow(channel, static_cast<int>(channels.size())));
+
+        if constexpr (isFloat)
+            ippsIIR_32f_I(data, numSamples, channels[(size_t) channel].state);
+        else
+            ippsIIR_64f_I(data, numSamples, channels[(size_t) channel].state);
+    }
+
+    void reset() noexcept
+    {
+        const std::array<SampleType, 2 * NumStages> silence {};
+
+        for (auto& channel : channels)
+        {
+            if constexpr (isFloat)
+                ippsIIRSetDlyLine_32f(channel.state, silence.data());
+            else
+                ippsIIRSetDlyLine_64f(channel.state, silence.data());
+        }
+    }
+
+private:
+    static constexpr bool isFloat = std::is_same_v<SampleType, float>;
+    using State = std::conditional_t<isFloat, IppsIIRState_32f, IppsIIRState_64f>;
+
+    struct IppFree
+    {
+        void operator()(Ipp8u* memory) const noexcept { ippsFree(memory); }
+    };
+
+    struct Channel
+    {
+        std::unique_ptr<Ipp8u, IppFree> memory;
+        State* state = nullptr;
+    };
+
+    static constexpr std::array<SampleType, 6 * NumStages> makeUnityTaps()
+    {
+        std::array<SampleType, 6 * NumStages> unity {};
+
+        for (size_t stage = 0; stage < NumStages; ++stage)
+            unity[stage * 6] = unity[stage * 6 + 3] = SampleType{1.0};
+
+        return unity;
+    }
+
+    // b0, b1, b2, a0, a1, a2 per stage, as IPP expects them
+    std::array<SampleType, 6 * NumStages> taps = makeUnityTaps();
+    std::vector<Channel> channels;
+};
+
+using VectorOps = IppVectorOps;
+
+template<typename SampleType, size_t NumStages = 1>
+using BiquadCascade = IppBiquadCascade<SampleType, NumStages>;
+
+#else
+
+using VectorOps = PortableVectorOps;
+
+template<typename SampleType, size_t NumStages = 1>
+using BiquadCascade = PortableBiquadCascade<SampleType, NumStages>;
+
+#endif
+
+} // namespace Utils
+} // namespace DSP
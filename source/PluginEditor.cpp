@@ -6,7 +6,7 @@ int TEXT_BOX_HEIGHT = 20;
 
 //==============================================================================
 PluginEditor::PluginEditor (PluginProcessor& p)
-    : AudioProcessorEditor (&p), processorRef (p), presetPanel(p.getPresetManager()), apvts(p.getApvts())
+    : AudioProcessorEditor (&p), processorRef (p), presetPanel(p.getPresetManager()), loadMeter(p.getLoadProfiler()), apvts(p.getApvts())
 {
     // Create the activation UI via the Moonbase client.
     // The activation UI is created using the licensing member from the processor.
@@ -53,16 +53,26 @@ PluginEditor::PluginEditor (PluginProcessor& p)
     setResizable(false, true);
     constrainer.setMinimumSize(800, 420);
     addAndMakeVisible(presetPanel);
+    addAndMakeVisible(loadMeter);
+    processorRef.getPresetManager().addPresetListListener (this);
 
     setSize (400, 300);
 }
 
 PluginEditor::~PluginEditor()
 {
+    processorRef.getPresetManager().removePresetListListener (this);
+}
+
+void PluginEditor::changeListenerCallback (juce::ChangeBroadcaster*)
+{
+    presetPanel.repaint();
 }
 
 void PluginEditor::paint (juce::Graphics& g)
 {
+    CHASM_TRACE_SCOPE ("PluginEditor::paint");
+
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
 
     auto area = getLocalBounds();
@@ -77,6 +87,7 @@ void PluginEditor::resized()
 {
     auto area = getLocalBounds();
     inspectButton.setBounds (area.removeFromBottom (50).withSizeKeepingCentre (100, 50));
+    loadMeter.setBounds (area.removeFromTop (36).removeFromRight (260).reduced (4));
 
     // IMPORTANT: Ensure the activation UI is resized as well.
     MOONBASE_RESIZE_ACTIVATION_UI
@@ -3,6 +3,7 @@
 #include "BinaryData.h"
 #include "PluginProcessor.h"
 #include "UI/Components/AnimatedBackground.h"
+#include "UI/Components/LoadMeter.h"
 #include "UI/Components/PresetPanel.h"
 #include "UI/Components/RasterKnob.h"
 #include "UI/Components/SmallerRasterKnob.h"
@@ -15,7 +16,7 @@
 // Include the Moonbase Activation UI header (adjust path if needed)
 #include "moonbase_JUCEClient/moonbase_JUCEClient.h"
 
-class PluginEditor : public juce::AudioProcessorEditor, public juce::Slider::Listener
+class PluginEditor : public juce::AudioProcessorEditor, public juce::Slider::Listener, private juce::ChangeListener
 {
 public:
     explicit PluginEditor (PluginProcessor&);
@@ -32,6 +33,9 @@ private:
 
     void sliderValueChanged(juce::Slider* slider) override;
 
+    // Redraws the preset panel whenever the preset list changed
+    void changeListenerCallback (juce::ChangeBroadcaster* source) override;
+
 
     // A button to show a sample inspector (if needed)
     juce::TextButton inspectButton { "Inspect the UI" };
@@ -49,6 +53,9 @@ private:
     // Actual Plugin UI
     UI::Components::PresetPanel presetPanel;
 
+    // Audio thread load of this instance
+    UI::Components::LoadMeter loadMeter;
+
     // DSP Parameter Controls
     UI::Components::RasterKnob delaySlider;
 
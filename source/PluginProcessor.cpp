@@ -20,10 +20,21 @@ PluginProcessor::PluginProcessor()
 
     apvts.state.setProperty(Service::PresetManager::presetNameProperty, "", nullptr);
     presetManager = std::make_unique<Service::PresetManager>(apvts);
+
+    inputGainParameter = apvts.getRawParameterValue("INPUT_GAIN");
+    outputGainParameter = apvts.getRawParameterValue("OUTPUT_GAIN");
+    mixParameter = apvts.getRawParameterValue("MIX");
+    highCutParameter = apvts.getRawParameterValue("HIGH_CUT");
+    modeParameter = apvts.getRawParameterValue("MODE");
+    oversamplingParameter = apvts.getRawParameterValue("OVERSAMPLING");
+    oversamplingFilterParameter = apvts.getRawParameterValue("OVERSAMPLING_FILTER");
+
+    startTimerHz(10);
 }
 
 PluginProcessor::~PluginProcessor()
 {
+    stopTimer();
 }
 
 //==============================================================================
@@ -61,7 +72,8 @@ bool PluginProcessor::isMidiEffect() const
 
 double PluginProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return isUsingDoublePrecision() ? doubleProcessor.getTailLengthSeconds()
+                                    : floatProcessor.getTailLengthSeconds();
 }
 
 int PluginProcessor::getNumPrograms()
@@ -93,13 +105,36 @@ void PluginProcessor::changeProgramName (int index, const juce::String& newName)
 //==============================================================================
 void PluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    CHASM_TRACE_SCOPE ("prepareToPlay");
+
     // Prepare the DSP processor
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = static_cast<uint32>(samplesPerBlock);
     spec.numChannels = static_cast<uint32>(getTotalNumOutputChannels());
-    // Get initial parameter values for all smoothers
-    //dspProcessor.prepare(spec, parameters);
+    // Push the current values first so prepare() starts the smoothers on them
+    auto prepareProcessor = [&] (auto& processor)
+    {
+        pushParametersToProcessor(processor);
+        processor.prepare(spec);
+        dspLatencySamples = processor.getLatencySamples();
+    };
+
+    // The precision is fixed before prepareToPlay, so only that processor is prepared
+    if (isUsingDoublePrecision())
+    {
+        prepareProcessor(doubleProcessor);
+        moonbaseBuffer.setSize(getTotalNumOutputChannels(), samplesPerBlock);
+    }
+    else
+    {
+        prepareProcessor(floatProcessor);
+        moonbaseBuffer.setSize(0, 0);
+    }
+
+    setLatencySamples(dspLatencySamples);
+
+    loadProfiler.prepare(sampleRate);
 
     MOONBASE_PREPARE_TO_PLAY (sampleRate, samplesPerBlock);
 }
@@ -107,7 +142,44 @@ void PluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 void PluginProcessor::releaseResources()
 {
     // Reset the DSP processor and snap smoothers to current values for all parameters
-    //dspProcessor.reset(<parameters Here>);
+    auto resetProcessor = [this] (auto& processor)
+    {
+        pushParametersToProcessor(processor);
+        processor.reset();
+    };
+
+    if (isUsingDoublePrecision())
+        resetProcessor(doubleProcessor);
+    else
+        resetProcessor(floatProcessor);
+}
+
+template <typename SampleType>
+void PluginProcessor::pushParametersToProcessor(DSP::Core::ChasmDSPProcessor<SampleType>& processor)
+{
+    using Processor = DSP::Core::ChasmDSPProcessor<SampleType>;
+    using Parameter = typename Processor::Parameter;
+
+    processor.setParameter(Parameter::inputGain, static_cast<SampleType>(inputGainParameter->load()));
+    processor.setParameter(Parameter::outputGain, static_cast<SampleType>(outputGainParameter->load()));
+    processor.setParameter(Parameter::mix, static_cast<SampleType>(mixParameter->load()));
+    processor.setParameter(Parameter::highCut, static_cast<SampleType>(highCutParameter->load()));
+    processor.setCompressorMode(juce::roundToInt(modeParameter->load()));
+
+    const auto oversamplingFilter = juce::roundToInt(oversamplingFilterParameter->load()) == 0
+                                        ? Processor::OversamplingFilter::PolyphaseIIR
+                                        : Processor::OversamplingFilter::LinearPhaseFIR;
+    processor.setOversampling(juce::roundToInt(oversamplingParameter->load()), oversamplingFilter);
+}
+
+void PluginProcessor::timerCallback()
+{
+    const auto latency = dspLatencySamples.load();
+
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+
+    loadProfiler.update();
 }
 
 bool PluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -131,6 +203,58 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer,
                                     juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused (midiMessages);
+    CHASM_TRACE_SCOPE_ON_THREAD ("processBlock", "Audio thread");
+    const Service::LoadProfiler::ScopedBlock loadTiming (loadProfiler, buffer.getNumSamples());
+    jassert (! isUsingDoublePrecision());
+
+    processWith (floatProcessor, buffer);
+
+    MOONBASE_PROCESS (buffer);
+}
+
+void PluginProcessor::processBlock (juce::AudioBuffer<double>& buffer,
+                                    juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    CHASM_TRACE_SCOPE_ON_THREAD ("processBlock", "Audio thread");
+    const Service::LoadProfiler::ScopedBlock loadTiming (loadProfiler, buffer.getNumSamples());
+    jassert (isUsingDoublePrecision());
+
+    // Processed natively in double, no conversion to float and back
+    processWith (doubleProcessor, buffer);
+
+    // Moonbase is only known to take float buffers, so it gets a float copy; only the
+    // samples it changed are copied back, the rest keep their double precision
+    const auto numChannels = buffer.getNumChannels();
+    const auto numSamples = buffer.getNumSamples();
+    moonbaseBuffer.setSize (numChannels, numSamples, false, false, true);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = buffer.getReadPointer (channel);
+        auto* copy = moonbaseBuffer.getWritePointer (channel);
+
+        for (int i = 0; i < numSamples; ++i)
+            copy[i] = static_cast<float> (source[i]);
+    }
+
+    MOONBASE_PROCESS (moonbaseBuffer);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* destination = buffer.getWritePointer (channel);
+        const auto* processed = moonbaseBuffer.getReadPointer (channel);
+
+        for (int i = 0; i < numSamples; ++i)
+            if (! juce::exactlyEqual (processed[i], static_cast<float> (destination[i])))
+                destination[i] = processed[i];
+    }
+}
+
+template <typename SampleType>
+void PluginProcessor::processWith (DSP::Core::ChasmDSPProcessor<SampleType>& processor,
+                                   juce::AudioBuffer<SampleType>& buffer)
+{
     juce::ScopedNoDenormals noDenormals;
     
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -140,13 +264,13 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
     
-        // Update DSP processor parameters
-    //dspProcessor.updateParameters(<parameters here>);
+    // Update DSP processor parameters
+    pushParametersToProcessor (processor);
 
-    // Process the audio using function from
-    dspProcessor.processBlock(buffer);
+    dspLatencySamples = processor.getLatencySamples();
 
-    MOONBASE_PROCESS (buffer);
+    // Process the audio using function from
+    processor.processBlock (buffer);
 }
 
 //==============================================================================
@@ -174,6 +298,8 @@ void PluginProcessor::getStateInformation (juce::MemoryBlock& destData)
 
 void PluginProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    CHASM_TRACE_SCOPE ("setStateInformation");
+
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
 
     if (xmlState.get() != nullptr)
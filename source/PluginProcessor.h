@@ -3,14 +3,17 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "moonbase_JUCEClient/moonbase_JUCEClient.h"
 #include "BinaryData.h"
+#include "Service/LoadProfiler.h"
 #include "Service/PresetManager.h"
+#include "Service/TraceRecorder.h"
 #include "DSP/ChasmDSP.h"
 
 #if (MSVC)
 #include "ipps.h"
 #endif
 
-class PluginProcessor : public juce::AudioProcessor
+class PluginProcessor : public juce::AudioProcessor,
+                        private juce::Timer
 {
 public:
     PluginProcessor();
@@ -24,6 +27,9 @@ public:
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -48,6 +54,9 @@ public:
 
     Service::PresetManager& getPresetManager() { return *presetManager; }
 
+    // Audio thread load, for the editor's meter and anyone else who asks
+    Service::LoadProfiler& getLoadProfiler() { return loadProfiler; }
+
     juce::AudioProcessorValueTreeState apvts;
 
 
@@ -90,6 +99,18 @@ public:
         params.push_back(std::make_unique<juce::AudioParameterChoice>(
             juce::ParameterID{"MODE", 1}, "Mode",
             juce::StringArray{"Off", "Clean", "Further", "Crunchy"}, 0));
+
+        // Oversampling around the MakeItLoud waveshaper. Changes latency, so not automatable.
+        // Off by default, so new instances and sessions saved without it have no latency.
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID{"OVERSAMPLING", 1}, "Oversampling",
+            juce::StringArray{"1x", "2x", "4x", "8x"}, 0,
+            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID{"OVERSAMPLING_FILTER", 1}, "Oversampling Filter",
+            juce::StringArray{"Low Latency", "Linear Phase"}, 0,
+            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
         
         return { params.begin(), params.end() };
     }
@@ -98,8 +119,39 @@ private:
 
     std::unique_ptr<Service::PresetManager> presetManager;
 
-    // DSP Processor
-    DSP::FloatProcessor dspProcessor;
+    // DSP Processors; only the one matching the host's processing precision
+    // is prepared and run, the other stays unprepared and holds no buffers
+    DSP::FloatProcessor floatProcessor;
+    DSP::DoubleProcessor doubleProcessor;
+
+    // Float copy of double precision blocks for MOONBASE_PROCESS, sized in prepareToPlay
+    juce::AudioBuffer<float> moonbaseBuffer;
+
+    // Cached once so the audio thread never looks parameters up by ID
+    std::atomic<float>* inputGainParameter = nullptr;
+    std::atomic<float>* outputGainParameter = nullptr;
+    std::atomic<float>* mixParameter = nullptr;
+    std::atomic<float>* highCutParameter = nullptr;
+    std::atomic<float>* modeParameter = nullptr;
+    std::atomic<float>* oversamplingParameter = nullptr;
+    std::atomic<float>* oversamplingFilterParameter = nullptr;
+
+    // Latency as last seen by the audio thread, reported to the host by timerCallback()
+    std::atomic<int> dspLatencySamples { 0 };
+
+    // Times every processBlock, drained by timerCallback()
+    Service::LoadProfiler loadProfiler;
+
+    template <typename SampleType>
+    void pushParametersToProcessor (DSP::Core::ChasmDSPProcessor<SampleType>& processor);
+
+    template <typename SampleType>
+    void processWith (DSP::Core::ChasmDSPProcessor<SampleType>& processor, juce::AudioBuffer<SampleType>& buffer);
+
+    // Reports a latency change from the audio thread to the host on the message
+    // thread and updates the load statistics. Polled rather than an AsyncUpdater,
+    // whose trigger posts a message (a lock and a syscall) from the audio thread.
+    void timerCallback() override;
 
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginProcessor)
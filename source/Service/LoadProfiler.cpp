@@ -0,0 +1,85 @@
+#include "LoadProfiler.h"
+
+namespace Service
+{
+    void LoadProfiler::prepare (double sampleRate)
+    {
+        jassert (sampleRate > 0.0);
+
+        // update() reads the ring under the same lock
+        const juce::ScopedLock sl (statsLock);
+
+        deadlineTicksPerSample = static_cast<double> (juce::Time::getHighResolutionTicksPerSecond()) / sampleRate;
+        fifo.reset();
+        droppedAtReset = dropped.load();
+        totalBusyTicks = totalDeadlineTicks = 0;
+        stats = {};
+        stats.sampleRate = sampleRate;
+    }
+
+    void LoadProfiler::update()
+    {
+        const auto ticksPerSecond = static_cast<double> (juce::Time::getHighResolutionTicksPerSecond());
+        juce::int64 busyTicks = 0, deadlineTicks = 0;
+
+        const juce::ScopedLock sl (statsLock);
+
+        const auto scope = fifo.read (fifo.getNumReady());
+
+        auto drain = [&] (int start, int size) {
+            for (int i = start; i < start + size; ++i)
+            {
+                const auto& record = ring[(size_t) i];
+                const auto load = static_cast<double> (record.elapsedTicks) / static_cast<double> (record.deadlineTicks);
+
+                busyTicks += record.elapsedTicks;
+                deadlineTicks += record.deadlineTicks;
+
+                ++stats.numBlocks;
+                stats.histogram[(size_t) juce::jlimit (0, numHistogramBins - 1, static_cast<int> (load * 10.0))]++;
+                stats.peakLoad = juce::jmax (stats.peakLoad, load);
+
+                if (record.elapsedTicks > record.deadlineTicks)
+                    ++stats.deadlineMisses;
+
+                if (record.elapsedTicks > stats.worstBlockSeconds * ticksPerSecond)
+                {
+                    stats.worstBlockSeconds = static_cast<double> (record.elapsedTicks) / ticksPerSecond;
+                    stats.worstBlockDeadline = static_cast<double> (record.deadlineTicks) / ticksPerSecond;
+                }
+            }
+        };
+
+        drain (scope.startIndex1, scope.blockSize1);
+        drain (scope.startIndex2, scope.blockSize2);
+
+        totalBusyTicks += busyTicks;
+        totalDeadlineTicks += deadlineTicks;
+
+        // a stopped transport keeps the last reading instead of dropping to 0
+        if (deadlineTicks > 0)
+            stats.currentLoad = static_cast<double> (busyTicks) / static_cast<double> (deadlineTicks);
+
+        if (totalDeadlineTicks > 0)
+            stats.averageLoad = static_cast<double> (totalBusyTicks) / static_cast<double> (totalDeadlineTicks);
+
+        stats.droppedBlocks = dropped.load() - droppedAtReset;
+    }
+
+    LoadProfiler::Stats LoadProfiler::getStats() const
+    {
+        const juce::ScopedLock sl (statsLock);
+        return stats;
+    }
+
+    void LoadProfiler::resetStats()
+    {
+        const juce::ScopedLock sl (statsLock);
+        const auto sampleRate = stats.sampleRate;
+
+        droppedAtReset = dropped.load();
+        totalBusyTicks = totalDeadlineTicks = 0;
+        stats = {};
+        stats.sampleRate = sampleRate;
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+
+namespace Service
+{
+    /**
+     * Times every processBlock against its deadline, the block's length in real time.
+     *
+     * The audio thread only reads the clock and pushes elapsed and deadline ticks
+     * into a lock-free ring. update() drains the ring on another thread (the
+     * processor's timer) into the statistics, which getStats() returns as a copy.
+     */
+    class LoadProfiler
+    {
+    public:
+        /** 10% wide bins of block time relative to the deadline, the last one is everything from 100% (a miss). */
+        static constexpr int numHistogramBins = 11;
+
+        struct Stats
+        {
+            double sampleRate = 0.0;
+            double currentLoad = 0.0;        ///< busy / real time over the last update, 1.0 is the whole deadline
+            double averageLoad = 0.0;        ///< the same since the last reset
+            double peakLoad = 0.0;           ///< the highest single block
+            double worstBlockSeconds = 0.0;  ///< longest block since the last reset
+            double worstBlockDeadline = 0.0; ///< that block's deadline in seconds
+            juce::int64 numBlocks = 0;
+            juce::int64 deadlineMisses = 0;  ///< blocks that took longer than their deadline
+            juce::int64 droppedBlocks = 0;   ///< blocks timed while the ring was full, not in the statistics
+            std::array<juce::int64, numHistogramBins> histogram {};
+        };
+
+        LoadProfiler() = default;
+
+        /** Called before processing starts, i.e. from prepareToPlay(). Resets the statistics. */
+        void prepare (double sampleRate);
+
+        //==============================================================================
+        /** Times the enclosing scope as one block of numSamples. Audio thread only. */
+        class ScopedBlock
+        {
+        public:
+            ScopedBlock (LoadProfiler& profilerToUse, int numSamplesInBlock) noexcept
+                : profiler (profilerToUse), numSamples (numSamplesInBlock), start (juce::Time::getHighResolutionTicks())
+            {
+            }
+
+            ~ScopedBlock() noexcept
+            {
+                profiler.record (juce::Time::getHighResolutionTicks() - start, numSamples);
+            }
+
+        private:
+            LoadProfiler& profiler;
+            const int numSamples;
+            const juce::int64 start;
+
+            JUCE_DECLARE_NON_COPYABLE (ScopedBlock)
+        };
+
+        /** Pushes one block's time. Audio thread only, never blocks or allocates. */
+        void record (juce::int64 elapsedTicks, int numSamples) noexcept
+        {
+            if (numSamples <= 0 || deadlineTicksPerSample <= 0.0)
+                return;
+
+            const auto scope = fifo.write (1);
+
+            if (scope.blockSize1 > 0)
+                ring[(size_t) scope.startIndex1] = { elapsedTicks, static_cast<juce::int64> (numSamples * deadlineTicksPerSample + 0.5) };
+            else
+                dropped.store (dropped.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        //==============================================================================
+        /** Drains the ring into the statistics. Call regularly from one non-audio thread. */
+        void update();
+
+        /** Thread safe, but not for the audio thread. */
+        Stats getStats() const;
+
+        /** Clears the statistics; blocks still in the ring count towards the new ones. */
+        void resetStats();
+
+    private:
+        struct Record
+        {
+            juce::int64 elapsedTicks;
+            juce::int64 deadlineTicks;
+        };
+
+        // room for over a second of 16 sample blocks at 192 kHz between updates
+        static constexpr int ringSize = 16384;
+
+        juce::AbstractFifo fifo { ringSize };
+        std::array<Record, ringSize> ring {};
+        std::atomic<juce::int64> dropped { 0 };
+        double deadlineTicksPerSample = 0.0;
+
+        juce::CriticalSection statsLock;
+        Stats stats;
+        juce::int64 totalBusyTicks = 0, totalDeadlineTicks = 0, droppedAtReset = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoadProfiler)
+    };
+}
@@ -0,0 +1,357 @@
+#include "PresetIndex.h"
+#include <algorithm>
+#include <set>
+
+namespace Service
+{
+    namespace
+    {
+        // bump the version whenever the layout below changes, old files are then ignored
+        constexpr int indexMagic = 0x58495043; // "CPIX"
+        constexpr int indexVersion = 2;
+
+        bool isSameMetadata (const PresetMetadata& a, const PresetMetadata& b)
+        {
+            return a.name == b.name && a.artist == b.artist && a.category == b.category
+                   && a.dateCreated == b.dateCreated && a.dateModified == b.dateModified
+                   && a.fileSize == b.fileSize && a.modificationTime == b.modificationTime;
+        }
+    }
+
+    PresetIndex::PresetIndex (const juce::File& rootDirectoryToIndex, const juce::String& defaultCategoryName, const juce::String& presetExtension)
+        : rootDirectory (rootDirectoryToIndex), defaultCategory (defaultCategoryName), extension (presetExtension)
+    {
+    }
+
+    bool PresetIndex::load (const juce::File& indexFile)
+    {
+        directories.clear();
+
+        juce::FileInputStream stream (indexFile);
+
+        if (! stream.openedOk()
+            || stream.readInt() != indexMagic
+            || stream.readInt() != indexVersion
+            || stream.readString() != rootDirectory.getFullPathName())
+            return false;
+
+        const auto numDirectories = stream.readCompressedInt();
+
+        for (int d = 0; d < numDirectories && ! stream.isExhausted(); ++d)
+        {
+            const auto category = stream.readString();
+            auto& directory = directories[category];
+            directory.modificationTime = stream.readInt64();
+            directory.scanTime = stream.readInt64();
+
+            const auto numPresets = stream.readCompressedInt();
+
+            for (int p = 0; p < numPresets && ! stream.isExhausted(); ++p)
+            {
+                const auto fileName = stream.readString();
+                auto& metadata = directory.presets[fileName];
+                metadata.name = stream.readString();
+                metadata.artist = stream.readString();
+                metadata.category = category;
+                metadata.dateCreated = stream.readString();
+                metadata.dateModified = stream.readString();
+                metadata.fileSize = stream.readInt64();
+                metadata.modificationTime = stream.readInt64();
+            }
+
+            const auto numUnreadable = stream.readCompressedInt();
+
+            for (int u = 0; u < numUnreadable && ! stream.isExhausted(); ++u)
+            {
+                auto& metadata = directory.unreadable[stream.readString()];
+                metadata.fileSize = stream.readInt64();
+                metadata.modificationTime = stream.readInt64();
+            }
+        }
+
+        // a truncated file is as good as none
+        if (stream.readInt() != indexMagic)
+        {
+            directories.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool PresetIndex::save (const juce::File& indexFile) const
+    {
+        if (! indexFile.getParentDirectory().createDirectory().wasOk())
+            return false;
+
+        juce::TemporaryFile temporary (indexFile);
+
+        {
+            juce::FileOutputStream stream (temporary.getFile());
+
+            if (! stream.openedOk())
+                return false;
+
+            stream.writeInt (indexMagic);
+            stream.writeInt (indexVersion);
+            stream.writeString (rootDirectory.getFullPathName());
+            stream.writeCompressedInt ((int) directories.size());
+
+            for (const auto& [category, directory] : directories)
+            {
+                stream.writeString (category);
+                stream.writeInt64 (directory.modificationTime);
+                stream.writeInt64 (directory.scanTime);
+                stream.writeCompressedInt ((int) directory.presets.size());
+
+                for (const auto& [fileName, metadata] : directory.presets)
+                {
+                    stream.writeString (fileName);
+                    stream.writeString (metadata.name);
+                    stream.writeString (metadata.artist);
+                    stream.writeString (metadata.dateCreated);
+                    stream.writeString (metadata.dateModified);
+                    stream.writeInt64 (metadata.fileSize);
+                    stream.writeInt64 (metadata.modificationTime);
+                }
+
+                stream.writeCompressedInt ((int) directory.unreadable.size());
+
+                for (const auto& [fileName, metadata] : directory.unreadable)
+                {
+                    stream.writeString (fileName);
+                    stream.writeInt64 (metadata.fileSize);
+                    stream.writeInt64 (metadata.modificationTime);
+                }
+            }
+
+            stream.writeInt (indexMagic);
+            stream.flush();
+
+            if (stream.getStatus().failed())
+                return false;
+        }
+
+        // readers never see a half written index
+        return temporary.overwriteTargetFileWithTemporary();
+    }
+
+    bool PresetIndex::refresh (const std::function<bool()>& shouldStop)
+    {
+        return refreshDirectories (shouldStop, false);
+    }
+
+    bool PresetIndex::refreshChangedDirectories (const std::function<bool()>& shouldStop)
+    {
+        return refreshDirectories (shouldStop, true);
+    }
+
+    bool PresetIndex::refreshDirectories (const std::function<bool()>& shouldStop, bool onlyChanged)
+    {
+        if (! rootDirectory.isDirectory())
+        {
+            const auto changed = ! directories.empty();
+            directories.clear();
+            return changed;
+        }
+
+        // the root first, listing it adds and removes the categories
+        auto changed = refreshDirectory (defaultCategory, directories[defaultCategory], onlyChanged);
+
+        for (auto& [category, directory] : directories)
+        {
+            if (shouldStop && shouldStop())
+                break;
+
+            if (category != defaultCategory)
+                changed = refreshDirectory (category, directory, onlyChanged) || changed;
+        }
+
+        return changed;
+    }
+
+    void PresetIndex::invalidate (const juce::String& category)
+    {
+        const auto found = directories.find (category.isEmpty() ? defaultCategory : category);
+
+        if (found != directories.end())
+            found->second.modificationTime = 0;
+    }
+
+    juce::StringArray PresetIndex::getCategories() const
+    {
+        juce::StringArray categories;
+        categories.add (defaultCategory);
+
+        for (const auto& entry : directories)
+            if (entry.first != defaultCategory)
+                categories.add (entry.first);
+
+        return categories;
+    }
+
+    juce::StringArray PresetIndex::getPresetNames (const juce::String& category) const
+    {
+        juce::StringArray names;
+
+        for (const auto& metadata : getMetadata (category))
+            names.add (metadata.name);
+
+        return names;
+    }
+
+    juce::Array<PresetMetadata> PresetIndex::getMetadata (const juce::String& category) const
+    {
+        juce::Array<PresetMetadata> result;
+        const auto found = directories.find (category.isEmpty() ? defaultCategory : category);
+
+        if (found == directories.end())
+            return result;
+
+        for (const auto& entry : found->second.presets)
+            result.add (entry.second);
+
+        std::sort (result.begin(), result.end(), [] (const PresetMetadata& a, const PresetMetadata& b) {
+            return a.name.compareNatural (b.name) < 0;
+        });
+
+        return result;
+    }
+
+    juce::File PresetIndex::getDirectory (const juce::String& category) const
+    {
+        return category == defaultCategory ? rootDirectory : rootDirectory.getChildFile (category);
+    }
+
+    bool PresetIndex::refreshDirectory (const juce::String& category, Directory& directory, bool onlyChanged)
+    {
+        const auto folder = getDirectory (category);
+        const auto modificationTime = folder.getLastModificationTime().toMilliseconds();
+
+        if (onlyChanged && modificationTime == directory.modificationTime && ! isRacy (directory.modificationTime, directory.scanTime))
+            return false;
+
+        // taken before listing, so changes made meanwhile count as racy
+        const auto scanTime = juce::Time::currentTimeMillis();
+        const auto isRoot = category == defaultCategory;
+
+        auto changed = false;
+        std::map<juce::String, PresetMetadata> presets, unreadable;
+        std::set<juce::String> subdirectories;
+
+        for (const auto& entry : juce::RangedDirectoryIterator (folder, false, "*", juce::File::findFilesAndDirectories))
+        {
+            const auto file = entry.getFile();
+
+            if (entry.isDirectory())
+            {
+                if (isRoot && file.getFileName() != defaultCategory)
+                    subdirectories.insert (file.getFileName());
+
+                continue;
+            }
+
+            if (! file.hasFileExtension (extension))
+                continue;
+
+            const auto fileName = file.getFileName();
+            const auto size = entry.getFileSize();
+            const auto fileTime = entry.getModificationTime().toMilliseconds();
+
+            const auto findUnchanged = [&] (std::map<juce::String, PresetMetadata>& known) -> PresetMetadata* {
+                const auto found = known.find (fileName);
+
+                if (found != known.end()
+                    && found->second.fileSize == size
+                    && found->second.modificationTime == fileTime
+                    && ! isRacy (fileTime, directory.scanTime))
+                    return &found->second;
+
+                return nullptr;
+            };
+
+            if (auto* preset = findUnchanged (directory.presets))
+            {
+                presets.emplace (fileName, std::move (*preset));
+                continue;
+            }
+
+            if (auto* failed = findUnchanged (directory.unreadable))
+            {
+                unreadable.emplace (fileName, std::move (*failed));
+                continue;
+            }
+
+            PresetMetadata metadata;
+            metadata.fileSize = size;
+            metadata.modificationTime = fileTime;
+
+            // a file parsed again only counts if what the index holds for it differs
+            if (parse (file, category, metadata))
+            {
+                const auto known = directory.presets.find (fileName);
+                changed = changed || known == directory.presets.end() || ! isSameMetadata (known->second, metadata);
+                presets.emplace (fileName, std::move (metadata));
+            }
+            else
+            {
+                const auto known = directory.unreadable.find (fileName);
+                changed = changed || known == directory.unreadable.end() || ! isSameMetadata (known->second, metadata);
+                unreadable.emplace (fileName, std::move (metadata));
+            }
+        }
+
+        // files that are gone; any added in their place already counted
+        changed = changed || presets.size() != directory.presets.size() || unreadable.size() != directory.unreadable.size();
+
+        directory.presets = std::move (presets);
+        directory.unreadable = std::move (unreadable);
+        directory.modificationTime = modificationTime;
+        directory.scanTime = scanTime;
+
+        if (isRoot)
+        {
+            for (auto it = directories.begin(); it != directories.end();)
+            {
+                if (it->first != defaultCategory && subdirectories.count (it->first) == 0)
+                {
+                    it = directories.erase (it);
+                    changed = true;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            for (const auto& name : subdirectories)
+                changed = directories.try_emplace (name).second || changed;
+        }
+
+        return changed;
+    }
+
+    bool PresetIndex::parse (const juce::File& file, const juce::String& category, PresetMetadata& metadata)
+    {
+        ++numFilesParsed;
+
+        // the metadata are attributes of the outer element, its parameter children can be skipped
+        juce::XmlDocument document (file);
+        const auto xml = document.getDocumentElement (true);
+
+        if (xml == nullptr)
+            return false;
+
+        metadata.name = file.getFileNameWithoutExtension();
+        metadata.artist = xml->getStringAttribute ("artist", "Unknown");
+        metadata.category = category;
+        metadata.dateCreated = xml->getStringAttribute ("dateCreated");
+        metadata.dateModified = xml->getStringAttribute ("dateModified");
+        return true;
+    }
+
+    bool PresetIndex::isRacy (juce::int64 modificationTime, juce::int64 scanTime) noexcept
+    {
+        return modificationTime >= scanTime - racyMilliseconds;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <functional>
+#include <map>
+
+namespace Service
+{
+    struct PresetMetadata
+    {
+        juce::String name;
+        juce::String artist;
+        juce::String category;
+        juce::String dateCreated;
+        juce::String dateModified;
+        juce::int64 fileSize = 0;
+        juce::int64 modificationTime = 0; ///< of the file, milliseconds since the epoch
+        juce::String getFullPath() const { return category.isEmpty() ? name : category + "/" + name; }
+    };
+
+    /**
+     * Metadata of every preset under a root directory (the default category)
+     * and its subdirectories (one per category), kept in memory and in a
+     * compact binary file so it survives restarts.
+     *
+     * refresh() lists every directory but only parses files with a new size or
+     * modification time, including files that failed to parse, which are kept
+     * out of the presets but remembered. refreshChangedDirectories() also skips directories
+     * whose modification time is unchanged; rewriting a file in place doesn't
+     * change that, so it is only exact when whoever watches the files calls
+     * invalidate() for such changes. Times that are too recent to tell apart
+     * from a following change (file systems keep whole seconds) are not trusted
+     * and checked again on the next refresh.
+     *
+     * Not thread safe; use it from one thread at a time.
+     */
+    class PresetIndex
+    {
+    public:
+        PresetIndex (const juce::File& rootDirectory, const juce::String& defaultCategory, const juce::String& extension);
+
+        /** Reads a saved index; false, and an empty index, if it is missing, stale or from another root. */
+        bool load (const juce::File& indexFile);
+        bool save (const juce::File& indexFile) const;
+
+        /**
+         * Brings the index up to date with the disk; true if anything changed.
+         * Every file is checked, which costs one directory entry each.
+         * shouldStop is asked between directories and ends the refresh early,
+         * leaving the rest as they were.
+         */
+        bool refresh (const std::function<bool()>& shouldStop = {});
+
+        /**
+         * Like refresh(), but only lists directories whose modification time
+         * changed or that were invalidated, which costs one stat per directory
+         * when nothing did. Misses files rewritten in place unless their
+         * directory was invalidated.
+         */
+        bool refreshChangedDirectories (const std::function<bool()>& shouldStop = {});
+
+        /** Marks a directory as changed, so the next refreshChangedDirectories() lists it. */
+        void invalidate (const juce::String& category);
+
+        /** Categories found on disk, the default one first and the rest in no particular order. */
+        juce::StringArray getCategories() const;
+
+        /** Preset names of a category, sorted. */
+        juce::StringArray getPresetNames (const juce::String& category) const;
+        juce::Array<PresetMetadata> getMetadata (const juce::String& category) const;
+
+        /** Files parsed by refreshes so far, for checking that unchanged presets are not. */
+        int getNumFilesParsed() const noexcept { return numFilesParsed; }
+
+    private:
+        struct Directory
+        {
+            juce::int64 modificationTime = 0;
+            juce::int64 scanTime = 0;  ///< when it was last listed
+            std::map<juce::String, PresetMetadata> presets; ///< by file name
+            std::map<juce::String, PresetMetadata> unreadable; ///< files that failed to parse, only size and time set
+        };
+
+        static constexpr juce::int64 racyMilliseconds = 2000;
+
+        const juce::File rootDirectory;
+        const juce::String defaultCategory, extension;
+
+        // keyed by category, the default category is the root directory
+        std::map<juce::String, Directory> directories;
+        int numFilesParsed = 0;
+
+        juce::File getDirectory (const juce::String& category) const;
+        bool refreshDirectories (const std::function<bool()>& shouldStop, bool onlyChanged);
+        bool refreshDirectory (const juce::String& category, Directory& directory, bool onlyChanged);
+        bool parse (const juce::File& file, const juce::String& category, PresetMetadata& metadata);
+        static bool isRacy (juce::int64 modificationTime, juce::int64 scanTime) noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (PresetIndex)
+    };
+}
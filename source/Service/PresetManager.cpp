@@ -1,8 +1,26 @@
 #include "PresetManager.h"
+#include "TraceRecorder.h"
 #include <algorithm>
 
 namespace Service
 {
+    namespace
+    {
+        // What the index reads back from a preset file, so the list can show it before the scan does
+        PresetMetadata describePreset (const File& presetFile, const ValueTree& state, const String& category)
+        {
+            PresetMetadata metadata;
+            metadata.name = presetFile.getFileNameWithoutExtension();
+            metadata.artist = state.getProperty ("artist", "Unknown").toString();
+            metadata.category = category;
+            metadata.dateCreated = state.getProperty ("dateCreated").toString();
+            metadata.dateModified = state.getProperty ("dateModified").toString();
+            metadata.fileSize = presetFile.getSize();
+            metadata.modificationTime = presetFile.getLastModificationTime().toMilliseconds();
+            return metadata;
+        }
+    }
+
     const File PresetManager::defaultDirectory {
         File::getSpecialLocation (File::SpecialLocationType::commonDocumentsDirectory)
             .getChildFile ("DirektDSP")
@@ -10,31 +28,34 @@ namespace Service
             .getChildFile ("Presets")
     };
 
+    const File PresetManager::indexFile {
+        File::getSpecialLocation (File::SpecialLocationType::userApplicationDataDirectory)
+            .getChildFile ("DirektDSP")
+            .getChildFile (JucePlugin_Name)
+            .getChildFile ("PresetIndex.bin")
+    };
+
     const String PresetManager::extension { "ddsp" };
     const String PresetManager::presetNameProperty { "presetName" };
     const String PresetManager::defaultCategory { "Default" };
 
+    PresetManager::SharedScanner::SharedScanner()
+        : PresetScanner (defaultDirectory, defaultCategory, extension, indexFile)
+    {
+    }
+
     PresetManager::PresetManager (AudioProcessorValueTreeState& apvts)
         : valueTreeState (apvts)
     {
-        if (!defaultDirectory.exists())
-        {
-            const auto result = defaultDirectory.createDirectory();
-            if (result.failed())
-            {
-                DBG ("Could not create preset directory: " + result.getErrorMessage());
-                jassertfalse;
-            }
-        }
-
+        // The scanner creates the preset directory and lists the presets on its own thread
         valueTreeState.state.addListener (this);
         currentPreset.referTo (valueTreeState.state.getPropertyAsValue (presetNameProperty, nullptr));
         currentCategory.referTo (valueTreeState.state.getPropertyAsValue ("currentCategory", nullptr));
         
         // Add parameter listeners to clear preset name when parameters are modified
         addParameterListeners();
-        
-        updatePresetList();
+
+        startTimerHz (10);
     }
 
     void PresetManager::buildPresetMenu (PopupMenu& menu, int& menuItemId)
@@ -43,11 +64,12 @@ namespace Service
         menuItemToPresetMap.clear();
         menuItemToCategoryMap.clear();
 
-        const auto categories = getAllCategories();
+        // One snapshot for the whole menu, so it is consistent even if the list changes meanwhile
+        const auto snapshot = scanner->getSnapshot();
 
-        for (const auto& category : categories)
+        for (const auto& category : snapshot->categories)
         {
-            const auto presetsInCategory = getPresetsInCategory (category);
+            const auto presetsInCategory = snapshot->getPresetNames (category);
 
             if (presetsInCategory.isEmpty())
                 continue;
@@ -73,7 +95,7 @@ namespace Service
             {
                 // Create submenu for this category
                 PopupMenu categorySubmenu;
-                buildCategorySubmenu (categorySubmenu, category, menuItemId);
+                buildCategorySubmenu (categorySubmenu, category, presetsInCategory, menuItemId);
 
                 // Add submenu to main menu with folder icon or indicator
                 menu.addSubMenu (category + " ▶", categorySubmenu);
@@ -81,10 +103,8 @@ namespace Service
         }
     }
 
-    void PresetManager::buildCategorySubmenu (PopupMenu& submenu, const String& category, int& menuItemId)
+    void PresetManager::buildCategorySubmenu (PopupMenu& submenu, const String& category, const StringArray& presetsInCategory, int& menuItemId)
     {
-        const auto presetsInCategory = getPresetsInCategory (category);
-
         // Add header showing category name
         submenu.addSectionHeader (category);
 
@@ -126,7 +146,6 @@ namespace Service
                                             .withParentComponent(nullptr); // Use the main component as parent
 
             NativeMessageBox::showAsync (options, [this, category] (int result) {
-                DBG("Button Pressed");
                 if (result == 1)
                     deleteCategory (category);
             });
@@ -140,6 +159,8 @@ namespace Service
 
     void PresetManager::savePreset (const String& presetName, const String& artistName, const String& category)
     {
+        CHASM_TRACE_SCOPE ("PresetManager::savePreset");
+
         if (presetName.isEmpty())
             return;
 
@@ -167,20 +188,23 @@ namespace Service
         {
             DBG ("Could not create preset file: " + presetFile.getFullPathName());
             jassertfalse;
+            updatePresetList();
+            return;
         }
 
-        updatePresetList();
+        scanner->presetWritten (describePreset (presetFile, state, finalCategory));
     }
 
     void PresetManager::deletePreset (const String& presetName, const String& category)
     {
+        CHASM_TRACE_SCOPE ("PresetManager::deletePreset");
+
         if (presetName.isEmpty())
             return;
 
         const String finalCategory = category.isEmpty() ? getCurrentCategory() : category;
         const auto presetFile = getPresetFile (presetName, finalCategory);
 
-        DBG("[PRESET-MANAGER] Deleting preset: " << presetName << " from category: " << finalCategory);
         if (!presetFile.existsAsFile())
         {
             DBG ("Preset file " << presetFile.getFullPathName() << " does not exist");
@@ -196,17 +220,16 @@ namespace Service
         }
 
         currentPreset.setValue ("");
-        updatePresetList();
-        DBG("[PRESET-MANAGER] Preset deleted: " << presetName << " from category: " << finalCategory);
+        scanner->presetRemoved (finalCategory, presetName);
     }
 
     void PresetManager::loadPreset (const String& presetName, const String& category)
     {
+        CHASM_TRACE_SCOPE ("PresetManager::loadPreset");
+
         if (presetName.isEmpty())
             return;
 
-        DBG("[PRESET-MANAGER] Loading preset: " << presetName << " from category: " << category);
-
         const String finalCategory = category.isEmpty() ? getCurrentCategory() : category;
         const auto presetFile = getPresetFile (presetName, finalCategory);
 
@@ -234,9 +257,8 @@ namespace Service
         valueTreeState.replaceState (valueTreeToLoad);
         currentPreset.setValue (presetName);
         currentCategory.setValue (finalCategory);
+        parameterChangedSinceLoad = false;
         isLoadingPreset = false;
-
-        updatePresetList();
     }
 
     void PresetManager::createCategory (const String& categoryName)
@@ -254,7 +276,11 @@ namespace Service
                 jassertfalse;
             }
         }
-        updatePresetList();
+
+        if (categoryDir.isDirectory())
+            scanner->categoryCreated (categoryName);
+        else
+            updatePresetList();
     }
 
     void PresetManager::deleteCategory (const String& categoryName)
@@ -278,7 +304,11 @@ namespace Service
                 jassertfalse; // Assert to catch this during development
             }
         }
-        updatePresetList();
+
+        if (!categoryDir.exists())
+            scanner->categoryRemoved (categoryName);
+        else
+            updatePresetList();
     }
 
     bool PresetManager::categoryExists (const String& categoryName) const
@@ -291,179 +321,41 @@ namespace Service
 
     StringArray PresetManager::getAllCategories() const
     {
-        StringArray categories;
-        categories.add (defaultCategory);
-
-        const auto subdirs = defaultDirectory.findChildFiles (File::findDirectories, false);
-        StringArray otherCategories;
-        for (const auto& dir : subdirs)
-        {
-            otherCategories.add (dir.getFileName());
-        }
-
-        // Sort categories with custom comparator
-        otherCategories.sort (false); // First do a basic sort
-        
-        // Custom sort: numbers 0-9, 10-19, ..., 90-99, then A-Z
-        std::sort (otherCategories.begin(), otherCategories.end(), 
-            [] (const String& a, const String& b) -> bool
-            {
-                // Helper lambda to get sort priority
-                auto getSortPriority = [] (const String& str) -> int
-                {
-                    if (str.isEmpty()) return 1000;
-                    
-                    const auto firstChar = str[0];
-                    
-                    // Check if it starts with a digit
-                    if (firstChar >= '0' && firstChar <= '9')
-                    {
-                        // Extract the leading number
-                        int number = 0;
-                        int pos = 0;
-                        while (pos < str.length() && str[pos] >= '0' && str[pos] <= '9')
-                        {
-                            number = number * 10 + (str[pos] - '0');
-                            pos++;
-                        }
-                        
-                        // Return priority based on tens digit: 0-9 = 0, 10-19 = 1, etc.
-                        return number / 10;
-                    }
-                    else
-                    {
-                        // Letters come after all numbers (priority 100+)
-                        return 100;
-                    }
-                };
-                
-                int priorityA = getSortPriority(a);
-                int priorityB = getSortPriority(b);
-                
-                if (priorityA != priorityB)
-                {
-                    return priorityA < priorityB;
-                }
-                
-                // Same priority group - use natural string comparison
-                return a.compareNatural(b) < 0;
-            });
-
-        for (const auto& category : otherCategories)
-        {
-            categories.add (category);
-        }
-
-        return categories;
+        return scanner->getSnapshot()->categories;
     }
 
     StringArray PresetManager::getAllPresets() const
     {
         StringArray presets;
+        const auto snapshot = scanner->getSnapshot();
 
-        // Get presets from root directory (default category)
-        const auto rootFiles = defaultDirectory.findChildFiles (File::findFiles, false, "*." + extension);
-        for (const auto& file : rootFiles)
-            presets.add (file.getFileNameWithoutExtension());
-
-        // Get presets from subdirectories
-        const auto categories = getAllCategories();
-        for (const auto& category : categories)
-        {
-            if (category == defaultCategory)
-                continue;
-
-            const auto categoryPresets = getPresetsInCategory (category);
-            for (const auto& preset : categoryPresets)
-                presets.add (category + "/" + preset);
-        }
+        // Presets in the root directory (default category) go without a category prefix
+        for (const auto& category : snapshot->categories)
+            for (const auto& preset : snapshot->getPresetNames (category))
+                presets.add (category == defaultCategory ? preset : category + "/" + preset);
 
         return presets;
     }
 
     StringArray PresetManager::getPresetsInCategory (const String& category) const
     {
-        StringArray presets;
-
-        File searchDir = (category.isEmpty() || category == defaultCategory) ? defaultDirectory : getCategoryDirectory (category);
-
-        if (!searchDir.exists())
-            return presets;
-
-        const auto fileArray = searchDir.findChildFiles (File::findFiles, false, "*." + extension);
-        for (const auto& file : fileArray)
-            presets.add (file.getFileNameWithoutExtension());
-
-        return presets;
+        return scanner->getSnapshot()->getPresetNames (category.isEmpty() ? defaultCategory : category);
     }
 
     Array<PresetMetadata> PresetManager::getAllPresetMetadata() const
     {
         Array<PresetMetadata> result;
+        const auto snapshot = scanner->getSnapshot();
 
-        // Get metadata from root directory (default category)
-        const auto rootFiles = defaultDirectory.findChildFiles (File::findFiles, false, "*." + extension);
-        for (const auto& file : rootFiles)
-        {
-            XmlDocument xmlDocument (file);
-            std::unique_ptr<XmlElement> xml (xmlDocument.getDocumentElement());
-
-            if (xml != nullptr)
-            {
-                auto tree = ValueTree::fromXml (*xml);
-                PresetMetadata meta;
-                meta.name = file.getFileNameWithoutExtension();
-                meta.artist = tree.getProperty ("artist", "Unknown").toString();
-                meta.category = defaultCategory;
-                meta.dateCreated = tree.getProperty ("dateCreated", "").toString();
-                meta.dateModified = tree.getProperty ("dateModified", "").toString();
-                result.add (meta);
-            }
-        }
-
-        // Get metadata from subdirectories
-        const auto categories = getAllCategories();
-        for (const auto& category : categories)
-        {
-            if (category == defaultCategory)
-                continue;
-
-            const auto categoryMetadata = getPresetMetadataInCategory (category);
-            result.addArray (categoryMetadata);
-        }
+        for (const auto& category : snapshot->categories)
+            result.addArray (snapshot->getMetadata (category));
 
         return result;
     }
 
     Array<PresetMetadata> PresetManager::getPresetMetadataInCategory (const String& category) const
     {
-        Array<PresetMetadata> result;
-
-        File searchDir = (category.isEmpty() || category == defaultCategory) ? defaultDirectory : getCategoryDirectory (category);
-
-        if (!searchDir.exists())
-            return result;
-
-        const auto fileArray = searchDir.findChildFiles (File::findFiles, false, "*." + extension);
-        for (const auto& file : fileArray)
-        {
-            XmlDocument xmlDocument (file);
-            std::unique_ptr<XmlElement> xml (xmlDocument.getDocumentElement());
-
-            if (xml != nullptr)
-            {
-                auto tree = ValueTree::fromXml (*xml);
-                PresetMetadata meta;
-                meta.name = file.getFileNameWithoutExtension();
-                meta.artist = tree.getProperty ("artist", "Unknown").toString();
-                meta.category = category;
-                meta.dateCreated = tree.getProperty ("dateCreated", "").toString();
-                meta.dateModified = tree.getProperty ("dateModified", "").toString();
-                result.add (meta);
-            }
-        }
-
-        return result;
+        return scanner->getSnapshot()->getMetadata (category.isEmpty() ? defaultCategory : category);
     }
 
     int PresetManager::loadNextPreset()
@@ -544,7 +436,8 @@ namespace Service
             if (updatedXml->writeTo (toFile))
             {
                 fromFile.moveToTrash();
-                updatePresetList();
+                scanner->presetRemoved (fromCategory.isEmpty() ? defaultCategory : fromCategory, presetName);
+                scanner->presetWritten (describePreset (toFile, tree, toCategory.isEmpty() ? defaultCategory : toCategory));
             }
         }
     }
@@ -565,8 +458,18 @@ namespace Service
 
     void PresetManager::updatePresetList()
     {
-        availablePresets = getAllPresets();
-        availableCategories = getAllCategories();
+        // For changes we can't describe; picked up on the scanner's thread, listeners hear once the new list is out
+        scanner->rescan();
+    }
+
+    void PresetManager::addPresetListListener (ChangeListener* listener)
+    {
+        scanner->addChangeListener (listener);
+    }
+
+    void PresetManager::removePresetListListener (ChangeListener* listener)
+    {
+        scanner->removeChangeListener (listener);
     }
 
     File PresetManager::getPresetFile (const String& presetName, const String& category) const
@@ -601,14 +504,23 @@ namespace Service
     }
 
     void PresetManager::parameterValueChanged(int parameterIndex, float newValue)
+    {
+        juce::ignoreUnused(parameterIndex, newValue);
+
+        // Called from whichever thread changed the parameter, often the audio
+        // thread during automation, so only raise a flag here: touching the
+        // Value would allocate and post messages. timerCallback() clears the
+        // preset name on the message thread.
+        if (!isLoadingPreset)
+            parameterChangedSinceLoad = true;
+    }
+
+    void PresetManager::timerCallback()
     {
         // Clear the current preset name when any parameter is changed
-        // but only if there's currently a preset selected and we're not loading a preset
-        if (!isLoadingPreset && getCurrentPreset().isNotEmpty())
-        {
-            DBG("[PRESET-MANAGER] Parameter " << parameterIndex << " changed to " << newValue << ", clearing preset name");
+        // but only if there's currently a preset selected
+        if (parameterChangedSinceLoad.exchange(false) && getCurrentPreset().isNotEmpty())
             currentPreset.setValue("");
-        }
     }
 
     void PresetManager::parameterGestureChanged(int parameterIndex, bool gestureIsStarting)
@@ -618,6 +530,7 @@ namespace Service
 
     PresetManager::~PresetManager()
     {
+        stopTimer();
         removeParameterListeners();
         valueTreeState.state.removeListener(this);
     }
@@ -1,24 +1,17 @@
 #pragma once
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_audio_processors/juce_audio_processors.h>
+#include "PresetScanner.h"
+#include <atomic>
 using namespace juce;
 
 namespace Service
 {
-    struct PresetMetadata
-    {
-        String name;
-        String artist;
-        String category;
-        String dateCreated;
-        String dateModified;
-        String getFullPath() const { return category.isEmpty() ? name : category + "/" + name; }
-    };
-
-    class PresetManager : private ValueTree::Listener, private AudioProcessorParameter::Listener
+    class PresetManager : private ValueTree::Listener, private AudioProcessorParameter::Listener, private Timer
     {
     public:
         static const File defaultDirectory;
+        static const File indexFile;
         static const String extension;
         static const String presetNameProperty;
         static const String defaultCategory;
@@ -59,9 +52,14 @@ namespace Service
         // Utility methods
         void movePresetToCategory(const String& presetName, const String& fromCategory, const String& toCategory);
         File getCategoryDirectory(const String& category) const;
+
+        // The preset list is scanned in the background; listeners hear on the message thread when it changed,
+        // right away for changes made through any PresetManager
+        void addPresetListListener(ChangeListener* listener);
+        void removePresetListListener(ChangeListener* listener);
         
     private:
-        void buildCategorySubmenu(PopupMenu& submenu, const String& category, int& menuItemId);
+        void buildCategorySubmenu(PopupMenu& submenu, const String& category, const StringArray& presetsInCategory, int& menuItemId);
         StringArray menuItemToPresetMap;
         StringArray menuItemToCategoryMap;
 
@@ -72,6 +70,9 @@ namespace Service
         // AudioProcessorParameter::Listener overrides
         void parameterValueChanged(int parameterIndex, float newValue) override;
         void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
+
+        // Clears the preset name on the message thread after a parameter change
+        void timerCallback() override;
         
         // Helper methods for parameter listening
         void addParameterListeners();
@@ -83,10 +84,20 @@ namespace Service
         AudioProcessorValueTreeState& valueTreeState;
         Value currentPreset;
         Value currentCategory;
-        StringArray availablePresets;
-        StringArray availableCategories;
+
+        // Keeps the preset list current without blocking this thread on the disk;
+        // one per process, shared by every instance
+        struct SharedScanner : public PresetScanner
+        {
+            SharedScanner();
+        };
+
+        SharedResourcePointer<SharedScanner> scanner;
         
         // Flag to prevent clearing preset name during preset loading
-        bool isLoadingPreset = false;
+        std::atomic<bool> isLoadingPreset { false };
+
+        // Set by parameterValueChanged(), which may run on the audio thread
+        std::atomic<bool> parameterChangedSinceLoad { false };
     };
 }
\ No newline at end of file
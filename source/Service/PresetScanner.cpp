@@ -0,0 +1,423 @@
+#include "PresetScanner.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <cerrno>
+
+#if JUCE_LINUX
+    #include <poll.h>
+    #include <sys/eventfd.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+namespace Service
+{
+    namespace
+    {
+        // changes arriving closer together than this are handled together, e.g. a folder of presets being copied in
+        constexpr int settleMs = 100;
+        constexpr int maxSettleMs = 1000;
+    }
+
+    juce::StringArray PresetScanner::Snapshot::getPresetNames (const juce::String& category) const
+    {
+        juce::StringArray names;
+
+        for (const auto& metadata : getMetadata (category))
+            names.add (metadata.name);
+
+        return names;
+    }
+
+    juce::Array<PresetMetadata> PresetScanner::Snapshot::getMetadata (const juce::String& category) const
+    {
+        const auto found = presets.find (category.isEmpty() ? categories[0] : category);
+        return found != presets.end() ? found->second : juce::Array<PresetMetadata>();
+    }
+
+    PresetScanner::PresetScanner (const juce::File& rootDirectoryToScan, const juce::String& defaultCategoryName, const juce::String& extension,
+                                  const juce::File& indexFileToUse, int pollInterval, bool shouldUseNotifications)
+        : juce::Thread ("Preset scanner"),
+          rootDirectory (rootDirectoryToScan),
+          indexFile (indexFileToUse),
+          defaultCategory (defaultCategoryName),
+          pollIntervalMs (pollInterval),
+          useNotifications (shouldUseNotifications),
+          index (rootDirectoryToScan, defaultCategoryName, extension)
+    {
+        auto empty = std::make_shared<Snapshot>();
+        empty->categories.add (defaultCategory);
+        snapshot = std::move (empty);
+
+       #if JUCE_LINUX
+        wakeUpFd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+       #endif
+
+        startThread (juce::Thread::Priority::low);
+    }
+
+    PresetScanner::~PresetScanner()
+    {
+        signalThreadShouldExit();
+        wakeUp();
+        stopThread (-1);
+
+       #if JUCE_LINUX
+        if (wakeUpFd >= 0)
+            close (wakeUpFd);
+       #endif
+    }
+
+    PresetScanner::SnapshotPtr PresetScanner::getSnapshot() const
+    {
+        const juce::SpinLock::ScopedLockType sl (snapshotLock);
+        return snapshot;
+    }
+
+    void PresetScanner::rescan()
+    {
+        rescanRequested = true;
+        wakeUp();
+    }
+
+    void PresetScanner::presetWritten (const PresetMetadata& metadata)
+    {
+        applyChange ([&] (Snapshot& next) {
+            auto written = metadata;
+            written.category = metadata.category.isEmpty() ? defaultCategory : metadata.category;
+            insertCategory (next, written.category);
+
+            auto& presets = next.presets[written.category];
+            presets.removeIf ([&] (const PresetMetadata& preset) { return preset.name == written.name; });
+
+            // kept sorted by name, as the index hands them out
+            auto position = 0;
+
+            while (position < presets.size() && presets.getReference (position).name.compareNatural (written.name) < 0)
+                ++position;
+
+            presets.insert (position, written);
+        });
+    }
+
+    void PresetScanner::presetRemoved (const juce::String& category, const juce::String& name)
+    {
+        applyChange ([&] (Snapshot& next) {
+            const auto found = next.presets.find (category.isEmpty() ? defaultCategory : category);
+
+            if (found != next.presets.end())
+                found->second.removeIf ([&] (const PresetMetadata& preset) { return preset.name == name; });
+        });
+    }
+
+    void PresetScanner::categoryCreated (const juce::String& category)
+    {
+        applyChange ([&] (Snapshot& next) { insertCategory (next, category); });
+    }
+
+    void PresetScanner::categoryRemoved (const juce::String& category)
+    {
+        if (category.isEmpty() || category == defaultCategory)
+            return;
+
+        applyChange ([&] (Snapshot& next) {
+            next.categories.removeString (category);
+            next.presets.erase (category);
+        });
+    }
+
+    void PresetScanner::applyChange (const std::function<void (Snapshot&)>& change)
+    {
+        JUCE_ASSERT_MESSAGE_THREAD
+
+        auto next = std::make_shared<Snapshot> (*getSnapshot());
+        change (*next);
+
+        {
+            const juce::SpinLock::ScopedLockType sl (snapshotLock);
+            snapshot = std::move (next);
+        }
+
+        sendSynchronousChangeMessage();
+
+        // a snapshot the thread publishes meanwhile would undo this, the rescan's snapshot
+        // comes after both and reflects the disk
+        rescan();
+    }
+
+    void PresetScanner::insertCategory (Snapshot& next, const juce::String& category) const
+    {
+        if (category.isEmpty() || next.categories.contains (category))
+            return;
+
+        auto categories = next.categories;
+        categories.removeString (defaultCategory);
+        categories.add (category);
+        sortCategories (categories);
+
+        next.categories = juce::StringArray (defaultCategory);
+        next.categories.addArray (categories);
+        next.presets.try_emplace (category);
+    }
+
+    void PresetScanner::wakeUp()
+    {
+        notify();
+
+       #if JUCE_LINUX
+        if (wakeUpFd >= 0)
+        {
+            const uint64_t one = 1;
+            juce::ignoreUnused (write (wakeUpFd, &one, sizeof (one)));
+        }
+       #endif
+    }
+
+    void PresetScanner::run()
+    {
+        // if this fails the index stays empty until the directory appears
+        if (! rootDirectory.isDirectory())
+            rootDirectory.createDirectory();
+
+        // the saved index spares parsing everything that didn't change since the last session
+        index.load (indexFile);
+        update (true);
+
+        if (useNotifications && watchForChanges())
+            return;
+
+        pollForChanges();
+    }
+
+    void PresetScanner::update (bool forcePublish, bool onlyChangedDirectories)
+    {
+        CHASM_TRACE_SCOPE ("PresetScanner::update");
+
+        // a requested rescan always publishes, replacing snapshots changed by applyChange()
+        forcePublish = rescanRequested.exchange (false) || forcePublish;
+
+        const auto shouldStop = [this] { return threadShouldExit(); };
+        const auto changed = onlyChangedDirectories ? index.refreshChangedDirectories (shouldStop) : index.refresh (shouldStop);
+
+        // an index that could not be saved only costs the next session a full parse
+        if (changed)
+            index.save (indexFile);
+
+        if (changed || forcePublish)
+            publish();
+    }
+
+    void PresetScanner::publish()
+    {
+        auto next = std::make_shared<Snapshot>();
+        next->isComplete = true;
+
+        auto categories = index.getCategories();
+        categories.removeString (defaultCategory);
+        sortCategories (categories);
+
+        next->categories.add (defaultCategory);
+        next->categories.addArray (categories);
+
+        for (const auto& category : next->categories)
+            next->presets[category] = index.getMetadata (category);
+
+        {
+            const juce::SpinLock::ScopedLockType sl (snapshotLock);
+            snapshot = std::move (next);
+        }
+
+        sendChangeMessage();
+    }
+
+    bool PresetScanner::watchForChanges()
+    {
+       #if JUCE_LINUX
+        const auto inotifyFd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+
+        if (inotifyFd < 0 || wakeUpFd < 0)
+        {
+            if (inotifyFd >= 0)
+                close (inotifyFd);
+
+            return false;
+        }
+
+        constexpr auto mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF;
+        std::map<int, juce::String> watches; // watch descriptor -> category
+
+        // adding a watch again is harmless, the kernel hands back the same descriptor
+        const auto watchCategories = [&] {
+            for (const auto& category : index.getCategories())
+            {
+                const auto directory = category == defaultCategory ? rootDirectory : rootDirectory.getChildFile (category);
+                const auto watch = inotify_add_watch (inotifyFd, directory.getFullPathName().toRawUTF8(), mask);
+
+                // a directory that is already gone again is fine, running out of watches means polling
+                if (watch >= 0)
+                    watches[watch] = category;
+                else if (errno != ENOENT)
+                    return false;
+            }
+
+            return true;
+        };
+
+        // anything changed between the first scan and the watches being in place
+        auto watching = watchCategories();
+
+        if (watching)
+            update();
+
+        const auto drainWakeUps = [this] {
+            uint64_t count;
+            juce::ignoreUnused (read (wakeUpFd, &count, sizeof (count)));
+        };
+
+        alignas (inotify_event) char buffer[4096];
+
+        // drains the queued events, invalidating the directories they happened in; true if there were any
+        const auto readEvents = [&] {
+            auto any = false;
+
+            for (;;)
+            {
+                const auto length = read (inotifyFd, buffer, sizeof (buffer));
+
+                if (length <= 0)
+                    return any;
+
+                any = true;
+
+                for (auto* position = buffer; position < buffer + length;)
+                {
+                    const auto* event = reinterpret_cast<const inotify_event*> (position);
+                    position += sizeof (inotify_event) + event->len;
+
+                    if ((event->mask & IN_Q_OVERFLOW) != 0)
+                    {
+                        for (const auto& category : index.getCategories())
+                            index.invalidate (category);
+
+                        continue;
+                    }
+
+                    const auto watch = watches.find (event->wd);
+
+                    if (watch == watches.end())
+                        continue;
+
+                    index.invalidate (watch->second);
+
+                    if ((event->mask & IN_IGNORED) != 0)
+                        watches.erase (watch);
+                }
+            }
+        };
+
+        while (watching && ! threadShouldExit())
+        {
+            pollfd fds[] = { { inotifyFd, POLLIN, 0 }, { wakeUpFd, POLLIN, 0 } };
+
+            if (poll (fds, 2, -1) < 0 && errno != EINTR)
+            {
+                watching = false;
+                break;
+            }
+
+            drainWakeUps();
+
+            if (threadShouldExit())
+                break;
+
+            // events invalidated their directories, a requested rescan checks every file
+            const auto hadEvents = readEvents();
+
+            if (hadEvents)
+            {
+                // let a burst of changes finish before looking at them
+                for (auto waited = 0; waited < maxSettleMs && ! threadShouldExit(); waited += settleMs)
+                {
+                    if (poll (fds, 2, settleMs) <= 0)
+                        break;
+
+                    drainWakeUps();
+                    readEvents();
+                }
+            }
+            else if (! rescanRequested)
+            {
+                continue;
+            }
+
+            update (false, hadEvents && ! rescanRequested);
+
+            // a new category may have filled up before its watch was in place
+            const auto numWatches = watches.size();
+            watching = watchCategories();
+
+            if (watching && watches.size() > numWatches)
+                update();
+        }
+
+        close (inotifyFd);
+        return watching;
+       #else
+        return false;
+       #endif
+    }
+
+    void PresetScanner::pollForChanges()
+    {
+        while (! threadShouldExit())
+        {
+            // unchanged presets cost a directory entry each, the parsing is what is skipped
+            update();
+            wait (pollIntervalMs);
+        }
+    }
+
+    void PresetScanner::sortCategories (juce::StringArray& categories)
+    {
+        categories.sort (false);
+
+        // numbers in groups of ten (0-9, 10-19, ..., 90-99), then names, each naturally
+        std::sort (categories.begin(), categories.end(),
+            [] (const juce::String& a, const juce::String& b) -> bool
+            {
+                auto getSortPriority = [] (const juce::String& str) -> int
+                {
+                    if (str.isEmpty()) return 1000;
+
+                    const auto firstChar = str[0];
+
+                    if (firstChar >= '0' && firstChar <= '9')
+                    {
+                        int number = 0;
+                        int pos = 0;
+                        while (pos < str.length() && str[pos] >= '0' && str[pos] <= '9')
+                        {
+                            number = number * 10 + (str[pos] - '0');
+                            pos++;
+                        }
+
+                        return number / 10;
+                    }
+                    else
+                    {
+                        return 100;
+                    }
+                };
+
+                int priorityA = getSortPriority(a);
+                int priorityB = getSortPriority(b);
+
+                if (priorityA != priorityB)
+                {
+                    return priorityA < priorityB;
+                }
+
+                return a.compareNatural(b) < 0;
+            });
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include "PresetIndex.h"
+#include <juce_events/juce_events.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+
+namespace Service
+{
+    /**
+     * Keeps the preset list current on a background thread, so neither
+     * constructing a PresetManager nor listing presets touches the disk.
+     *
+     * The thread loads the saved PresetIndex, refreshes it and publishes the
+     * result as an immutable Snapshot; listeners get a change message on the
+     * message thread whenever a new one is out. Afterwards it waits for
+     * changes: inotify on Linux, so presets copied in by other tools show up
+     * without rescanning anything else, and polling every preset's size and
+     * time elsewhere or when inotify is unavailable.
+     */
+    class PresetScanner : public juce::ChangeBroadcaster, private juce::Thread
+    {
+    public:
+        /** The preset list at one point in time; never changes once published. */
+        struct Snapshot
+        {
+            juce::StringArray categories; ///< the default category first, then sorted
+            std::map<juce::String, juce::Array<PresetMetadata>> presets; ///< by category, sorted by name
+            bool isComplete = false; ///< false before the first scan finished
+
+            juce::StringArray getPresetNames (const juce::String& category) const;
+            juce::Array<PresetMetadata> getMetadata (const juce::String& category) const;
+        };
+
+        using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+        /**
+         * Starts scanning right away. The index file is where the index is kept
+         * between sessions; with useNotifications false the directories are
+         * only polled.
+         */
+        PresetScanner (const juce::File& rootDirectory, const juce::String& defaultCategory, const juce::String& extension,
+                       const juce::File& indexFile, int pollIntervalMs = 2000, bool useNotifications = true);
+        ~PresetScanner() override;
+
+        /** The latest snapshot, from any thread; empty until the first scan finished. */
+        SnapshotPtr getSnapshot() const;
+
+        /** Checks for changes as soon as possible, e.g. after saving or deleting a preset. */
+        void rescan();
+
+        /**
+         * Publish a change the caller just made on disk right away, so the list
+         * doesn't lag behind it until the next scan; listeners hear before these
+         * return. Message thread only. Each asks for a rescan as well, which
+         * publishes again and so has the last word.
+         */
+        void presetWritten (const PresetMetadata& metadata);
+        void presetRemoved (const juce::String& category, const juce::String& name);
+        void categoryCreated (const juce::String& category);
+        void categoryRemoved (const juce::String& category);
+
+        /** Sorts category names: numbers by tens first, then the rest naturally. */
+        static void sortCategories (juce::StringArray& categories);
+
+    private:
+        const juce::File rootDirectory, indexFile;
+        const juce::String defaultCategory;
+        const int pollIntervalMs;
+        const bool useNotifications;
+
+        PresetIndex index;
+        std::atomic<bool> rescanRequested { false };
+
+        SnapshotPtr snapshot;
+        mutable juce::SpinLock snapshotLock;
+
+       #if JUCE_LINUX
+        int wakeUpFd = -1; ///< an eventfd written to wake the thread from poll()
+       #endif
+
+        void run() override;
+        void wakeUp();
+
+        /** Publishes a copy of the latest snapshot with the change applied. */
+        void applyChange (const std::function<void (Snapshot&)>& change);
+        void insertCategory (Snapshot& next, const juce::String& category) const;
+
+        /**
+         * Refreshes the index and publishes a new snapshot if anything changed
+         * or a rescan was requested. onlyChangedDirectories is for when every
+         * change invalidates its directory, as inotify events do.
+         */
+        void update (bool forcePublish = false, bool onlyChangedDirectories = false);
+        void publish();
+
+        /** Waits for changes with inotify; false if that isn't possible. */
+        bool watchForChanges();
+        void pollForChanges();
+
+        JUCE_DECLARE_NON_COPYABLE (PresetScanner)
+    };
+}
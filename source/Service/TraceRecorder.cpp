@@ -0,0 +1,187 @@
+#include "TraceRecorder.h"
+#include <juce_events/juce_events.h>
+#include <cstring>
+#include <vector>
+
+namespace Service
+{
+    TraceRecorder& TraceRecorder::getInstance()
+    {
+        static TraceRecorder instance;
+        return instance;
+    }
+
+    void TraceRecorder::setEnabled (bool shouldBeEnabled)
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (shouldBeEnabled && ringPoolStorage == nullptr)
+        {
+            ringPoolStorage = std::make_unique<RingPool>();
+            startTicks = juce::Time::getHighResolutionTicks();
+            ringPool.store (ringPoolStorage.get(), std::memory_order_release);
+        }
+
+        enabled.store (shouldBeEnabled, std::memory_order_release);
+    }
+
+    void TraceRecorder::clear()
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (auto* pool = ringPool.load (std::memory_order_acquire))
+        {
+            for (auto& ring : *pool)
+            {
+                // free the ring unless its thread is inside a scope: either enter() sees
+                // the stand-in owner and backs off, or this sees the scope and keeps it
+                auto threadId = ring.owner.load();
+
+                if (threadId != nullptr && ring.owner.compare_exchange_strong (threadId, ring.releasing()))
+                {
+                    if (ring.depth.load() == 0)
+                    {
+                        ring.named.store (false, std::memory_order_relaxed);
+                        ring.owner.store (nullptr);
+                    }
+                    else
+                    {
+                        ring.owner.store (threadId);
+                    }
+                }
+
+                ring.cleared.store (ring.written.load (std::memory_order_acquire), std::memory_order_relaxed);
+            }
+        }
+
+        startTicks = juce::Time::getHighResolutionTicks();
+    }
+
+    TraceRecorder::Ring* TraceRecorder::enterRingForThisThread (const char* threadName) noexcept
+    {
+        auto* pool = ringPool.load (std::memory_order_acquire);
+
+        if (pool == nullptr)
+            return nullptr;
+
+        const auto threadId = juce::Thread::getCurrentThreadId();
+
+        for (auto& ring : *pool)
+            if (ring.owner.load (std::memory_order_relaxed) == threadId)
+                return ring.enter (threadId) ? &ring : nullptr;
+
+        for (auto& ring : *pool)
+        {
+            juce::Thread::ThreadID expected = nullptr;
+
+            if (! ring.owner.compare_exchange_strong (expected, threadId))
+                continue;
+
+            // freed again by a clear() in between
+            if (! ring.enter (threadId))
+                return nullptr;
+
+            // a named thread never allocates here, everyone else may
+            if (threadName != nullptr)
+                std::strncpy (ring.threadName, threadName, sizeof (ring.threadName) - 1);
+            else if (juce::MessageManager::existsAndIsCurrentThread())
+                std::strncpy (ring.threadName, "Message thread", sizeof (ring.threadName) - 1);
+            else if (auto* thread = juce::Thread::getCurrentThread())
+                thread->getThreadName().copyToUTF8 (ring.threadName, sizeof (ring.threadName));
+            else
+                ring.threadName[0] = 0;
+
+            ring.named.store (true, std::memory_order_release);
+            return &ring;
+        }
+
+        // more threads than rings: this one goes untraced until a clear() frees some
+        return nullptr;
+    }
+
+    juce::String TraceRecorder::toJson() const
+    {
+        const juce::ScopedLock sl (lock);
+        const auto* pool = ringPool.load (std::memory_order_acquire);
+
+        juce::String json;
+        json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        if (pool == nullptr)
+            return json + "]}";
+
+        const auto microsecondsPerTick = 1.0e6 / static_cast<double> (juce::Time::getHighResolutionTicksPerSecond());
+        bool first = true;
+
+        auto addEvent = [&] (const juce::String& event) {
+            json << (first ? "\n" : ",\n") << event;
+            first = false;
+        };
+
+        for (int tid = 0; tid < maxThreads; ++tid)
+        {
+            const auto& ring = (*pool)[(size_t) tid];
+
+            if (ring.owner.load (std::memory_order_acquire) == nullptr)
+                continue;
+
+            // a thread still claiming the ring has yet to name it
+            auto threadName = ring.named.load (std::memory_order_acquire) ? juce::String::fromUTF8 (ring.threadName) : juce::String();
+
+            if (threadName.isEmpty())
+                threadName = "Thread " + juce::String (tid);
+
+            addEvent ("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + juce::String (tid)
+                      + ",\"args\":{\"name\":" + juce::JSON::toString (threadName) + "}}");
+
+            // copy what's there, then drop whatever the thread overwrote meanwhile
+            const auto end = ring.written.load (std::memory_order_acquire);
+            const auto begin = juce::jmax (ring.cleared.load (std::memory_order_relaxed), end - (juce::int64) eventsPerThread);
+
+            struct Copy
+            {
+                const char* name;
+                juce::int64 ticks;
+                bool isBegin;
+            };
+
+            std::vector<Copy> copies;
+            copies.reserve ((size_t) (end - begin));
+
+            for (auto index = begin; index < end; ++index)
+            {
+                const auto& event = ring.events[(size_t) (index % eventsPerThread)];
+                copies.push_back ({ event.name.load (std::memory_order_relaxed), event.ticks.load (std::memory_order_relaxed),
+                                    event.isBegin.load (std::memory_order_relaxed) });
+            }
+
+            std::atomic_thread_fence (std::memory_order_acquire);
+            const auto firstValid = ring.written.load (std::memory_order_relaxed) - (juce::int64) eventsPerThread;
+
+            // an end whose begin was overwritten would close someone else's slice
+            int depth = 0;
+
+            for (size_t i = 0; i < copies.size(); ++i)
+            {
+                if (begin + (juce::int64) i < firstValid || copies[i].name == nullptr)
+                    continue;
+
+                if (! copies[i].isBegin && depth == 0)
+                    continue;
+
+                depth += copies[i].isBegin ? 1 : -1;
+
+                addEvent ("{\"name\":" + juce::JSON::toString (juce::String (copies[i].name)) + ",\"ph\":\"" + (copies[i].isBegin ? "B" : "E")
+                          + "\",\"ts\":" + juce::String (static_cast<double> (copies[i].ticks - startTicks) * microsecondsPerTick, 3)
+                          + ",\"pid\":1,\"tid\":" + juce::String (tid) + "}");
+            }
+        }
+
+        return json + "\n]}";
+    }
+
+    bool TraceRecorder::writeTo (const juce::File& file) const
+    {
+        return file.replaceWithText (toJson());
+    }
+}
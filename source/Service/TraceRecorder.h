@@ -0,0 +1,155 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+namespace Service
+{
+    /**
+     * Records begin/end events per thread and writes them as a Chrome trace
+     * (JSON), which chrome://tracing and ui.perfetto.dev open as a timeline.
+     *
+     * Off by default, when a CHASM_TRACE_SCOPE costs one atomic load. Turning it
+     * on allocates a pool of per-thread rings up front. A thread finds its ring by
+     * scanning the pool for its thread ID, claiming a free one on its first event,
+     * and from then on only writes to its own ring, so recording never locks,
+     * allocates or touches thread_local storage (whose first use in a plugin may
+     * allocate). Each ring keeps the last eventsPerThread events, older ones are
+     * overwritten. clear() hands the rings of threads outside a scope back to the
+     * pool; beyond maxThreads threads between clears, the rest go untraced.
+     */
+    class TraceRecorder
+    {
+    public:
+        static constexpr int maxThreads = 16;
+        static constexpr int eventsPerThread = 1 << 15;
+
+        /** The recorder shared by every plugin instance in the process. */
+        static TraceRecorder& getInstance();
+
+        void setEnabled (bool shouldBeEnabled);
+        bool isEnabled() const noexcept { return enabled.load (std::memory_order_relaxed); }
+
+        /** Drops everything recorded so far and frees the rings of threads outside a scope. */
+        void clear();
+
+        /** The recorded events as Chrome trace JSON; safe while recording continues. */
+        juce::String toJson() const;
+        bool writeTo (const juce::File& file) const;
+
+    private:
+        /** One thread's events, written by that thread only. */
+        struct Ring
+        {
+            struct Event
+            {
+                std::atomic<const char*> name { nullptr };
+                std::atomic<juce::int64> ticks { 0 };
+                std::atomic<bool> isBegin { false };
+            };
+
+            void push (const char* name, bool isBegin) noexcept
+            {
+                const auto index = written.load (std::memory_order_relaxed);
+                auto& event = events[(size_t) (index % eventsPerThread)];
+
+                event.name.store (name, std::memory_order_relaxed);
+                event.ticks.store (juce::Time::getHighResolutionTicks(), std::memory_order_relaxed);
+                event.isBegin.store (isBegin, std::memory_order_relaxed);
+                written.store (index + 1, std::memory_order_release);
+            }
+
+            /** Holds the ring for a scope; fails if the thread doesn't own it (any more). */
+            bool enter (juce::Thread::ThreadID threadId) noexcept
+            {
+                // paired with clear(), which only frees a ring it sees no scope in
+                depth.fetch_add (1);
+
+                if (owner.load() == threadId)
+                    return true;
+
+                depth.fetch_sub (1);
+                return false;
+            }
+
+            void leave() noexcept { depth.fetch_sub (1); }
+
+            /** Stands in for the owner while clear() decides whether to free the ring. */
+            juce::Thread::ThreadID releasing() noexcept { return this; }
+
+            std::array<Event, eventsPerThread> events;
+            std::atomic<juce::int64> written { 0 };
+            std::atomic<juce::int64> cleared { 0 }; ///< events before this index were dropped by clear()
+
+            std::atomic<juce::Thread::ThreadID> owner { nullptr };
+            std::atomic<int> depth { 0 }; ///< open scopes of the owner
+
+            // written by the claiming thread before named, reset by clear() before the ring is freed
+            char threadName[64] = {};
+            std::atomic<bool> named { false };
+        };
+
+    public:
+        /**
+         * Begin event on construction, end event on destruction. The name must
+         * outlive the recorder (a string literal). threadName labels the thread
+         * in the trace if this is its first event.
+         */
+        class ScopedTrace
+        {
+        public:
+            explicit ScopedTrace (const char* eventName, const char* threadName = nullptr) noexcept
+                : name (eventName)
+            {
+                auto& recorder = getInstance();
+
+                if (recorder.isEnabled())
+                    if ((ring = recorder.enterRingForThisThread (threadName)) != nullptr)
+                        ring->push (name, true);
+            }
+
+            ~ScopedTrace() noexcept
+            {
+                // ended even if tracing was turned off meanwhile, so every begin has an end
+                if (ring != nullptr)
+                {
+                    ring->push (name, false);
+                    ring->leave();
+                }
+            }
+
+        private:
+            const char* name;
+            Ring* ring = nullptr;
+
+            JUCE_DECLARE_NON_COPYABLE (ScopedTrace)
+        };
+
+    private:
+        TraceRecorder() = default;
+
+        /** This thread's ring, claimed if it has none, entered for a scope; nullptr if there is none free. */
+        Ring* enterRingForThisThread (const char* threadName) noexcept;
+
+        std::atomic<bool> enabled { false };
+
+        using RingPool = std::array<Ring, maxThreads>;
+
+        // allocated by the first setEnabled (true), then kept for the process' lifetime
+        std::unique_ptr<RingPool> ringPoolStorage;
+        std::atomic<RingPool*> ringPool { nullptr };
+        juce::int64 startTicks = 0;
+
+        // setEnabled(), clear() and toJson(), never the traced threads
+        juce::CriticalSection lock;
+
+        JUCE_DECLARE_NON_COPYABLE (TraceRecorder)
+    };
+}
+
+/** Traces the rest of the enclosing scope under the given name. */
+#define CHASM_TRACE_SCOPE(name) const Service::TraceRecorder::ScopedTrace JUCE_JOIN_MACRO (traceScope, __LINE__) (name)
+
+/** As CHASM_TRACE_SCOPE, and names the thread in the trace if this is its first event. */
+#define CHASM_TRACE_SCOPE_ON_THREAD(name, threadName) const Service::TraceRecorder::ScopedTrace JUCE_JOIN_MACRO (traceScope, __LINE__) (name, threadName)
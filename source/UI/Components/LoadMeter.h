@@ -0,0 +1,148 @@
+#pragma once
+
+#include "../../Service/LoadProfiler.h"
+#include "../../Service/TraceRecorder.h"
+#include <juce_gui_basics/juce_gui_basics.h>
+
+namespace UI::Components
+{
+    /**
+     * Shows the audio thread load of this instance: a bar for the current load,
+     * the peak, worst block and deadline misses since the last reset, and the
+     * block time histogram. Click to reset the statistics, right-click to
+     * record and save a trace of all threads (see TraceRecorder).
+     */
+    class LoadMeter : public juce::Component, public juce::SettableTooltipClient, private juce::Timer
+    {
+    public:
+        explicit LoadMeter (Service::LoadProfiler& profilerToShow)
+            : profiler (profilerToShow)
+        {
+            setTooltip ("Audio thread load, click to reset, right-click to trace");
+            startTimerHz (10);
+        }
+
+        void paint (juce::Graphics& g) override
+        {
+            auto area = getLocalBounds().toFloat().reduced (1.0f);
+
+            g.setColour (juce::Colours::black.withAlpha (0.6f));
+            g.fillRoundedRectangle (area, 3.0f);
+            area.reduce (4.0f, 3.0f);
+
+            // current load, full width is the whole deadline
+            auto bar = area.removeFromTop (6.0f);
+            g.setColour (juce::Colours::white.withAlpha (0.15f));
+            g.fillRect (bar);
+            g.setColour (getLoadColour (stats.currentLoad));
+            g.fillRect (bar.withWidth (bar.getWidth() * (float) juce::jlimit (0.0, 1.0, stats.currentLoad)));
+
+            // peak marker
+            g.setColour (getLoadColour (stats.peakLoad));
+            g.fillRect (bar.getX() + bar.getWidth() * (float) juce::jlimit (0.0, 1.0, stats.peakLoad) - 1.0f, bar.getY(), 2.0f, bar.getHeight());
+
+            area.removeFromTop (3.0f);
+            auto histogramArea = area.removeFromRight (area.getWidth() * 0.3f).reduced (2.0f, 1.0f);
+
+            g.setColour (juce::Colours::white);
+            g.setFont (11.0f);
+            g.drawFittedText (getSummary(), area.toNearestInt(), juce::Justification::centredLeft, 2);
+
+            // histogram, log scaled so single slow blocks stay visible
+            const auto highest = *std::max_element (stats.histogram.begin(), stats.histogram.end());
+            const auto binWidth = histogramArea.getWidth() / (float) Service::LoadProfiler::numHistogramBins;
+
+            for (int bin = 0; bin < Service::LoadProfiler::numHistogramBins; ++bin)
+            {
+                const auto count = stats.histogram[(size_t) bin];
+
+                if (count == 0)
+                    continue;
+
+                const auto height = histogramArea.getHeight() * (float) (std::log1p ((double) count) / std::log1p ((double) highest));
+                g.setColour (getLoadColour ((bin + 0.5) / 10.0));
+                g.fillRect (histogramArea.getX() + bin * binWidth, histogramArea.getBottom() - height, binWidth - 1.0f, height);
+            }
+        }
+
+        void mouseDown (const juce::MouseEvent& event) override
+        {
+            if (event.mods.isPopupMenu())
+            {
+                showTraceMenu();
+                return;
+            }
+
+            profiler.resetStats();
+            timerCallback();
+        }
+
+    private:
+        Service::LoadProfiler& profiler;
+        Service::LoadProfiler::Stats stats;
+
+        void timerCallback() override
+        {
+            stats = profiler.getStats();
+            repaint();
+        }
+
+        void showTraceMenu()
+        {
+            auto& recorder = Service::TraceRecorder::getInstance();
+
+            juce::PopupMenu menu;
+            menu.addItem ("Record trace", true, recorder.isEnabled(), [&recorder] {
+                if (! recorder.isEnabled())
+                    recorder.clear();
+
+                recorder.setEnabled (! recorder.isEnabled());
+            });
+
+            menu.addItem ("Save trace", [&recorder] {
+                const auto file = getTraceDirectory().getNonexistentChildFile ("trace-" + juce::Time::getCurrentTime().formatted ("%Y%m%d-%H%M%S"), ".json");
+
+                if (file.getParentDirectory().createDirectory().wasOk() && recorder.writeTo (file))
+                    file.revealToUser();
+            });
+
+            menu.showMenuAsync (juce::PopupMenu::Options().withTargetComponent (this));
+        }
+
+        /** Next to the presets, see PresetManager::defaultDirectory. */
+        static juce::File getTraceDirectory()
+        {
+            return juce::File::getSpecialLocation (juce::File::commonDocumentsDirectory)
+                .getChildFile ("DirektDSP")
+                .getChildFile (JucePlugin_Name)
+                .getChildFile ("Traces");
+        }
+
+        juce::String getSummary() const
+        {
+            juce::String text;
+            text << "Load " << juce::roundToInt (stats.currentLoad * 100.0) << "%  avg " << juce::roundToInt (stats.averageLoad * 100.0)
+                 << "%  peak " << juce::roundToInt (stats.peakLoad * 100.0) << "%\n"
+                 << "Worst " << juce::String (stats.worstBlockSeconds * 1000.0, 2) << " / " << juce::String (stats.worstBlockDeadline * 1000.0, 2)
+                 << " ms  misses " << stats.deadlineMisses;
+
+            if (stats.droppedBlocks > 0)
+                text << "  (" << stats.droppedBlocks << " untimed)";
+
+            return text;
+        }
+
+        static juce::Colour getLoadColour (double load)
+        {
+            if (load >= 1.0)
+                return juce::Colours::red;
+
+            if (load >= 0.7)
+                return juce::Colours::orange;
+
+            return juce::Colours::limegreen;
+        }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoadMeter)
+    };
+}
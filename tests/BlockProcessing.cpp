@@ -0,0 +1,90 @@
+#include <DSP/ChasmDSP.h>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    /**
+     * Noise through a stereo processor, handed over in blocks of the given
+     * size. The per-sample parameters (gains, mix and cutoffs) move all the
+     * way through; the control-rate ones are set before prepare() and stay
+     * put, so the sub-block boundaries don't matter.
+     */
+    template <typename SampleType>
+    std::vector<SampleType> render (int blockSize)
+    {
+        using Processor = DSP::Core::ChasmDSPProcessor<SampleType>;
+        using Parameter = typename Processor::Parameter;
+
+        constexpr int numSamples = 8192;
+        constexpr int maximumBlockSize = 512;
+
+        Processor processor;
+        processor.setParameter (Parameter::delay, SampleType { 24.0 });
+        processor.setParameter (Parameter::character, SampleType { 3.0 });
+        processor.setParameter (Parameter::brightness, SampleType { 4.0 });
+        processor.setParameter (Parameter::width, SampleType { 140.0 });
+        processor.setParameter (Parameter::haas, SampleType { 8.0 });
+        processor.setCompressorMode (2);
+        processor.setOversampling (0, Processor::OversamplingFilter::PolyphaseIIR);
+        processor.prepare ({ 48000.0, (juce::uint32) maximumBlockSize, 2 });
+
+        juce::Random random (3);
+        juce::AudioBuffer<SampleType> signal (2, numSamples);
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                signal.setSample (channel, i, static_cast<SampleType> (random.nextFloat() - 0.5f));
+
+        for (int start = 0; start < numSamples;)
+        {
+            // new targets every 1024 samples, where a block is cut short if need be
+            constexpr int changeInterval = 1024;
+
+            if (start % changeInterval == 0)
+            {
+                const auto step = static_cast<SampleType> (start / changeInterval);
+                processor.setParameter (Parameter::inputGain, step - SampleType { 3.0 });
+                processor.setParameter (Parameter::outputGain, SampleType { 2.0 } - step);
+                processor.setParameter (Parameter::mix, SampleType { 20.0 } + step * SampleType { 8.0 });
+                processor.setParameter (Parameter::lowCut, SampleType { 40.0 } + step * SampleType { 60.0 });
+                processor.setParameter (Parameter::highCut, SampleType { 16000.0 } - step * SampleType { 1500.0 });
+            }
+
+            const auto length = juce::jmin (blockSize, changeInterval - start % changeInterval);
+            juce::AudioBuffer<SampleType> block (signal.getArrayOfWritePointers(), 2, start, length);
+            processor.processBlock (block);
+            start += length;
+        }
+
+        std::vector<SampleType> output;
+
+        for (int channel = 0; channel < 2; ++channel)
+            output.insert (output.end(), signal.getReadPointer (channel), signal.getReadPointer (channel) + numSamples);
+
+        return output;
+    }
+}
+
+TEMPLATE_TEST_CASE ("Block processing matches processing one sample at a time", "[dsp]", float, double)
+{
+    // one sample per call is the per-sample path: every ramp is one value long
+    // and nothing can be shared across samples
+    const auto reference = render<TestType> (1);
+
+    for (const auto blockSize : { 7, 32, 100, 512, 1500 })
+    {
+        INFO ("block size " << blockSize);
+
+        const auto output = render<TestType> (blockSize);
+        REQUIRE (output.size() == reference.size());
+
+        double maximumDifference = 0.0;
+
+        for (size_t i = 0; i < output.size(); ++i)
+            maximumDifference = std::max (maximumDifference, std::abs (static_cast<double> (output[i] - reference[i])));
+
+        // the bound documented at ChasmDSPProcessor::processBlock()
+        CHECK (maximumDifference <= (std::is_same_v<TestType, float> ? 1.0e-6 : 1.0e-12));
+    }
+}
@@ -0,0 +1,81 @@
+#include <DSP/ChasmDSP.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    using Processor = DSP::Core::ChasmDSPProcessor<float>;
+    using Parameter = Processor::Parameter;
+
+    constexpr int numSamples = 24000;
+    constexpr int blockSize = 256;
+
+    /**
+     * Noise through the cut filters. An active cutoff moves to a new target
+     * every 4096 samples, so the output has both gliding and settled stretches.
+     */
+    std::vector<float> render (int numChannels, bool lowCut, bool highCut, bool specialised)
+    {
+        Processor processor;
+        processor.setParameter (Parameter::lowCut, lowCut ? 120.0f : 0.0f);
+        processor.setParameter (Parameter::highCut, highCut ? 6000.0f : 20000.0f);
+        processor.setUseSpecialisedKernels (specialised);
+        processor.prepare ({ 48000.0, (juce::uint32) blockSize, (juce::uint32) numChannels });
+
+        juce::Random random (11);
+        juce::AudioBuffer<float> signal (numChannels, numSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                signal.setSample (channel, i, random.nextFloat() - 0.5f);
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            if (start % 4096 == 0)
+            {
+                const auto step = static_cast<float> (start / 4096);
+
+                if (lowCut)
+                    processor.setParameter (Parameter::lowCut, 120.0f + 150.0f * step);
+
+                if (highCut)
+                    processor.setParameter (Parameter::highCut, 6000.0f + 1800.0f * step);
+            }
+
+            juce::AudioBuffer<float> block (signal.getArrayOfWritePointers(), numChannels, start, juce::jmin (blockSize, numSamples - start));
+            processor.processBlock (block);
+        }
+
+        std::vector<float> output;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            output.insert (output.end(), signal.getReadPointer (channel), signal.getReadPointer (channel) + numSamples);
+
+        return output;
+    }
+}
+
+TEST_CASE ("Specialised cut kernels match the general kernel exactly", "[dsp][filters]")
+{
+    for (const auto numChannels : { 1, 2 })
+    {
+        const auto unfiltered = render (numChannels, false, false, true);
+
+        for (const auto lowCut : { false, true })
+        {
+            for (const auto highCut : { false, true })
+            {
+                INFO (numChannels << " channels, low cut " << (lowCut ? "on" : "off") << ", high cut " << (highCut ? "on" : "off"));
+
+                const auto general = render (numChannels, lowCut, highCut, false);
+                const auto specialised = render (numChannels, lowCut, highCut, true);
+
+                REQUIRE (general.size() == specialised.size());
+                CHECK (general == specialised);
+
+                // and the filters did something
+                if (lowCut || highCut)
+                    CHECK (specialised != unfiltered);
+            }
+        }
+    }
+}
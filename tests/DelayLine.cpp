@@ -0,0 +1,134 @@
+#include <DSP/Filters/DelayLine.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    using DSP::Filters::DelayInterpolation;
+    using DelayLine = DSP::Filters::DelayLine<double>;
+
+    constexpr DelayInterpolation interpolations[] = { DelayInterpolation::Linear, DelayInterpolation::Lagrange3rd, DelayInterpolation::Thiran };
+
+    /** Runs the input through the delay line, read before write as documented. */
+    std::vector<double> process (DelayLine& delayLine, const std::vector<double>& input)
+    {
+        std::vector<double> output;
+        output.reserve (input.size());
+
+        for (const auto sample : input)
+        {
+            output.push_back (delayLine.readSample());
+            delayLine.writeSample (sample);
+        }
+
+        return output;
+    }
+
+    /** Largest error against a sine delayed by exactly delaySamples, once the interpolator settled. */
+    double sineError (DelayInterpolation interpolation, double delaySamples, double frequency)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int numSamples = 4800;
+        const auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+
+        DelayLine delayLine;
+        delayLine.prepare (64.0);
+        delayLine.setInterpolation (interpolation);
+        delayLine.setDelaySamples (delaySamples);
+
+        std::vector<double> input ((size_t) numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            input[(size_t) i] = std::sin (omega * i);
+
+        const auto output = process (delayLine, input);
+        double error = 0.0;
+
+        // skip the start, where the buffer is still filling and the Thiran allpass rings in
+        for (int i = 480; i < numSamples; ++i)
+            error = std::max (error, std::abs (output[(size_t) i] - std::sin (omega * (i - delaySamples))));
+
+        return error;
+    }
+}
+
+TEST_CASE ("Delay line capacity is a power of two", "[dsp][delay]")
+{
+    DelayLine delayLine;
+
+    // 100 samples plus the 4 interpolator taps round up to 128
+    delayLine.prepare (100.0);
+    CHECK (delayLine.getMaximumDelaySamples() == 124.0);
+
+    delayLine.prepare (124.0);
+    CHECK (delayLine.getMaximumDelaySamples() == 124.0);
+
+    delayLine.prepare (125.0);
+    CHECK (delayLine.getMaximumDelaySamples() == 252.0);
+
+    // delays are clamped to what the buffer and interpolator can do
+    delayLine.setDelaySamples (1000.0);
+    CHECK (delayLine.getDelaySamples() == 252.0);
+
+    delayLine.setInterpolation (DelayInterpolation::Thiran);
+    delayLine.setDelaySamples (0.5);
+    CHECK (delayLine.getDelaySamples() == 2.0);
+}
+
+TEST_CASE ("Integer delays are exact across the buffer wrap", "[dsp][delay]")
+{
+    // far longer than the 128 sample buffer, so the write head wraps many times
+    std::vector<double> input (5000);
+    juce::Random random (5);
+
+    for (auto& sample : input)
+        sample = random.nextDouble() * 2.0 - 1.0;
+
+    for (const auto interpolation : interpolations)
+    {
+        for (const auto delaySamples : { 2, 3, 17, 64, 124 })
+        {
+            INFO ("interpolation " << (int) interpolation << ", delay " << delaySamples);
+
+            DelayLine delayLine;
+            delayLine.prepare (100.0);
+            delayLine.setInterpolation (interpolation);
+            delayLine.setDelaySamples (delaySamples);
+
+            const auto output = process (delayLine, input);
+            auto exact = true;
+
+            for (size_t i = 0; i < input.size(); ++i)
+                exact = exact && output[i] == (i < (size_t) delaySamples ? 0.0 : input[i - (size_t) delaySamples]);
+
+            CHECK (exact);
+        }
+    }
+
+    SECTION ("one sample with linear interpolation")
+    {
+        DelayLine delayLine;
+        delayLine.prepare (100.0);
+        delayLine.setDelaySamples (1.0);
+
+        const auto output = process (delayLine, input);
+        CHECK (output[0] == 0.0);
+        CHECK (std::equal (output.begin() + 1, output.end(), input.begin()));
+    }
+}
+
+TEST_CASE ("Fractional delays match a delayed sine", "[dsp][delay]")
+{
+    // errors at 1 kHz, 48 kHz sample rate, over the fractional positions each interpolator uses
+    for (const auto fraction : { 0.1, 0.25, 0.5, 0.75, 0.9 })
+    {
+        INFO ("fraction " << fraction);
+
+        CHECK (sineError (DelayInterpolation::Linear, 10.0 + fraction, 1000.0) < 2.5e-3);
+        CHECK (sineError (DelayInterpolation::Lagrange3rd, 10.0 + fraction, 1000.0) < 1.0e-5);
+        CHECK (sineError (DelayInterpolation::Thiran, 10.0 + fraction, 1000.0) < 5.0e-4);
+    }
+
+    // further up, linear interpolation loses 1.2 dB at half a sample while Lagrange stays close
+    CHECK (sineError (DelayInterpolation::Linear, 10.5, 8000.0) > 0.1);
+    CHECK (sineError (DelayInterpolation::Lagrange3rd, 10.5, 8000.0) < 3.0e-2);
+}
@@ -0,0 +1,142 @@
+#include <DSP/Filters/EQFilters.h>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+
+    template <typename SampleType>
+    std::vector<SampleType> makeNoise (int numSamples)
+    {
+        juce::Random random (3);
+        std::vector<SampleType> noise ((size_t) numSamples);
+
+        for (auto& sample : noise)
+            sample = static_cast<SampleType> (random.nextFloat() - 0.5f);
+
+        return noise;
+    }
+
+    template <typename SampleType>
+    double maximumDifference (const std::vector<SampleType>& a, const std::vector<SampleType>& b)
+    {
+        double difference = 0.0;
+
+        for (size_t i = 0; i < a.size(); ++i)
+            difference = std::max (difference, std::abs (static_cast<double> (a[i]) - static_cast<double> (b[i])));
+
+        return difference;
+    }
+
+    // the coefficients are rounded differently, which float's feedback amplifies;
+    // measured at 1.0e-5 for float (192 kHz, +12 dB) and 1.4e-14 for double
+    template <typename SampleType>
+    constexpr double shelfTolerance = std::is_same_v<SampleType, float> ? 1.0e-4 : 1.0e-12;
+}
+
+TEMPLATE_TEST_CASE ("BrightnessEQ matches JUCE's high shelf", "[dsp][eq]", float, double)
+{
+    constexpr int numSamples = 4096;
+    const auto input = makeNoise<TestType> (numSamples);
+
+    for (const auto sampleRate : sampleRates)
+    {
+        for (const auto brightness : { -12.0, -5.5, 0.0, 3.0, 12.0 })
+        {
+            INFO (sampleRate << " Hz, " << brightness << " dB");
+
+            DSP::Filters::BrightnessEQ<TestType> eq;
+            eq.prepare ({ sampleRate, (juce::uint32) numSamples, 1 });
+            eq.setBrightness (static_cast<TestType> (brightness));
+
+            juce::AudioBuffer<TestType> buffer (1, numSamples);
+            std::copy (input.begin(), input.end(), buffer.getWritePointer (0));
+            eq.processBlock (buffer);
+            const std::vector<TestType> output (buffer.getReadPointer (0), buffer.getReadPointer (0) + numSamples);
+
+            // the shelf BrightnessEQ was built on: 3 kHz, Q 1.2
+            juce::dsp::IIR::Filter<TestType> reference;
+            reference.coefficients = juce::dsp::IIR::Coefficients<TestType>::makeHighShelf (sampleRate, TestType (3000), TestType (1.2),
+                                                                                            juce::Decibels::decibelsToGain (static_cast<TestType> (brightness)));
+            reference.reset();
+
+            std::vector<TestType> expected;
+
+            for (const auto sample : input)
+                expected.push_back (reference.processSample (sample));
+
+            CHECK (maximumDifference (output, expected) < shelfTolerance<TestType>);
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE ("CutFilter matches JUCE's state variable filter", "[dsp][eq]", float, double)
+{
+    using CutFilter = DSP::Filters::CutFilter<TestType>;
+    using Reference = juce::dsp::StateVariableTPTFilter<TestType>;
+
+    constexpr int numSamples = 8192;
+    constexpr int sweepInterval = 256;
+    const auto input = makeNoise<TestType> (numSamples);
+
+    for (const auto sampleRate : sampleRates)
+    {
+        for (const auto lowpass : { true, false })
+        {
+            INFO (sampleRate << " Hz, " << (lowpass ? "low" : "high") << " pass");
+
+            CutFilter filter;
+            filter.setType (lowpass ? CutFilter::Type::lowpass : CutFilter::Type::highpass);
+            filter.prepare ({ sampleRate, (juce::uint32) numSamples, 1 });
+
+            Reference reference;
+            reference.setType (lowpass ? juce::dsp::StateVariableTPTFilterType::lowpass : juce::dsp::StateVariableTPTFilterType::highpass);
+            reference.prepare ({ sampleRate, (juce::uint32) numSamples, 1 });
+
+            std::vector<TestType> output, expected;
+
+            // swept from 20 Hz to just below Nyquist, past where the table falls back to std::tan
+            for (int i = 0; i < numSamples; ++i)
+            {
+                if (i % sweepInterval == 0)
+                {
+                    const auto position = static_cast<double> (i / sweepInterval) / (numSamples / sweepInterval - 1);
+                    const auto cutoff = static_cast<TestType> (20.0 * std::pow (0.49 * sampleRate / 20.0, position));
+                    filter.setCutoffFrequency (cutoff);
+                    reference.setCutoffFrequency (cutoff);
+                }
+
+                output.push_back (filter.processSample (0, input[(size_t) i]));
+                expected.push_back (reference.processSample (0, input[(size_t) i]));
+            }
+
+            // the prewarp table is off by up to 1e-5 of g, which the filter passes on about as much;
+            // measured at 4.9e-7 for double and 1.4e-5 for float
+            CHECK (maximumDifference (output, expected) < 1.0e-4);
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE ("PrewarpTable stays within its error bound", "[dsp][eq]", float, double)
+{
+    for (const auto sampleRate : sampleRates)
+    {
+        INFO (sampleRate << " Hz");
+
+        DSP::Filters::PrewarpTable<TestType> table;
+        table.prepare (sampleRate);
+
+        double worstError = 0.0;
+
+        // every cutoff from 10 Hz to just below Nyquist, on and between the table points
+        for (auto frequency = 10.0; frequency < 0.499 * sampleRate; frequency *= 1.0007)
+        {
+            const auto exact = std::tan (juce::MathConstants<double>::pi * static_cast<double> (static_cast<TestType> (frequency)) / sampleRate);
+            const auto error = std::abs (static_cast<double> (table.get (static_cast<TestType> (frequency))) - exact) / exact;
+            worstError = std::max (worstError, error);
+        }
+
+        CHECK (worstError < 1.0e-5);
+    }
+}
@@ -0,0 +1,120 @@
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+#include <limits>
+
+namespace
+{
+    using DSP::Utils::CpuDispatch;
+    using DSP::Utils::InstructionSet;
+
+    /** Noise through a processor with every stage active and moving parameters. */
+    template <typename SampleType>
+    std::vector<SampleType> render (InstructionSet instructionSet)
+    {
+        using Processor = DSP::Core::ChasmDSPProcessor<SampleType>;
+        using Parameter = typename Processor::Parameter;
+
+        constexpr int blockSize = 512;
+
+        Processor processor;
+        processor.setParameter (Parameter::lowCut, SampleType { 80.0 });
+        processor.setParameter (Parameter::highCut, SampleType { 8000.0 });
+        processor.setParameter (Parameter::haas, SampleType { 10.0 });
+        processor.setCompressorMode (3);
+        processor.setOversampling (1, Processor::OversamplingFilter::PolyphaseIIR);
+        processor.setInstructionSet (instructionSet);
+        processor.prepare ({ 48000.0, (juce::uint32) blockSize, 2 });
+
+        REQUIRE (processor.getInstructionSet() == instructionSet);
+
+        juce::Random random (42);
+        juce::AudioBuffer<SampleType> buffer (2, blockSize);
+        std::vector<SampleType> output;
+
+        for (int block = 0; block < 64; ++block)
+        {
+            processor.setParameter (Parameter::delay, static_cast<SampleType> (20 + block % 7));
+            processor.setParameter (Parameter::width, static_cast<SampleType> (50 + block));
+            processor.setParameter (Parameter::mix, static_cast<SampleType> (block % 3 == 0 ? 100 : 60));
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample (channel, i, static_cast<SampleType> (random.nextFloat() - 0.5f));
+
+            processor.processBlock (buffer);
+
+            for (int channel = 0; channel < 2; ++channel)
+                output.insert (output.end(), buffer.getReadPointer (channel), buffer.getReadPointer (channel) + blockSize);
+        }
+
+        return output;
+    }
+
+    /**
+     * FMA contraction and vector reductions round differently, so not bit-exact.
+     * The bound is a number of ULPs at the signal's peak level, so it holds for any
+     * compiler and contraction setting; measured at 4.5e-7 for float and 4.7e-16
+     * for double, 6 and 3 ULPs of the 0.63 peak.
+     */
+    template <typename SampleType>
+    void compareInstructionSets()
+    {
+        constexpr double toleranceUlps = 100.0;
+
+        const auto reference = render<SampleType> (InstructionSet::baseline);
+
+        double peak = 0.0;
+
+        for (const auto sample : reference)
+            peak = std::max (peak, std::abs (static_cast<double> (sample)));
+
+        REQUIRE (peak > 0.1);
+        const auto tolerance = toleranceUlps * std::numeric_limits<SampleType>::epsilon() * peak;
+
+        for (auto index = 1; index < static_cast<int> (InstructionSet::numInstructionSets); ++index)
+        {
+            const auto instructionSet = static_cast<InstructionSet> (index);
+
+            if (! CpuDispatch::isSupported (instructionSet))
+            {
+                WARN (CpuDispatch::getName (instructionSet) << " is not supported here, not tested");
+                continue;
+            }
+
+            INFO (CpuDispatch::getName (instructionSet));
+
+            const auto output = render<SampleType> (instructionSet);
+            REQUIRE (output.size() == reference.size());
+
+            double maximumDifference = 0.0;
+
+            for (size_t i = 0; i < output.size(); ++i)
+                maximumDifference = std::max (maximumDifference, std::abs (static_cast<double> (output[i] - reference[i])));
+
+            CHECK (maximumDifference <= tolerance);
+        }
+    }
+}
+
+TEST_CASE ("Every instruction set variant matches the baseline", "[dsp][cpu]")
+{
+    SECTION ("float")
+    {
+        compareInstructionSets<float>();
+    }
+
+    SECTION ("double")
+    {
+        compareInstructionSets<double>();
+    }
+}
+
+TEST_CASE ("The best supported instruction set is selected", "[dsp][cpu]")
+{
+    const auto best = CpuDispatch::getBestInstructionSet();
+    CHECK (CpuDispatch::isSupported (best));
+
+    DSP::FloatProcessor processor;
+    processor.prepare ({ 48000.0, 512, 2 });
+    CHECK (processor.getInstructionSet() == best);
+}
@@ -0,0 +1,242 @@
+#include <DSP/Effects/Limiter.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    using Limiter = DSP::Effects::LookaheadLimiter<float>;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int numSamples = 48000;
+    constexpr int maximumBlockSize = 512;
+
+    /** Runs a stereo signal through the limiter in uneven blocks, as a host would. */
+    juce::AudioBuffer<float> process (Limiter& limiter, const juce::AudioBuffer<float>& input)
+    {
+        juce::AudioBuffer<float> output (input);
+        juce::Random random (9);
+
+        for (int start = 0; start < output.getNumSamples();)
+        {
+            const auto length = juce::jmin (1 + random.nextInt (maximumBlockSize), output.getNumSamples() - start);
+            juce::AudioBuffer<float> block (output.getArrayOfWritePointers(), output.getNumChannels(), start, length);
+            limiter.processBlock (block);
+            start += length;
+        }
+
+        return output;
+    }
+
+    /**
+     * Largest inter-sample peak, from a 4x windowed-sinc interpolation much
+     * longer than the limiter's own 12 taps per phase.
+     */
+    float measureTruePeak (const juce::AudioBuffer<float>& buffer)
+    {
+        constexpr int oversampling = 4;
+        constexpr int halfLength = 64; // input samples on each side
+
+        std::array<std::vector<double>, oversampling> phases;
+
+        for (int phase = 0; phase < oversampling; ++phase)
+        {
+            for (int tap = -halfLength; tap < halfLength; ++tap)
+            {
+                const auto x = tap + phase / static_cast<double> (oversampling);
+                const auto sinc = x == 0.0 ? 1.0 : std::sin (juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+                const auto window = 0.42 + 0.5 * std::cos (juce::MathConstants<double>::pi * x / halfLength)
+                                  + 0.08 * std::cos (juce::MathConstants<double>::twoPi * x / halfLength);
+                phases[(size_t) phase].push_back (sinc * window);
+            }
+        }
+
+        double peak = 0.0;
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            const auto* samples = buffer.getReadPointer (channel);
+
+            for (int i = halfLength; i < buffer.getNumSamples() - halfLength; ++i)
+            {
+                for (const auto& phase : phases)
+                {
+                    double value = 0.0;
+
+                    for (int tap = 0; tap < 2 * halfLength; ++tap)
+                        value += phase[(size_t) tap] * samples[i - tap + halfLength];
+
+                    peak = std::max (peak, std::abs (value));
+                }
+            }
+        }
+
+        return static_cast<float> (peak);
+    }
+
+    /** Noise 12 dB over full scale, low-passed at 16 kHz like program material. */
+    juce::AudioBuffer<float> makeHotNoise()
+    {
+        constexpr int halfLength = 32;
+        const auto cutoff = 16000.0 / sampleRate;
+
+        std::vector<double> lowpass;
+
+        for (int tap = -halfLength; tap <= halfLength; ++tap)
+        {
+            const auto sinc = tap == 0 ? 2.0 * cutoff : std::sin (juce::MathConstants<double>::twoPi * cutoff * tap) / (juce::MathConstants<double>::pi * tap);
+            lowpass.push_back (sinc * (0.54 + 0.46 * std::cos (juce::MathConstants<double>::pi * tap / halfLength)));
+        }
+
+        juce::AudioBuffer<float> buffer (2, numSamples);
+        juce::Random random (1);
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            std::vector<double> white ((size_t) (numSamples + 2 * halfLength));
+
+            for (auto& sample : white)
+                sample = 4.0 * (random.nextDouble() * 2.0 - 1.0);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                double sum = 0.0;
+
+                for (size_t tap = 0; tap < lowpass.size(); ++tap)
+                    sum += lowpass[tap] * white[(size_t) i + tap];
+
+                buffer.setSample (channel, i, static_cast<float> (sum));
+            }
+        }
+
+        return buffer;
+    }
+
+    /**
+     * Quiet material with loud attacks: bursts of a 12 kHz sine, phased so its
+     * peaks fall between the samples, each rising within 0.3 ms and decaying.
+     */
+    juce::AudioBuffer<float> makeTransients()
+    {
+        juce::AudioBuffer<float> buffer (2, numSamples);
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto sinceAttack = i % 4800;
+                const auto attack = 0.5 - 0.5 * std::cos (juce::MathConstants<double>::pi * juce::jmin (1.0, sinceAttack / 16.0));
+                const auto envelope = 0.05 + 3.0 * attack * std::exp (-sinceAttack / 200.0);
+                const auto phase = juce::MathConstants<double>::halfPi * i * 0.999 + juce::MathConstants<double>::pi / 4.0 + channel;
+                buffer.setSample (channel, i, static_cast<float> (envelope * std::sin (phase)));
+            }
+        }
+
+        return buffer;
+    }
+}
+
+TEST_CASE ("Limiter output stays under the ceiling", "[dsp][limiter]")
+{
+    const auto ceilingDb = -1.0f;
+    const auto ceiling = juce::Decibels::decibelsToGain (ceilingDb);
+
+    for (const auto& [name, input] : { std::make_pair ("hot noise", makeHotNoise()), std::make_pair ("transients", makeTransients()) })
+    {
+        for (const auto truePeak : { false, true })
+        {
+            INFO (name << (truePeak ? ", true peak" : ", sample peak"));
+
+            Limiter limiter;
+            limiter.prepare ({ sampleRate, (juce::uint32) maximumBlockSize, 2 });
+            limiter.setCeiling (ceilingDb);
+            limiter.setTruePeak (truePeak);
+
+            const auto output = process (limiter, input);
+            CHECK (output.getMagnitude (0, numSamples) <= ceiling);
+
+            // measured with a longer interpolator than the limiter's own, which
+            // reads a few hundredths of a dB low on content close to 16 kHz
+            if (truePeak)
+                CHECK (juce::Decibels::gainToDecibels (measureTruePeak (output)) <= ceilingDb + 0.05f);
+        }
+    }
+}
+
+TEST_CASE ("Limiter delays by exactly its latency", "[dsp][limiter]")
+{
+    for (const auto truePeak : { true, false })
+    {
+        Limiter limiter;
+        limiter.prepare ({ sampleRate, (juce::uint32) maximumBlockSize, 2 });
+        limiter.setTruePeak (truePeak);
+
+        const auto latency = limiter.getLatencySamples();
+        REQUIRE (latency > 0);
+
+        // below the ceiling, so it comes out untouched
+        juce::AudioBuffer<float> input (2, 4096);
+        input.clear();
+        input.setSample (0, 100, 0.5f);
+        input.setSample (1, 100, -0.25f);
+
+        const auto output = process (limiter, input);
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            auto exact = true;
+
+            for (int i = 0; i < output.getNumSamples(); ++i)
+                exact = exact && output.getSample (channel, i) == (i == 100 + latency ? input.getSample (channel, 100) : 0.0f);
+
+            CHECK (exact);
+        }
+
+        CHECK (limiter.getGainReduction() == 0.0f);
+    }
+}
+
+TEST_CASE ("Limiter reports the gain reduction it applied", "[dsp][limiter]")
+{
+    Limiter limiter;
+    limiter.prepare ({ sampleRate, (juce::uint32) maximumBlockSize, 2 });
+    limiter.setCeiling (0.0f);
+
+    const auto latency = limiter.getLatencySamples();
+    const auto input = makeTransients();
+
+    // one block after the other, comparing what came out with what went in latency samples earlier
+    juce::AudioBuffer<float> block (2, 256);
+    auto limitedBlocks = 0;
+
+    for (int start = 0; start + block.getNumSamples() <= numSamples; start += block.getNumSamples())
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            block.copyFrom (channel, 0, input, channel, start, block.getNumSamples());
+
+        limiter.processBlock (block);
+
+        auto appliedGain = 1.0f;
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            for (int i = 0; i < block.getNumSamples(); ++i)
+            {
+                const auto source = start + i - latency;
+                const auto dry = source >= 0 ? input.getSample (channel, source) : 0.0f;
+
+                // near zero crossings the ratio is mostly rounding
+                if (std::abs (dry) > 1.0e-3f)
+                    appliedGain = std::min (appliedGain, block.getSample (channel, i) / dry);
+            }
+        }
+
+        const auto appliedDb = -juce::Decibels::gainToDecibels (appliedGain);
+        INFO ("block at " << start << ": applied " << appliedDb << " dB, reported " << limiter.getGainReduction() << " dB");
+        CHECK (std::abs (limiter.getGainReduction() - appliedDb) < 0.01f);
+
+        if (appliedDb > 1.0f)
+            ++limitedBlocks;
+    }
+
+    // most blocks of the bursts need limiting
+    CHECK (limitedBlocks > 10);
+}
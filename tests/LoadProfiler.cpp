@@ -0,0 +1,91 @@
+#include <Service/LoadProfiler.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    /** Ticks for a block that took the given fraction of its deadline. */
+    juce::int64 ticksFor (double load, int numSamples, double sampleRate)
+    {
+        return static_cast<juce::int64> (load * numSamples / sampleRate * static_cast<double> (juce::Time::getHighResolutionTicksPerSecond()));
+    }
+}
+
+TEST_CASE ("Load profiler statistics", "[load]")
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 480;
+
+    Service::LoadProfiler profiler;
+    profiler.prepare (sampleRate);
+
+    SECTION ("load, worst block and misses")
+    {
+        for (const auto load : { 0.25, 0.25, 0.55, 1.5 })
+            profiler.record (ticksFor (load, blockSize, sampleRate), blockSize);
+
+        profiler.update();
+        const auto stats = profiler.getStats();
+
+        CHECK (stats.numBlocks == 4);
+        CHECK (stats.deadlineMisses == 1);
+        CHECK (stats.droppedBlocks == 0);
+        CHECK (stats.currentLoad == Catch::Approx (0.6375).epsilon (1.0e-3));
+        CHECK (stats.averageLoad == Catch::Approx (0.6375).epsilon (1.0e-3));
+        CHECK (stats.peakLoad == Catch::Approx (1.5).epsilon (1.0e-3));
+        CHECK (stats.worstBlockSeconds == Catch::Approx (0.015).epsilon (1.0e-3));
+        CHECK (stats.worstBlockDeadline == Catch::Approx (0.01).epsilon (1.0e-3));
+
+        CHECK (stats.histogram[2] == 2);
+        CHECK (stats.histogram[5] == 1);
+        CHECK (stats.histogram[Service::LoadProfiler::numHistogramBins - 1] == 1);
+
+        // the current load follows the latest update, the rest accumulates
+        profiler.record (ticksFor (0.1, blockSize, sampleRate), blockSize);
+        profiler.update();
+        const auto next = profiler.getStats();
+
+        CHECK (next.numBlocks == 5);
+        CHECK (next.currentLoad == Catch::Approx (0.1).epsilon (1.0e-3));
+        CHECK (next.averageLoad == Catch::Approx (0.53).epsilon (1.0e-3));
+        CHECK (next.peakLoad == Catch::Approx (1.5).epsilon (1.0e-3));
+    }
+
+    SECTION ("reset")
+    {
+        profiler.record (ticksFor (2.0, blockSize, sampleRate), blockSize);
+        profiler.update();
+        profiler.resetStats();
+
+        const auto stats = profiler.getStats();
+        CHECK (stats.numBlocks == 0);
+        CHECK (stats.deadlineMisses == 0);
+        CHECK (stats.peakLoad == 0.0);
+        CHECK (stats.sampleRate == sampleRate);
+    }
+
+    SECTION ("a full ring drops blocks instead of blocking")
+    {
+        for (int i = 0; i < 20000; ++i)
+            profiler.record (ticksFor (0.5, blockSize, sampleRate), blockSize);
+
+        profiler.update();
+        const auto stats = profiler.getStats();
+
+        CHECK (stats.numBlocks + stats.droppedBlocks == 20000);
+        CHECK (stats.droppedBlocks > 0);
+    }
+
+    SECTION ("scoped timing")
+    {
+        {
+            const Service::LoadProfiler::ScopedBlock timing (profiler, blockSize);
+        }
+
+        profiler.update();
+        const auto stats = profiler.getStats();
+
+        CHECK (stats.numBlocks == 1);
+        CHECK (stats.deadlineMisses == 0);
+    }
+}
@@ -0,0 +1,179 @@
+#include <DSP/ChasmDSP.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    using Processor = DSP::Core::ChasmDSPProcessor<float>;
+    using Parameter = Processor::Parameter;
+
+    constexpr int blockSize = 256;
+
+    // the mix smoother's time constant, 5 ms at 48 kHz
+    constexpr double mixSmoothingSamples = 240.0;
+
+    /** One processor skipping the inaudible path, one always running both, fed the same noise. */
+    struct ProcessorPair
+    {
+        ProcessorPair (float initialMix)
+        {
+            for (auto* processor : { &fast, &general })
+            {
+                processor->setParameter (Parameter::mix, initialMix);
+                processor->setParameter (Parameter::lowCut, 60.0f);
+                processor->setParameter (Parameter::haas, 5.0f);
+                processor->setCompressorMode (2);
+                processor->setOversampling (1, Processor::OversamplingFilter::PolyphaseIIR);
+                processor->prepare ({ 48000.0, (juce::uint32) blockSize, 2 });
+            }
+
+            general.setUseMixFastPaths (false);
+        }
+
+        void setParameter (Parameter parameter, float value)
+        {
+            fast.setParameter (parameter, value);
+            general.setParameter (parameter, value);
+        }
+
+        /** Processes one block of noise; returns the difference per sample, largest over the channels. */
+        std::vector<float> process()
+        {
+            juce::AudioBuffer<float> fastBuffer (2, blockSize);
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    fastBuffer.setSample (channel, i, random.nextFloat() - 0.5f);
+
+            juce::AudioBuffer<float> generalBuffer (fastBuffer);
+            fast.processBlock (fastBuffer);
+            general.processBlock (generalBuffer);
+
+            std::vector<float> difference ((size_t) blockSize, 0.0f);
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    difference[(size_t) i] = std::max (difference[(size_t) i], std::abs (fastBuffer.getSample (channel, i) - generalBuffer.getSample (channel, i)));
+
+            return difference;
+        }
+
+        /** True if the next blocks come out bit for bit the same. */
+        bool processIdentically (int numBlocks)
+        {
+            auto identical = true;
+
+            for (int block = 0; block < numBlocks; ++block)
+                for (const auto difference : process())
+                    identical = identical && difference == 0.0f;
+
+            return identical;
+        }
+
+        Processor fast, general;
+        juce::Random random { 8 };
+    };
+
+    /**
+     * Whether the first block after the mix starts moving away from a settled
+     * value only differs as much as the path coming back in is faded: by at
+     * most that path's share of the mix, times a bound on the signal level.
+     */
+    bool fadesIn (const std::vector<float>& difference, float mixChange)
+    {
+        constexpr float levelBound = 4.0f;
+
+        for (size_t i = 0; i < difference.size(); ++i)
+        {
+            // 1 - (1 - c)^n <= n c for the exponential smoother
+            const auto share = std::abs (mixChange) * static_cast<float> ((double) (i + 1) / mixSmoothingSamples);
+
+            if (difference[i] > share * levelBound)
+                return false;
+        }
+
+        return true;
+    }
+}
+
+TEST_CASE ("The mix fast paths match the general path when settled", "[dsp][mix]")
+{
+    SECTION ("dry only")
+    {
+        ProcessorPair pair (0.0f);
+        CHECK (pair.processIdentically (50));
+
+        // the output gain still ramps on the dry path
+        pair.setParameter (Parameter::outputGain, -6.0f);
+        CHECK (pair.processIdentically (50));
+    }
+
+    SECTION ("wet only")
+    {
+        ProcessorPair pair (100.0f);
+        CHECK (pair.processIdentically (50));
+
+        pair.setParameter (Parameter::outputGain, -6.0f);
+        pair.setParameter (Parameter::delay, 45.0f);
+        CHECK (pair.processIdentically (50));
+    }
+}
+
+TEST_CASE ("The mix fast paths fade the skipped path back in", "[dsp][mix]")
+{
+    SECTION ("leaving 100%")
+    {
+        ProcessorPair pair (100.0f);
+        CHECK (pair.processIdentically (20));
+
+        // the dry delays restart from silence, which the falling mix fades in;
+        // once they are full again the paths agree exactly
+        pair.setParameter (Parameter::mix, 40.0f);
+        CHECK (fadesIn (pair.process(), 0.6f));
+        CHECK (pair.processIdentically (50));
+
+        pair.setParameter (Parameter::mix, 100.0f);
+        CHECK (pair.processIdentically (50));
+    }
+
+    SECTION ("leaving 0%")
+    {
+        ProcessorPair pair (0.0f);
+        CHECK (pair.processIdentically (20));
+
+        // the wet path restarts from silence while the general one kept ringing,
+        // so the difference only fades in with the mix
+        pair.setParameter (Parameter::mix, 70.0f);
+        CHECK (fadesIn (pair.process(), 0.7f));
+
+        for (int block = 0; block < 50; ++block)
+            pair.process();
+
+        // back to 0% makes the wet path inaudible again, so the outputs agree once it settled
+        pair.setParameter (Parameter::mix, 0.0f);
+
+        for (int block = 0; block < 20; ++block)
+            pair.process();
+
+        CHECK (pair.processIdentically (20));
+    }
+
+    SECTION ("from one end to the other")
+    {
+        ProcessorPair pair (0.0f);
+        CHECK (pair.processIdentically (20));
+
+        pair.setParameter (Parameter::mix, 100.0f);
+        CHECK (fadesIn (pair.process(), 1.0f));
+
+        // wet only again; the wet paths differ by what was left of the general one's tail
+        for (int block = 0; block < 20; ++block)
+            pair.process();
+
+        pair.setParameter (Parameter::mix, 0.0f);
+
+        for (int block = 0; block < 20; ++block)
+            pair.process();
+
+        CHECK (pair.processIdentically (20));
+    }
+}
@@ -0,0 +1,167 @@
+#include "../render/Renderer.h"
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    /**
+     * Reports a latency and delays by exactly that, adding one echo after it
+     * that only the tail can hold. Stereo, either precision.
+     */
+    class DelayingProcessor : public juce::AudioProcessor
+    {
+    public:
+        static constexpr int latency = 300;
+        static constexpr int echo = 750; // 1/64 s, so the tail in seconds converts back exactly
+
+        DelayingProcessor()
+            : AudioProcessor (BusesProperties().withInput ("Input", juce::AudioChannelSet::stereo())
+                                               .withOutput ("Output", juce::AudioChannelSet::stereo()))
+        {
+            setLatencySamples (latency);
+        }
+
+        void prepareToPlay (double, int) override
+        {
+            for (auto& channel : history)
+                channel.assign ((size_t) (latency + echo + 1), 0.0);
+
+            position = 0;
+        }
+
+        void releaseResources() override {}
+
+        void processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override { process (buffer); }
+        void processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&) override { process (buffer); }
+        bool supportsDoublePrecisionProcessing() const override { return true; }
+
+        double getTailLengthSeconds() const override { return echo / sampleRate; }
+
+        const juce::String getName() const override { return "Delaying"; }
+        bool acceptsMidi() const override { return false; }
+        bool producesMidi() const override { return false; }
+        juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+        bool hasEditor() const override { return false; }
+        int getNumPrograms() override { return 1; }
+        int getCurrentProgram() override { return 0; }
+        void setCurrentProgram (int) override {}
+        const juce::String getProgramName (int) override { return {}; }
+        void changeProgramName (int, const juce::String&) override {}
+        void getStateInformation (juce::MemoryBlock&) override {}
+        void setStateInformation (const void*, int) override {}
+
+    private:
+        template <typename SampleType>
+        void process (juce::AudioBuffer<SampleType>& buffer)
+        {
+            const auto length = history[0].size();
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                for (int channel = 0; channel < 2; ++channel)
+                {
+                    auto& past = history[(size_t) channel];
+                    past[position] = static_cast<double> (buffer.getSample (channel, i));
+
+                    const auto delayed = past[(position + length - latency) % length] + 0.5 * past[(position + length - latency - echo) % length];
+                    buffer.setSample (channel, i, static_cast<SampleType> (delayed));
+                }
+
+                position = (position + 1) % length;
+            }
+        }
+
+        std::array<std::vector<double>, 2> history;
+        size_t position = 0;
+    };
+
+    /** A 32 bit float WAV in memory holding one impulse per channel. */
+    juce::MemoryBlock makeImpulseFile (int numChannels, int numSamples, int impulsePosition)
+    {
+        juce::AudioBuffer<float> impulse (numChannels, numSamples);
+        impulse.clear();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            impulse.setSample (channel, impulsePosition, channel == 0 ? 0.75f : -0.5f);
+
+        juce::MemoryBlock file;
+        juce::WavAudioFormat wav;
+
+        {
+            const std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (new juce::MemoryOutputStream (file, false), sampleRate,
+                                                                                        (unsigned int) numChannels, 32, {}, 0));
+            REQUIRE (writer != nullptr);
+            REQUIRE (writer->writeFromAudioSampleBuffer (impulse, 0, numSamples));
+        }
+
+        return file;
+    }
+
+    /** Renders the file through a fresh DelayingProcessor and reads the result back. */
+    template <typename SampleType>
+    juce::AudioBuffer<float> render (const juce::MemoryBlock& input, int blockSize, bool includeTail)
+    {
+        juce::WavAudioFormat wav;
+        const std::unique_ptr<juce::AudioFormatReader> reader (wav.createReaderFor (new juce::MemoryInputStream (input, false), true));
+        REQUIRE (reader != nullptr);
+
+        juce::MemoryBlock output;
+
+        {
+            const std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (new juce::MemoryOutputStream (output, false), sampleRate, 2, 32, {}, 0));
+            REQUIRE (writer != nullptr);
+
+            DelayingProcessor processor;
+            Render::renderStream<SampleType> (processor, *reader, *writer, blockSize, includeTail);
+        }
+
+        const std::unique_ptr<juce::AudioFormatReader> result (wav.createReaderFor (new juce::MemoryInputStream (output, false), true));
+        REQUIRE (result != nullptr);
+        REQUIRE (result->numChannels == 2);
+
+        juce::AudioBuffer<float> samples (2, static_cast<int> (result->lengthInSamples));
+        result->read (&samples, 0, samples.getNumSamples(), 0, true, true);
+        return samples;
+    }
+}
+
+TEMPLATE_TEST_CASE ("Offline renders line up with the input", "[render]", float, double)
+{
+    // close enough to the end that the echo only fits in the tail
+    constexpr int numSamples = 5000;
+    constexpr int impulsePosition = numSamples - DelayingProcessor::echo / 2;
+
+    // block sizes shorter than the latency, not dividing it and longer than the whole file
+    for (const auto blockSize : { 64, 1000, 8192 })
+    {
+        for (const auto numChannels : { 1, 2 })
+        {
+            for (const auto includeTail : { false, true })
+            {
+                INFO ("block size " << blockSize << ", " << numChannels << " channels, " << (includeTail ? "with" : "without") << " tail");
+
+                const auto output = render<TestType> (makeImpulseFile (numChannels, numSamples, impulsePosition), blockSize, includeTail);
+                CHECK (output.getNumSamples() == numSamples + (includeTail ? DelayingProcessor::echo : 0));
+
+                // the impulse where it went in, the echo after it if there's a tail; mono goes to both channels
+                for (int channel = 0; channel < 2; ++channel)
+                {
+                    const auto level = channel == 0 || numChannels == 1 ? 0.75f : -0.5f;
+                    auto exact = true;
+
+                    for (int i = 0; i < output.getNumSamples(); ++i)
+                    {
+                        const auto expected = i == impulsePosition ? level
+                                            : i == impulsePosition + DelayingProcessor::echo ? 0.5f * level
+                                            : 0.0f;
+                        exact = exact && output.getSample (channel, i) == expected;
+                    }
+
+                    CHECK (exact);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#include <DSP/ChasmDSP.h>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    /** Largest deviation of the packed chain from one scalar chain per lane, in dB relative to the output peak. */
+    template <typename SampleType, size_t NumLanes>
+    double packedDeviationDb()
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int numSamples = 49152; // a whole number of blocks
+
+        DSP::Filters::PackedSchroederAllpassChain<SampleType, NumLanes> packed;
+        std::array<DSP::Filters::SchroederAllpassChain<SampleType>, NumLanes> scalar;
+
+        packed.prepare (sampleRate, SampleType { 30.0 }, SampleType { 1.0 });
+
+        for (auto& chain : scalar)
+            chain.prepare (sampleRate, SampleType { 30.0 }, SampleType { 1.0 });
+
+        juce::Random random (11);
+        std::array<std::vector<SampleType>, NumLanes> packedOutput, scalarOutput;
+
+        for (size_t lane = 0; lane < NumLanes; ++lane)
+        {
+            packedOutput[lane].resize ((size_t) numSamples);
+
+            for (auto& sample : packedOutput[lane])
+                sample = static_cast<SampleType> (random.nextFloat() * 2.0f - 1.0f);
+
+            scalarOutput[lane] = packedOutput[lane];
+        }
+
+        // blocks of 256 with the settings moving in between, so both smoothers ramp
+        for (int start = 0; start < numSamples; start += 256)
+        {
+            const auto delay = static_cast<SampleType> (10 + (start / 256) % 60);
+            const auto character = static_cast<SampleType> (0.5 + ((start / 256) % 9));
+
+            packed.setDelayTime (delay);
+            packed.setCharacter (character);
+
+            std::array<SampleType*, NumLanes> channels;
+
+            for (size_t lane = 0; lane < NumLanes; ++lane)
+            {
+                scalar[lane].setDelayTime (delay);
+                scalar[lane].setCharacter (character);
+                scalar[lane].processBlock (scalarOutput[lane].data() + start, 256);
+
+                channels[lane] = packedOutput[lane].data() + start;
+            }
+
+            packed.processBlock (channels.data(), (int) NumLanes, 256);
+        }
+
+        double peak = 0.0, deviation = 0.0;
+
+        for (size_t lane = 0; lane < NumLanes; ++lane)
+        {
+            for (size_t i = 0; i < (size_t) numSamples; ++i)
+            {
+                peak = std::max (peak, std::abs (static_cast<double> (scalarOutput[lane][i])));
+                deviation = std::max (deviation, std::abs (static_cast<double> (packedOutput[lane][i] - scalarOutput[lane][i])));
+            }
+        }
+
+        return deviation > 0.0 ? 20.0 * std::log10 (deviation / peak) : -400.0;
+    }
+}
+
+TEMPLATE_TEST_CASE ("The packed allpass chain matches one scalar chain per lane", "[dsp]", float, double)
+{
+    // the packed chain interpolates in SampleType rather than double
+    CHECK (packedDeviationDb<TestType, 2>() < -120.0);
+    CHECK (packedDeviationDb<TestType, 4>() < -120.0);
+}
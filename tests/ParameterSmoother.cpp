@@ -0,0 +1,99 @@
+#include <DSP/Utils/ParameterSmoother.h>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr double smoothingTimeMs = 10.0;
+    constexpr double samplesPerTimeConstant = sampleRate * smoothingTimeMs * 0.001;
+
+    /** Samples an exact exponential ramp takes to get within the settle threshold. */
+    int getSamplesToSettle (double distance, double target)
+    {
+        const auto threshold = DSP::Utils::ParameterSmoother<double>::settleEpsilon * std::max (1.0, std::abs (target));
+        return (int) std::ceil (std::log (std::abs (distance) / threshold) * samplesPerTimeConstant);
+    }
+
+    template <typename SampleType>
+    DSP::Utils::ParameterSmoother<SampleType> makeSmoother (SampleType start, SampleType target)
+    {
+        DSP::Utils::ParameterSmoother<SampleType> smoother;
+        smoother.prepare (sampleRate, smoothingTimeMs);
+        smoother.reset (start);
+        smoother.setTargetValue (target);
+        return smoother;
+    }
+}
+
+TEMPLATE_TEST_CASE ("Parameter smoother snaps exactly to its target", "[dsp][smoother]", float, double)
+{
+    // below 1.0 the threshold is absolute, above it relative to the target
+    for (const auto target : { TestType (1), TestType (-0.25), TestType (1000) })
+    {
+        INFO ("target " << target);
+
+        auto smoother = makeSmoother (TestType (0), target);
+        REQUIRE (smoother.isSmoothing());
+
+        const auto samplesToSettle = getSamplesToSettle (target, target);
+        int numSamples = 0;
+
+        while (smoother.isSmoothing() && numSamples < 10 * samplesToSettle)
+        {
+            smoother.getNextValue();
+            ++numSamples;
+        }
+
+        CHECK_FALSE (smoother.isSmoothing());
+        CHECK (smoother.getCurrentValue() == target);
+
+        // once the ramp gets within settleEpsilon; float gets there earlier, when the
+        // steps drop below its precision and the value stops moving
+        CHECK (numSamples <= samplesToSettle + 1);
+
+        if constexpr (std::is_same_v<TestType, double>)
+            CHECK (numSamples >= samplesToSettle - 1);
+
+        // and stays there
+        CHECK (smoother.getNextValue() == target);
+        CHECK_FALSE (smoother.isSmoothing());
+    }
+}
+
+TEMPLATE_TEST_CASE ("Parameter smoother block and skip paths settle like single steps", "[dsp][smoother]", float, double)
+{
+    const auto target = TestType (0.5);
+    auto stepped = makeSmoother (TestType (0), target);
+    auto block = makeSmoother (TestType (0), target);
+    auto skipped = makeSmoother (TestType (0), target);
+
+    // past the point of settling, so the rest of the block is filled with the target
+    std::vector<TestType> values ((size_t) (2 * getSamplesToSettle (0.5, 0.5)));
+    block.getNextValues (values.data(), (int) values.size());
+    skipped.skip ((int) values.size());
+
+    auto identical = true;
+
+    for (const auto value : values)
+        identical = identical && value == stepped.getNextValue();
+
+    CHECK (identical);
+    CHECK (values.back() == target);
+    CHECK_FALSE (block.isSmoothing());
+
+    CHECK_FALSE (skipped.isSmoothing());
+    CHECK (skipped.getCurrentValue() == target);
+}
+
+TEMPLATE_TEST_CASE ("Parameter smoother targets within the threshold are taken at once", "[dsp][smoother]", float, double)
+{
+    auto smoother = makeSmoother (TestType (1000), TestType (1000.0005));
+    CHECK_FALSE (smoother.isSmoothing());
+    CHECK (smoother.getCurrentValue() == TestType (1000.0005));
+
+    // after a reset the threshold follows the new value, a step that was small at 1000 is not at 0
+    smoother.reset (TestType (0));
+    smoother.setTargetValue (TestType (0.0005));
+    CHECK (smoother.isSmoothing());
+}
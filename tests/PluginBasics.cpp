@@ -17,6 +17,12 @@ TEST_CASE ("Plugin instance", "[instance]")
         CHECK_THAT (testPlugin.getName().toStdString(),
             Catch::Matchers::Equals ("PluginTemplate"));
     }
+
+    SECTION ("no latency by default")
+    {
+        testPlugin.prepareToPlay (48000.0, 512);
+        CHECK (testPlugin.getLatencySamples() == 0);
+    }
 }
 
 
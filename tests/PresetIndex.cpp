@@ -0,0 +1,177 @@
+#include <Service/PresetIndex.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    /** An hour ago, far enough back for the index to trust it. */
+    juce::Time settled()
+    {
+        return juce::Time::getCurrentTime() - juce::RelativeTime::hours (1.0);
+    }
+
+    void writePreset (const juce::File& file, const juce::String& artist)
+    {
+        juce::XmlElement xml ("Parameters");
+        xml.setAttribute ("artist", artist);
+        xml.setAttribute ("dateCreated", "2024-01-01T00:00:00.000Z");
+        xml.createNewChildElement ("PARAM")->setAttribute ("id", "MIX");
+
+        REQUIRE (file.getParentDirectory().createDirectory().wasOk());
+        REQUIRE (xml.writeTo (file));
+        file.setLastModificationTime (settled());
+    }
+
+    void settle (const juce::File& directory)
+    {
+        directory.setLastModificationTime (settled());
+    }
+}
+
+TEST_CASE ("Preset index", "[presets]")
+{
+    const juce::TemporaryFile root;
+    const auto presets = root.getFile();
+    const auto indexFile = presets.getSiblingFile (presets.getFileName() + ".index");
+
+    writePreset (presets.getChildFile ("Init.ddsp"), "Me");
+    writePreset (presets.getChildFile ("Bass/Sub.ddsp"), "You");
+    writePreset (presets.getChildFile ("Bass/Reese.ddsp"), "Them");
+    presets.getChildFile ("Bass/notes.txt").create();
+    settle (presets.getChildFile ("Bass"));
+    settle (presets);
+
+    Service::PresetIndex index (presets, "Default", "ddsp");
+
+    CHECK (index.refresh());
+    CHECK (index.getNumFilesParsed() == 3);
+    CHECK (index.getCategories() == juce::StringArray ("Default", "Bass"));
+    CHECK (index.getPresetNames ("Default") == juce::StringArray ("Init"));
+    CHECK (index.getPresetNames ("Bass") == juce::StringArray ("Reese", "Sub"));
+
+    const auto sub = index.getMetadata ("Bass")[1];
+    CHECK (sub.name == "Sub");
+    CHECK (sub.artist == "You");
+    CHECK (sub.category == "Bass");
+    CHECK (sub.dateCreated == "2024-01-01T00:00:00.000Z");
+    CHECK (sub.fileSize == presets.getChildFile ("Bass/Sub.ddsp").getSize());
+
+    SECTION ("unchanged directories are not read again")
+    {
+        CHECK_FALSE (index.refresh());
+        CHECK_FALSE (index.refreshChangedDirectories());
+        CHECK (index.getNumFilesParsed() == 3);
+    }
+
+    SECTION ("files rewritten in place are noticed")
+    {
+        // as an editor saving over a preset might, leaving the directory time as it was
+        const auto bass = presets.getChildFile ("Bass");
+        const auto directoryTime = bass.getLastModificationTime();
+        writePreset (bass.getChildFile ("Sub.ddsp"), "Someone else");
+        bass.setLastModificationTime (directoryTime);
+
+        // only a full refresh sees it without an invalidate()
+        CHECK_FALSE (index.refreshChangedDirectories());
+        CHECK (index.getMetadata ("Bass")[1].artist == "You");
+
+        CHECK (index.refresh());
+        CHECK (index.getNumFilesParsed() == 4);
+        CHECK (index.getMetadata ("Bass")[1].artist == "Someone else");
+    }
+
+    SECTION ("only changed files are parsed")
+    {
+        writePreset (presets.getChildFile ("Bass/Sub.ddsp"), "Someone else");
+        writePreset (presets.getChildFile ("Bass/Wobble.ddsp"), "Them");
+        presets.getChildFile ("Bass/Reese.ddsp").deleteFile();
+        index.invalidate ("Bass");
+
+        CHECK (index.refresh());
+        CHECK (index.getNumFilesParsed() == 5);
+        CHECK (index.getPresetNames ("Bass") == juce::StringArray ("Sub", "Wobble"));
+        CHECK (index.getMetadata ("Bass")[0].artist == "Someone else");
+    }
+
+    SECTION ("categories follow the subdirectories")
+    {
+        presets.getChildFile ("Bass").deleteRecursively();
+        presets.getChildFile ("Lead").createDirectory();
+        index.invalidate ("Default");
+
+        CHECK (index.refresh());
+        CHECK (index.getCategories() == juce::StringArray ("Default", "Lead"));
+        CHECK (index.getPresetNames ("Lead").isEmpty());
+    }
+
+    SECTION ("recent changes are checked again")
+    {
+        // written just now, so a change within the same second could still follow
+        writePreset (presets.getChildFile ("Bass/Sub.ddsp"), "Someone else");
+        presets.getChildFile ("Bass/Sub.ddsp").setLastModificationTime (juce::Time::getCurrentTime());
+        index.invalidate ("Bass");
+
+        index.refresh();
+        index.refresh();
+        CHECK (index.getNumFilesParsed() == 5);
+    }
+
+    SECTION ("files that fail to parse are not parsed again")
+    {
+        const auto broken = presets.getChildFile ("Bass/Broken.ddsp");
+        REQUIRE (broken.replaceWithText ("not a preset"));
+        broken.setLastModificationTime (settled());
+        index.invalidate ("Bass");
+
+        CHECK (index.refresh());
+        CHECK (index.getNumFilesParsed() == 4);
+        CHECK (index.getPresetNames ("Bass") == juce::StringArray ("Reese", "Sub"));
+
+        CHECK_FALSE (index.refresh());
+        CHECK (index.getNumFilesParsed() == 4);
+
+        // remembered across sessions too
+        REQUIRE (index.save (indexFile));
+        Service::PresetIndex loaded (presets, "Default", "ddsp");
+        REQUIRE (loaded.load (indexFile));
+
+        CHECK_FALSE (loaded.refresh());
+        CHECK (loaded.getNumFilesParsed() == 0);
+
+        // until it changes, even if it still doesn't parse
+        REQUIRE (broken.replaceWithText ("still not a preset"));
+        broken.setLastModificationTime (settled());
+
+        CHECK (loaded.refresh());
+        CHECK (loaded.getNumFilesParsed() == 1);
+        CHECK (loaded.getPresetNames ("Bass") == juce::StringArray ("Reese", "Sub"));
+
+        indexFile.deleteFile();
+    }
+
+    SECTION ("saved and loaded")
+    {
+        REQUIRE (index.save (indexFile));
+
+        Service::PresetIndex loaded (presets, "Default", "ddsp");
+        REQUIRE (loaded.load (indexFile));
+
+        CHECK_FALSE (loaded.refresh());
+        CHECK (loaded.getNumFilesParsed() == 0);
+        CHECK (loaded.getPresetNames ("Bass") == juce::StringArray ("Reese", "Sub"));
+        CHECK (loaded.getMetadata ("Default")[0].artist == "Me");
+
+        // another root or a damaged file is not used
+        Service::PresetIndex elsewhere (presets.getChildFile ("Bass"), "Default", "ddsp");
+        CHECK_FALSE (elsewhere.load (indexFile));
+
+        juce::MemoryBlock data;
+        indexFile.loadFileAsData (data);
+        indexFile.replaceWithData (data.getData(), data.getSize() - 10);
+        CHECK_FALSE (loaded.load (indexFile));
+        CHECK (loaded.getCategories() == juce::StringArray ("Default"));
+
+        indexFile.deleteFile();
+    }
+
+    presets.deleteRecursively();
+}
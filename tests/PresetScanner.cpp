@@ -0,0 +1,132 @@
+#include <Service/PresetScanner.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <functional>
+
+namespace
+{
+    void writePreset (const juce::File& file, const juce::String& artist)
+    {
+        juce::XmlElement xml ("Parameters");
+        xml.setAttribute ("artist", artist);
+
+        REQUIRE (file.getParentDirectory().createDirectory().wasOk());
+        REQUIRE (xml.writeTo (file));
+    }
+
+    /** Waits up to five seconds for the scanner to publish a snapshot that passes the check. */
+    bool waitFor (const Service::PresetScanner& scanner, const std::function<bool (const Service::PresetScanner::Snapshot&)>& check)
+    {
+        for (int attempt = 0; attempt < 500; ++attempt)
+        {
+            if (check (*scanner.getSnapshot()))
+                return true;
+
+            juce::Thread::sleep (10);
+        }
+
+        return false;
+    }
+
+    struct ChangeCounter : public juce::ChangeListener
+    {
+        int count = 0;
+        void changeListenerCallback (juce::ChangeBroadcaster*) override { ++count; }
+    };
+}
+
+TEST_CASE ("Preset scanner", "[presets]")
+{
+    const juce::TemporaryFile root;
+    const auto presets = root.getFile();
+    const auto indexFile = presets.getSiblingFile (presets.getFileName() + ".index");
+
+    writePreset (presets.getChildFile ("Init.ddsp"), "Me");
+    writePreset (presets.getChildFile ("2 Pads/Warm.ddsp"), "Me");
+    writePreset (presets.getChildFile ("12 Leads/Saw.ddsp"), "Me");
+
+    // the same with change notifications (where there are any) and with polling only
+    const auto useNotifications = GENERATE (true, false);
+    Service::PresetScanner scanner (presets, "Default", "ddsp", indexFile, 50, useNotifications);
+
+    REQUIRE (waitFor (scanner, [] (const auto& snapshot) { return snapshot.isComplete; }));
+
+    const auto first = scanner.getSnapshot();
+    CHECK (first->categories == juce::StringArray ("Default", "2 Pads", "12 Leads"));
+    CHECK (first->getPresetNames ("Default") == juce::StringArray ("Init"));
+    CHECK (first->getMetadata ("2 Pads")[0].artist == "Me");
+    CHECK (indexFile.existsAsFile());
+
+    SECTION ("presets added by someone else show up")
+    {
+        writePreset (presets.getChildFile ("2 Pads/Airy.ddsp"), "Them");
+        writePreset (presets.getChildFile ("Bass/Sub.ddsp"), "Them");
+
+        CHECK (waitFor (scanner, [] (const auto& snapshot) {
+            return snapshot.getPresetNames ("2 Pads") == juce::StringArray ("Airy", "Warm")
+                && snapshot.getPresetNames ("Bass") == juce::StringArray ("Sub");
+        }));
+
+        // published snapshots never change
+        CHECK (first->getPresetNames ("2 Pads") == juce::StringArray ("Warm"));
+        CHECK (first->categories.size() == 3);
+    }
+
+    SECTION ("removed presets and categories go away")
+    {
+        presets.getChildFile ("Init.ddsp").deleteFile();
+        presets.getChildFile ("12 Leads").deleteRecursively();
+
+        CHECK (waitFor (scanner, [] (const auto& snapshot) {
+            return snapshot.getPresetNames ("Default").isEmpty() && snapshot.categories == juce::StringArray ("Default", "2 Pads");
+        }));
+    }
+
+    SECTION ("a requested rescan catches changes")
+    {
+        writePreset (presets.getChildFile ("Init.ddsp"), "Someone else");
+        scanner.rescan();
+
+        CHECK (waitFor (scanner, [] (const auto& snapshot) {
+            return snapshot.getMetadata ("Default")[0].artist == "Someone else";
+        }));
+    }
+
+    SECTION ("changes made here are published right away")
+    {
+        ChangeCounter listener;
+        scanner.addChangeListener (&listener);
+
+        // the disk first, so a scan landing in between publishes the same
+        writePreset (presets.getChildFile ("Keys/Pluck.ddsp"), "Me");
+        presets.getChildFile ("Init.ddsp").deleteFile();
+        presets.getChildFile ("12 Leads").deleteRecursively();
+
+        Service::PresetMetadata pluck;
+        pluck.name = "Pluck";
+        pluck.artist = "Me";
+        pluck.category = "Keys";
+        scanner.presetWritten (pluck);
+        scanner.presetRemoved ("Default", "Init");
+        scanner.categoryRemoved ("12 Leads");
+
+        // before any scan had the chance to see them
+        const auto changed = scanner.getSnapshot();
+        CHECK (listener.count == 3);
+        CHECK (changed->categories == juce::StringArray ("Default", "2 Pads", "Keys"));
+        CHECK (changed->getPresetNames ("Keys") == juce::StringArray ("Pluck"));
+        CHECK (changed->getPresetNames ("Default").isEmpty());
+
+        // and the scans that follow agree
+        CHECK (waitFor (scanner, [] (const auto& snapshot) {
+            return snapshot.categories == juce::StringArray ("Default", "2 Pads", "Keys")
+                && snapshot.getPresetNames ("Keys") == juce::StringArray ("Pluck")
+                && snapshot.getPresetNames ("Default").isEmpty();
+        }));
+
+        scanner.removeChangeListener (&listener);
+    }
+
+    indexFile.deleteFile();
+    presets.deleteRecursively();
+}
@@ -0,0 +1,405 @@
+/* Real-time safety checks for the audio thread.
+ *
+ * On Linux/glibc this file interposes the allocator, the blocking pthread
+ * primitives and the common blocking syscalls for the whole Tests binary.
+ * Calls are only counted on a thread inside a RealtimeScope, so the rest of
+ * the test suite is unaffected. Everything is forwarded to the real
+ * implementation, so a violation is reported rather than crashing.
+ */
+
+#if defined(__linux__)
+    // the fortified inline wrappers of read() and friends would clash with the definitions below
+    #undef _FORTIFY_SOURCE
+#endif
+
+#include <PluginProcessor.h>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#if defined(__linux__) && defined(__GLIBC__)
+    #define CHASM_REALTIME_CHECKS 1
+
+    #include <dlfcn.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <semaphore.h>
+    #include <sys/select.h>
+    #include <time.h>
+    #include <unistd.h>
+    #include <atomic>
+    #include <cerrno>
+    #include <cstdarg>
+#else
+    #define CHASM_REALTIME_CHECKS 0
+#endif
+
+namespace
+{
+    struct Violations
+    {
+        int allocations = 0;
+        int locks = 0;
+        int syscalls = 0;
+        const char* first = nullptr;
+
+    };
+
+    // Plain thread_locals in the executable: reading them never allocates
+    thread_local bool inRealtimeScope = false;
+    thread_local bool locksAllowed = false;
+    thread_local Violations violations;
+
+    void record (int Violations::*kind, const char* name)
+    {
+        ++(violations.*kind);
+
+        if (violations.first == nullptr)
+            violations.first = name;
+    }
+
+    /** Marks the current thread as the audio thread for its lifetime. */
+    struct RealtimeScope
+    {
+        explicit RealtimeScope (bool allowLocks = false)
+        {
+            locksAllowed = allowLocks;
+            inRealtimeScope = true;
+        }
+
+        ~RealtimeScope()
+        {
+            inRealtimeScope = false;
+            locksAllowed = false;
+        }
+    };
+}
+
+#if CHASM_REALTIME_CHECKS
+
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+    void __libc_free (void*);
+}
+
+namespace
+{
+    void countAllocation (const char* name)
+    {
+        if (inRealtimeScope)
+            record (&Violations::allocations, name);
+    }
+
+    void countLock (const char* name)
+    {
+        if (inRealtimeScope && ! locksAllowed)
+            record (&Violations::locks, name);
+    }
+
+    void countSyscall (const char* name)
+    {
+        if (inRealtimeScope)
+            record (&Violations::syscalls, name);
+    }
+
+    /**
+     * The next definition of an interposed function, looked up on first use.
+     * A constant-initialised atomic rather than a function-local static, whose
+     * guard could itself wait on a futex.
+     */
+    template <typename Function>
+    Function next (std::atomic<Function>& cache, const char* name)
+    {
+        auto function = cache.load (std::memory_order_relaxed);
+
+        if (function == nullptr)
+        {
+            function = reinterpret_cast<Function> (dlsym (RTLD_NEXT, name));
+            cache.store (function, std::memory_order_relaxed);
+        }
+
+        return function;
+    }
+}
+
+    #define CHASM_FORWARD(function, ...)                                           \
+        static std::atomic<decltype (&::function)> real { nullptr };             \
+        return next (real, #function) (__VA_ARGS__)
+
+extern "C"
+{
+    //==============================================================================
+    void* malloc (size_t size)
+    {
+        countAllocation ("malloc");
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t count, size_t size)
+    {
+        countAllocation ("calloc");
+        return __libc_calloc (count, size);
+    }
+
+    void* realloc (void* pointer, size_t size)
+    {
+        countAllocation ("realloc");
+        return __libc_realloc (pointer, size);
+    }
+
+    void* memalign (size_t alignment, size_t size)
+    {
+        countAllocation ("memalign");
+        return __libc_memalign (alignment, size);
+    }
+
+    void* aligned_alloc (size_t alignment, size_t size)
+    {
+        countAllocation ("aligned_alloc");
+        return __libc_memalign (alignment, size);
+    }
+
+    int posix_memalign (void** pointer, size_t alignment, size_t size)
+    {
+        countAllocation ("posix_memalign");
+        *pointer = __libc_memalign (alignment, size);
+        return *pointer != nullptr || size == 0 ? 0 : ENOMEM;
+    }
+
+    void free (void* pointer)
+    {
+        if (pointer != nullptr)
+            countAllocation ("free");
+
+        __libc_free (pointer);
+    }
+
+    //==============================================================================
+    int pthread_mutex_lock (pthread_mutex_t* mutex)
+    {
+        countLock ("pthread_mutex_lock");
+        CHASM_FORWARD (pthread_mutex_lock, mutex);
+    }
+
+    int pthread_rwlock_rdlock (pthread_rwlock_t* rwlock)
+    {
+        countLock ("pthread_rwlock_rdlock");
+        CHASM_FORWARD (pthread_rwlock_rdlock, rwlock);
+    }
+
+    int pthread_rwlock_wrlock (pthread_rwlock_t* rwlock)
+    {
+        countLock ("pthread_rwlock_wrlock");
+        CHASM_FORWARD (pthread_rwlock_wrlock, rwlock);
+    }
+
+    int pthread_cond_wait (pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        countLock ("pthread_cond_wait");
+        CHASM_FORWARD (pthread_cond_wait, condition, mutex);
+    }
+
+    int pthread_cond_timedwait (pthread_cond_t* condition, pthread_mutex_t* mutex, const timespec* time)
+    {
+        countLock ("pthread_cond_timedwait");
+        CHASM_FORWARD (pthread_cond_timedwait, condition, mutex, time);
+    }
+
+    int sem_wait (sem_t* semaphore)
+    {
+        countLock ("sem_wait");
+        CHASM_FORWARD (sem_wait, semaphore);
+    }
+
+    //==============================================================================
+    ssize_t read (int fd, void* data, size_t size)
+    {
+        countSyscall ("read");
+        CHASM_FORWARD (read, fd, data, size);
+    }
+
+    ssize_t write (int fd, const void* data, size_t size)
+    {
+        countSyscall ("write");
+        CHASM_FORWARD (write, fd, data, size);
+    }
+
+    int open (const char* path, int flags, ...)
+    {
+        countSyscall ("open");
+
+        mode_t mode = 0;
+
+        if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE)
+        {
+            va_list args;
+            va_start (args, flags);
+            mode = static_cast<mode_t> (va_arg (args, int));
+            va_end (args);
+        }
+
+        CHASM_FORWARD (open, path, flags, mode);
+    }
+
+    int close (int fd)
+    {
+        countSyscall ("close");
+        CHASM_FORWARD (close, fd);
+    }
+
+    int nanosleep (const timespec* duration, timespec* remaining)
+    {
+        countSyscall ("nanosleep");
+        CHASM_FORWARD (nanosleep, duration, remaining);
+    }
+
+    int clock_nanosleep (clockid_t clock, int flags, const timespec* duration, timespec* remaining)
+    {
+        countSyscall ("clock_nanosleep");
+        CHASM_FORWARD (clock_nanosleep, clock, flags, duration, remaining);
+    }
+
+    int usleep (useconds_t microseconds)
+    {
+        countSyscall ("usleep");
+        CHASM_FORWARD (usleep, microseconds);
+    }
+
+    int sched_yield()
+    {
+        countSyscall ("sched_yield");
+        CHASM_FORWARD (sched_yield);
+    }
+
+    int poll (pollfd* fds, nfds_t count, int timeout)
+    {
+        countSyscall ("poll");
+        CHASM_FORWARD (poll, fds, count, timeout);
+    }
+
+    int select (int count, fd_set* readFds, fd_set* writeFds, fd_set* exceptFds, timeval* timeout)
+    {
+        countSyscall ("select");
+        CHASM_FORWARD (select, count, readFds, writeFds, exceptFds, timeout);
+    }
+
+    // futex waits (std::atomic::wait, contended std::mutex) and anything else
+    // going through the raw syscall() entry point
+    long syscall (long number, ...)
+    {
+        countSyscall ("syscall");
+
+        va_list args;
+        va_start (args, number);
+        long arguments[6];
+
+        for (auto& argument : arguments)
+            argument = va_arg (args, long);
+
+        va_end (args);
+
+        static std::atomic<long (*) (long, ...)> real { nullptr };
+        return next (real, "syscall") (number, arguments[0], arguments[1], arguments[2], arguments[3], arguments[4], arguments[5]);
+    }
+}
+
+    #undef CHASM_FORWARD
+
+#endif
+
+//==============================================================================
+TEST_CASE ("Real-time checks detect violations", "[realtime]")
+{
+    if (! CHASM_REALTIME_CHECKS)
+        SKIP ("Real-time checks need Linux/glibc symbol interposition");
+
+    violations = {};
+
+    {
+        RealtimeScope scope;
+        auto* volatile memory = new int (42);
+        delete memory;
+
+        juce::CriticalSection mutex;
+        const juce::ScopedLock lock (mutex);
+    }
+
+    CHECK (violations.allocations >= 2);
+    CHECK (violations.locks >= 1);
+}
+
+TEMPLATE_TEST_CASE ("Audio thread is real-time safe", "[realtime]", float, double)
+{
+    if (! CHASM_REALTIME_CHECKS)
+        SKIP ("Real-time checks need Linux/glibc symbol interposition");
+
+    PluginProcessor plugin;
+
+    // as a host does it, before preparing: only the matching processor gets prepared
+    if constexpr (std::is_same_v<TestType, double>)
+        plugin.setProcessingPrecision (juce::AudioProcessor::doublePrecision);
+
+    juce::Random random (static_cast<juce::int64> (Catch::getSeed()));
+
+    const auto& parameters = plugin.getParameters();
+    juce::MidiBuffer midi;
+
+    for (const auto sampleRate : { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 })
+    {
+        const int maximumBlockSize = 16 << random.nextInt (8); // 16 - 2048
+
+        INFO ("sample rate " << sampleRate << ", maximum block size " << maximumBlockSize);
+
+        plugin.prepareToPlay (sampleRate, maximumBlockSize);
+
+        juce::AudioBuffer<TestType> buffer (2, maximumBlockSize);
+
+        for (int block = 0; block < 300; ++block)
+        {
+            const int numSamples = 1 + random.nextInt (maximumBlockSize);
+
+            // runs of silence let the processor go to sleep and wake up again
+            const bool silent = (block / 50) % 2 == 1;
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    buffer.setSample (channel, i, silent ? TestType { 0.0 } : static_cast<TestType> (random.nextFloat() * 2.0f - 1.0f));
+
+            juce::AudioBuffer<TestType> view (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples);
+
+            auto* parameter = parameters[random.nextInt (parameters.size())];
+            const auto value = random.nextFloat();
+
+            violations = {};
+
+            {
+                // Host automation, as the plugin wrappers deliver it on the audio
+                // thread. JUCE dispatches to parameter listeners under its own
+                // (uncontended) listener lock, so locks are allowed here, but the
+                // listeners themselves must not allocate or make syscalls.
+                RealtimeScope scope (true);
+                parameter->setValue (value);
+                parameter->sendValueChangedMessageToListeners (value);
+            }
+
+            {
+                RealtimeScope scope;
+                plugin.processBlock (view, midi);
+            }
+
+            INFO ("block " << block << " of " << numSamples << " samples, after setting " << parameter->getName (32) << " to " << value);
+            INFO ("first violation: " << (violations.first != nullptr ? violations.first : "none"));
+            REQUIRE (violations.allocations == 0);
+            REQUIRE (violations.locks == 0);
+            REQUIRE (violations.syscalls == 0);
+        }
+
+        plugin.releaseResources();
+    }
+}
@@ -0,0 +1,152 @@
+#include <DSP/Utils/Saturation.h>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    using DSP::Utils::Saturation;
+
+    /** Dense over [-12, 12], which covers both clamp points and the table end. */
+    template <typename SampleType>
+    std::vector<SampleType> makeSweep()
+    {
+        std::vector<SampleType> inputs;
+
+        for (int i = -1200000; i <= 1200000; ++i)
+            inputs.push_back (static_cast<SampleType> (i * 1.0e-5));
+
+        return inputs;
+    }
+
+    template <typename SampleType>
+    std::vector<SampleType> makeSpecialValues()
+    {
+        using Limits = std::numeric_limits<SampleType>;
+
+        return { Limits::quiet_NaN(), -Limits::quiet_NaN(), Limits::infinity(), -Limits::infinity(),
+                 Limits::denorm_min(), -Limits::denorm_min(), Limits::min() / SampleType { 2.0 }, -Limits::min() / SampleType { 4.0 },
+                 Limits::max(), Limits::lowest(), SampleType { 0.0 }, -SampleType { 0.0 } };
+    }
+
+    /** Largest error of a curve against std::tanh, checking that the block form gives the same samples. */
+    template <typename SampleType, typename Scalar, typename Block>
+    double tanhError (Scalar&& scalar, Block&& block)
+    {
+        auto inputs = makeSweep<SampleType>();
+        auto blockOutput = inputs;
+        block (blockOutput.data(), (int) blockOutput.size());
+
+        double error = 0.0;
+        auto blockMatches = true;
+
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            const auto output = scalar (inputs[i]);
+            error = std::max (error, std::abs (static_cast<double> (output) - std::tanh (static_cast<double> (inputs[i]))));
+            blockMatches = blockMatches && output == blockOutput[i];
+        }
+
+        CHECK (blockMatches);
+        return error;
+    }
+
+    /** Every curve turns the special values into finite samples within its range, in both forms. */
+    template <typename SampleType, typename Scalar, typename Block>
+    void checkSpecialValues (Scalar&& scalar, Block&& block, SampleType lowest, SampleType highest)
+    {
+        const auto inputs = makeSpecialValues<SampleType>();
+        auto blockOutput = inputs;
+        block (blockOutput.data(), (int) blockOutput.size());
+
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            INFO ("input " << inputs[i]);
+
+            const auto output = scalar (inputs[i]);
+            CHECK (std::isfinite (output));
+            CHECK (output >= lowest);
+            CHECK (output <= highest);
+            CHECK (output == blockOutput[i]);
+
+            // NaN is silence, infinities saturate towards their sign
+            if (std::isnan (inputs[i]))
+                CHECK (output == SampleType { 0.0 });
+            else if (std::isinf (inputs[i]))
+                CHECK ((output > scalar (SampleType { 0.0 })) == (inputs[i] > SampleType { 0.0 }));
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE ("tanh approximations stay within their documented error", "[dsp][saturation]", float, double)
+{
+    // the bounds documented in Saturation.h, plus float rounding
+    constexpr double rounding = std::is_same_v<TestType, float> ? 2.0e-7 : 0.0;
+
+    SECTION ("tanhPade")
+    {
+        const auto error = tanhError<TestType> ([] (TestType x) { return Saturation::tanhPade (x); },
+                                                [] (TestType* data, int numSamples) { Saturation::tanhPade (data, numSamples); });
+        CHECK (error <= 1.0e-4 + rounding);
+    }
+
+    SECTION ("tanhTable")
+    {
+        Saturation::prepareTanhTable<TestType>();
+
+        const auto error = tanhError<TestType> ([] (TestType x) { return Saturation::tanhTable (x); },
+                                                [] (TestType* data, int numSamples) { Saturation::tanhTable (data, numSamples); });
+        CHECK (error <= 1.6e-6 + rounding);
+    }
+}
+
+TEMPLATE_TEST_CASE ("Saturation curves handle NaN, infinities and denormals", "[dsp][saturation]", float, double)
+{
+    constexpr TestType one { 1.0 };
+
+    SECTION ("tanhPade")
+    {
+        checkSpecialValues<TestType> ([] (TestType x) { return Saturation::tanhPade (x); },
+                                      [] (TestType* data, int numSamples) { Saturation::tanhPade (data, numSamples); }, -one, one);
+    }
+
+    SECTION ("tanhTable")
+    {
+        checkSpecialValues<TestType> ([] (TestType x) { return Saturation::tanhTable (x); },
+                                      [] (TestType* data, int numSamples) { Saturation::tanhTable (data, numSamples); }, -one, one);
+    }
+
+    SECTION ("softKnee")
+    {
+        constexpr TestType knee { 0.5 };
+        checkSpecialValues<TestType> ([] (TestType x) { return Saturation::softKnee (x, knee); },
+                                      [] (TestType* data, int numSamples) { Saturation::softKnee (data, numSamples, knee); }, -one, one);
+    }
+
+    SECTION ("cubic")
+    {
+        checkSpecialValues<TestType> ([] (TestType x) { return Saturation::cubic (x); },
+                                      [] (TestType* data, int numSamples) { Saturation::cubic (data, numSamples); }, -one, one);
+    }
+
+    SECTION ("asymmetric")
+    {
+        constexpr TestType bias { 0.3 };
+        const auto offset = Saturation::tanhPade (bias);
+        checkSpecialValues<TestType> ([] (TestType x) { return Saturation::asymmetric (x, bias); },
+                                      [] (TestType* data, int numSamples) { Saturation::asymmetric (data, numSamples, bias); },
+                                      -one - offset, one - offset);
+    }
+
+    SECTION ("denormals stay tiny and keep their sign")
+    {
+        for (const auto x : { std::numeric_limits<TestType>::denorm_min(), -std::numeric_limits<TestType>::min() / TestType { 8.0 } })
+        {
+            CHECK (Saturation::tanhPade (x) == x);
+
+            // the table's first segment has a slope just below 1
+            const auto tabled = Saturation::tanhTable (x);
+            CHECK (std::abs (tabled) <= std::abs (x));
+            CHECK (tabled * x >= TestType { 0.0 });
+        }
+    }
+}
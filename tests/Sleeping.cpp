@@ -0,0 +1,183 @@
+#include <DSP/ChasmDSP.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    using Processor = DSP::Core::ChasmDSPProcessor<float>;
+    using Parameter = Processor::Parameter;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 64;
+
+    // anything at or below this counts as silence, see ChasmDSPProcessor
+    constexpr float silenceThreshold = 1.0e-6f;
+
+    void prepare (Processor& processor)
+    {
+        processor.setParameter (Parameter::delay, 40.0f);
+        processor.setParameter (Parameter::character, 3.0f);
+        processor.setParameter (Parameter::lowCut, 30.0f);
+        processor.setParameter (Parameter::haas, 12.0f);
+        processor.setCompressorMode (1);
+        processor.setOversampling (2, Processor::OversamplingFilter::PolyphaseIIR);
+        processor.prepare ({ sampleRate, (juce::uint32) blockSize, 2 });
+    }
+
+    /** A stereo impulse in an otherwise silent block. */
+    juce::AudioBuffer<float> makeImpulse (int position, float level)
+    {
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        buffer.clear();
+        buffer.setSample (0, position, level);
+        buffer.setSample (1, position, -level);
+        return buffer;
+    }
+
+    /** Feeds silent blocks until the processor sleeps; returns the silent samples it took. */
+    int processUntilSleeping (Processor& processor, int maximumSamples)
+    {
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        int samples = 0;
+
+        while (! processor.isSleeping() && samples < maximumSamples)
+        {
+            buffer.clear();
+            processor.processBlock (buffer);
+            samples += blockSize;
+        }
+
+        return samples;
+    }
+}
+
+TEST_CASE ("The processor sleeps once the tail and latency have passed", "[dsp][sleep]")
+{
+    Processor processor;
+    prepare (processor);
+
+    const auto waitSamples = static_cast<int> (std::ceil (processor.getTailLengthSeconds() * sampleRate)) + processor.getLatencySamples();
+    REQUIRE (waitSamples > blockSize);
+
+    auto impulse = makeImpulse (blockSize - 1, 1.0f);
+    processor.processBlock (impulse);
+    CHECK_FALSE (processor.isSleeping());
+
+    // not a block before it has to, and no more than one block late
+    const auto silentSamples = processUntilSleeping (processor, 100 * waitSamples);
+    CHECK (silentSamples > waitSamples);
+    CHECK (silentSamples <= waitSamples + blockSize);
+
+    SECTION ("sleeping outputs silence")
+    {
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        buffer.clear();
+        processor.processBlock (buffer);
+
+        CHECK (processor.isSleeping());
+        CHECK (buffer.getMagnitude (0, blockSize) == 0.0f);
+    }
+
+    SECTION ("input at the threshold doesn't wake it")
+    {
+        auto quiet = makeImpulse (10, silenceThreshold);
+        processor.processBlock (quiet);
+
+        CHECK (processor.isSleeping());
+        CHECK (quiet.getMagnitude (0, blockSize) == 0.0f);
+    }
+
+    SECTION ("the first sample above the threshold wakes it")
+    {
+        auto last = makeImpulse (blockSize - 1, 2.0f * silenceThreshold);
+        processor.processBlock (last);
+        CHECK_FALSE (processor.isSleeping());
+    }
+}
+
+TEST_CASE ("Sleeping doesn't change the output", "[dsp][sleep]")
+{
+    Processor sleepy, awake;
+    prepare (sleepy);
+    prepare (awake);
+    awake.setCanSleep (false);
+
+    const auto waitSamples = static_cast<int> (std::ceil (sleepy.getTailLengthSeconds() * sampleRate)) + sleepy.getLatencySamples();
+    const auto numBlocks = 3 * (waitSamples / blockSize + 1);
+
+    juce::Random random (4);
+    double maximumDifference = 0.0;
+    auto sleptBlocks = 0;
+
+    // noise, then silence long enough to sleep through, then noise that starts on a block's last sample
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        juce::AudioBuffer<float> input (2, blockSize);
+        input.clear();
+
+        const auto silent = block >= 10 && block < numBlocks - 10;
+        const auto start = block == numBlocks - 10 ? blockSize - 1 : 0;
+
+        if (! silent)
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = start; i < blockSize; ++i)
+                    input.setSample (channel, i, random.nextFloat() - 0.5f);
+
+        juce::AudioBuffer<float> sleepyOutput (input), awakeOutput (input);
+        sleepy.processBlock (sleepyOutput);
+        awake.processBlock (awakeOutput);
+
+        sleptBlocks += sleepy.isSleeping() ? 1 : 0;
+        CHECK_FALSE (awake.isSleeping());
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                maximumDifference = std::max (maximumDifference, (double) std::abs (sleepyOutput.getSample (channel, i) - awakeOutput.getSample (channel, i)));
+    }
+
+    CHECK (sleptBlocks > numBlocks / 2);
+    CHECK_FALSE (sleepy.isSleeping());
+
+    // only what was left of the tail differs: below -120 dB
+    CHECK (maximumDifference < silenceThreshold);
+}
+
+TEST_CASE ("The tail estimate bounds the measured decay", "[dsp][sleep]")
+{
+    for (const auto character : { 0.3f, 1.0f, 3.0f, 10.0f })
+    {
+        for (const auto delay : { 5.0f, 30.0f, 100.0f })
+        {
+            INFO ("character " << character << ", delay " << delay << " ms");
+
+            Processor processor;
+            processor.setParameter (Parameter::character, character);
+            processor.setParameter (Parameter::delay, delay);
+            processor.setParameter (Parameter::mix, 100.0f);
+            processor.setParameter (Parameter::lowCut, 20.0f);
+            processor.setParameter (Parameter::haas, 50.0f);
+            processor.setCanSleep (false);
+            processor.prepare ({ sampleRate, (juce::uint32) blockSize, 2 });
+
+            const auto tailSamples = static_cast<int> (std::ceil (processor.getTailLengthSeconds() * sampleRate));
+
+            // the last sample above -120 dB after a full scale impulse
+            auto buffer = makeImpulse (0, 1.0f);
+            int lastAudible = 0;
+
+            for (int start = 0; start < 2 * tailSamples; start += blockSize)
+            {
+                processor.processBlock (buffer);
+
+                for (int channel = 0; channel < 2; ++channel)
+                    for (int i = 0; i < blockSize; ++i)
+                        if (std::abs (buffer.getSample (channel, i)) > silenceThreshold)
+                            lastAudible = start + i;
+
+                buffer.clear();
+            }
+
+            CHECK (lastAudible > 0);
+            CHECK (lastAudible <= tailSamples);
+        }
+    }
+}
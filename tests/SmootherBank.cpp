@@ -0,0 +1,65 @@
+#include <DSP/Utils/ParameterSmoother.h>
+#include <DSP/Utils/SmootherBank.h>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    // from instant over settling within a block to ramps spanning several
+    constexpr std::array<double, 5> smoothingTimesMs { 0.0, 0.2, 2.0, 20.0, 50.0 };
+}
+
+TEMPLATE_TEST_CASE ("Smoother bank ramps match separate smoothers", "[dsp][smoother]", float, double)
+{
+    constexpr auto numLanes = smoothingTimesMs.size();
+
+    DSP::Utils::SmootherBank<TestType, numLanes> bank;
+    bank.prepare (sampleRate, blockSize);
+
+    std::array<DSP::Utils::ParameterSmoother<TestType>, numLanes> smoothers;
+
+    for (size_t lane = 0; lane < numLanes; ++lane)
+    {
+        bank.setSmoothingTime (lane, smoothingTimesMs[lane]);
+        smoothers[lane].prepare (sampleRate, smoothingTimesMs[lane]);
+    }
+
+    juce::Random random (7);
+    std::vector<TestType> expected (blockSize);
+
+    for (int block = 0; block < 64; ++block)
+    {
+        // new targets for some lanes only, at values where the threshold is absolute and relative
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            if ((block + (int) lane) % 3 != 0)
+                continue;
+
+            const auto value = static_cast<TestType> (random.nextFloat() * (lane % 2 == 0 ? 1.0f : 5000.0f));
+            bank.setTargetValue (lane, value);
+            smoothers[lane].setTargetValue (value);
+        }
+
+        // odd lengths too, so lanes settle at every point of a block
+        const auto numSamples = block % 4 == 0 ? blockSize : 1 + random.nextInt (blockSize);
+        bank.fillRamps (numSamples);
+
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            INFO ("block " << block << ", lane " << lane);
+
+            for (int i = 0; i < numSamples; ++i)
+                expected[(size_t) i] = smoothers[lane].getNextValue();
+
+            CHECK (std::equal (expected.begin(), expected.begin() + numSamples, bank.getRamp (lane)));
+            CHECK (bank.isSmoothing (lane) == smoothers[lane].isSmoothing());
+            CHECK (bank.getCurrentValue (lane) == smoothers[lane].getCurrentValue());
+        }
+    }
+
+    bank.snapToTargetValues();
+    CHECK_FALSE (bank.isSmoothing());
+}
@@ -0,0 +1,79 @@
+#include <DSP/ChasmDSP.h>
+#include <catch2/catch_test_macros.hpp>
+
+#if CHASM_STAGE_PROFILING
+
+namespace
+{
+    using Processor = DSP::Core::ChasmDSPProcessor<float>;
+    using Parameter = Processor::Parameter;
+    using Stage = Processor::Stage;
+
+    constexpr int blockSize = 512;
+    constexpr int numBlocks = 8;
+
+    void processNoise (Processor& processor)
+    {
+        juce::Random random (7);
+        juce::AudioBuffer<float> buffer (2, blockSize);
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+            processor.processBlock (buffer);
+        }
+    }
+}
+
+TEST_CASE ("Stage profiling covers every stage", "[dsp][profiling]")
+{
+    Processor processor;
+    processor.setParameter (Parameter::lowCut, 80.0f);
+    processor.setParameter (Parameter::highCut, 12000.0f);
+    processor.setParameter (Parameter::haas, 10.0f);
+    processor.setCompressorMode (2);
+
+    auto& profiler = processor.getStageProfiler();
+
+    SECTION ("all stages, one call per chunk or sub-block")
+    {
+        processor.prepare ({ 48000.0, (juce::uint32) blockSize, 2 });
+        processNoise (processor);
+
+        for (size_t stage = 0; stage < Processor::numStages; ++stage)
+        {
+            INFO (Processor::getStageName (static_cast<Stage> (stage)));
+
+            const auto stats = profiler.getStats (stage);
+            CHECK (stats.calls > 0);
+            CHECK (stats.ticks >= 0);
+            CHECK (stats.worstTicks <= stats.ticks);
+
+            // the coefficient updates count no samples, only the ramps do
+            CHECK (stats.samples == numBlocks * blockSize);
+        }
+
+        profiler.reset();
+
+        for (size_t stage = 0; stage < Processor::numStages; ++stage)
+            CHECK (profiler.getStats (stage).calls == 0);
+
+        CHECK (profiler.getTotalTicks() == 0);
+    }
+
+    SECTION ("a dry-only mix skips the wet stages")
+    {
+        processor.setParameter (Parameter::mix, 0.0f);
+        processor.prepare ({ 48000.0, (juce::uint32) blockSize, 2 });
+        processNoise (processor);
+
+        CHECK (profiler.getStats ((size_t) Stage::mix).samples == numBlocks * blockSize);
+        CHECK (profiler.getStats ((size_t) Stage::inputAndAllpass).calls == 0);
+        CHECK (profiler.getStats ((size_t) Stage::makeItLoud).calls == 0);
+    }
+}
+
+#endif
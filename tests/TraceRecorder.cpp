@@ -0,0 +1,165 @@
+#include <Service/TraceRecorder.h>
+#include <catch2/catch_test_macros.hpp>
+#include <juce_events/juce_events.h>
+#include <map>
+#include <thread>
+
+namespace
+{
+    struct ThreadEvents
+    {
+        int begins = 0, ends = 0;
+        double lastTimestamp = -1.0;
+        bool ordered = true;
+    };
+
+    /** Events per thread name, from the recorder's JSON. */
+    std::map<juce::String, ThreadEvents> parseTrace (const juce::String& json)
+    {
+        const auto trace = juce::JSON::parse (json);
+        const auto* events = trace["traceEvents"].getArray();
+        REQUIRE (events != nullptr);
+
+        std::map<int, juce::String> names;
+        std::map<juce::String, ThreadEvents> threads;
+
+        for (const auto& event : *events)
+            if (event["ph"].toString() == "M")
+                names[(int) event["tid"]] = event["args"]["name"].toString();
+
+        for (const auto& event : *events)
+        {
+            const auto phase = event["ph"].toString();
+
+            if (phase == "M")
+                continue;
+
+            auto& thread = threads[names[(int) event["tid"]]];
+            const auto timestamp = (double) event["ts"];
+
+            thread.ordered = thread.ordered && timestamp >= thread.lastTimestamp;
+            thread.lastTimestamp = timestamp;
+            (phase == "B" ? thread.begins : thread.ends)++;
+        }
+
+        return threads;
+    }
+}
+
+TEST_CASE ("Trace recorder", "[trace]")
+{
+    auto& recorder = Service::TraceRecorder::getInstance();
+
+    SECTION ("nothing is recorded while disabled")
+    {
+        recorder.setEnabled (false);
+        recorder.clear();
+
+        {
+            CHASM_TRACE_SCOPE ("untraced");
+        }
+
+        CHECK (parseTrace (recorder.toJson())["Message thread"].begins == 0);
+    }
+
+    SECTION ("nested scopes on several threads")
+    {
+        recorder.clear();
+        recorder.setEnabled (true);
+
+        {
+            CHASM_TRACE_SCOPE ("outer");
+            CHASM_TRACE_SCOPE ("inner");
+        }
+
+        std::thread worker ([] {
+            for (int i = 0; i < 10; ++i)
+            {
+                CHASM_TRACE_SCOPE_ON_THREAD ("work", "Test worker");
+            }
+        });
+
+        worker.join();
+        recorder.setEnabled (false);
+
+        const auto threads = parseTrace (recorder.toJson());
+
+        REQUIRE (threads.count ("Message thread") == 1);
+        CHECK (threads.at ("Message thread").begins == 2);
+        CHECK (threads.at ("Message thread").ends == 2);
+        CHECK (threads.at ("Message thread").ordered);
+
+        REQUIRE (threads.count ("Test worker") == 1);
+        CHECK (threads.at ("Test worker").begins == 10);
+        CHECK (threads.at ("Test worker").ends == 10);
+        CHECK (threads.at ("Test worker").ordered);
+    }
+
+    SECTION ("a wrapped ring keeps only whole scopes")
+    {
+        recorder.clear();
+        recorder.setEnabled (true);
+
+        for (int i = 0; i < Service::TraceRecorder::eventsPerThread; ++i)
+        {
+            CHASM_TRACE_SCOPE ("many");
+        }
+
+        recorder.setEnabled (false);
+        const auto thread = parseTrace (recorder.toJson())["Message thread"];
+
+        CHECK (thread.begins == Service::TraceRecorder::eventsPerThread / 2);
+        CHECK (thread.ends == thread.begins);
+    }
+
+    SECTION ("clearing frees the rings of finished threads")
+    {
+        // more threads in all than there are rings, which stay traced as long as each recording has fewer
+        for (int recording = 0; recording < 3; ++recording)
+        {
+            INFO ("recording " << recording);
+
+            recorder.clear();
+            recorder.setEnabled (true);
+
+            for (int i = 0; i < Service::TraceRecorder::maxThreads; ++i)
+            {
+                std::thread worker ([] {
+                    CHASM_TRACE_SCOPE_ON_THREAD ("work", "Test worker");
+                });
+
+                worker.join();
+            }
+
+            recorder.setEnabled (false);
+            const auto threads = parseTrace (recorder.toJson());
+
+            REQUIRE (threads.count ("Test worker") == 1);
+            CHECK (threads.at ("Test worker").begins == Service::TraceRecorder::maxThreads);
+            CHECK (threads.at ("Test worker").ends == Service::TraceRecorder::maxThreads);
+        }
+    }
+
+    SECTION ("a thread inside a scope keeps its ring through a clear")
+    {
+        recorder.clear();
+        recorder.setEnabled (true);
+
+        {
+            CHASM_TRACE_SCOPE ("before");
+        }
+
+        {
+            CHASM_TRACE_SCOPE ("open");
+            recorder.clear();
+            CHASM_TRACE_SCOPE ("inner");
+        }
+
+        recorder.setEnabled (false);
+        const auto thread = parseTrace (recorder.toJson())["Message thread"];
+
+        // the open scope's begin was cleared, so its end is dropped too
+        CHECK (thread.begins == 1);
+        CHECK (thread.ends == 1);
+    }
+}
@@ -0,0 +1,251 @@
+#include <DSP/Utils/VectorOps.h>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    template <typename SampleType>
+    std::vector<SampleType> makeSignal (int numSamples, juce::int64 seed, SampleType low, SampleType high)
+    {
+        juce::Random random (seed);
+        std::vector<SampleType> signal ((size_t) numSamples);
+
+        for (auto& sample : signal)
+            sample = low + (high - low) * static_cast<SampleType> (random.nextDouble());
+
+        return signal;
+    }
+
+    template <typename SampleType>
+    double maximumDifference (const std::vector<SampleType>& a, const std::vector<SampleType>& b)
+    {
+        double difference = 0.0;
+
+        for (size_t i = 0; i < a.size(); ++i)
+            difference = std::max (difference, std::abs (static_cast<double> (a[i] - b[i])));
+
+        return difference;
+    }
+
+    // a shelf-like stage and a high pass, both stable; b0, b1, b2, a1, a2
+    template <typename SampleType>
+    const std::array<std::array<SampleType, 5>, 2> stages {
+        { { SampleType (1.2426), SampleType (-1.6585), SampleType (0.6254), SampleType (-1.6307), SampleType (0.6702) },
+          { SampleType (0.9817), SampleType (-1.9630), SampleType (0.9817), SampleType (-1.9629), SampleType (0.9633) } }
+    };
+
+    template <typename Cascade, typename SampleType>
+    void configure (Cascade& cascade)
+    {
+        cascade.prepare (2);
+
+        for (int stage = 0; stage < 2; ++stage)
+        {
+            const auto& [b0, b1, b2, a1, a2] = stages<SampleType>[(size_t) stage];
+            cascade.setCoefficients (stage, b0, b1, b2, a1, a2);
+        }
+    }
+
+    /** The loop BrightnessEQ ran before BiquadCascade: one TDF-II stage, state flushed per block. */
+    template <typename SampleType>
+    void scalarBiquad (SampleType* data, int numSamples, const std::array<SampleType, 5>& coefficients, std::array<SampleType, 2>& state)
+    {
+        const auto [b0, b1, b2, a1, a2] = coefficients;
+        auto s1 = state[0];
+        auto s2 = state[1];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto input = data[i];
+            const auto output = input * b0 + s1;
+            s1 = input * b1 - output * a1 + s2;
+            s2 = input * b2 - output * a2;
+            data[i] = output;
+        }
+
+        juce::dsp::util::snapToZero (s1);
+        juce::dsp::util::snapToZero (s2);
+        state = { s1, s2 };
+    }
+}
+
+TEMPLATE_TEST_CASE ("Portable vector ops match the scalar loops they replaced", "[dsp]", float, double)
+{
+    using Portable = DSP::Utils::PortableVectorOps;
+
+    constexpr int numSamples = 1001;
+
+    const auto left = makeSignal<TestType> (numSamples, 1, -1, 1);
+    const auto right = makeSignal<TestType> (numSamples, 2, -1, 1);
+    const auto mix = makeSignal<TestType> (numSamples, 3, 0, 1);
+    const auto gains = makeSignal<TestType> (numSamples, 4, 0, 2);
+
+    // the same operations in the same order, so bit-exact
+    SECTION ("multiply")
+    {
+        std::vector<TestType> portable ((size_t) numSamples), expected ((size_t) numSamples);
+        Portable::multiply (portable.data(), left.data(), gains.data(), numSamples);
+
+        for (size_t i = 0; i < expected.size(); ++i)
+            expected[i] = left[i] * gains[i];
+
+        CHECK (portable == expected);
+
+        Portable::multiply (portable.data(), mix.data(), numSamples);
+
+        for (size_t i = 0; i < expected.size(); ++i)
+            expected[i] *= mix[i];
+
+        CHECK (portable == expected);
+    }
+
+    SECTION ("mix")
+    {
+        auto portable = left, expected = left;
+        Portable::mix (portable.data(), right.data(), mix.data(), gains.data(), numSamples);
+
+        for (size_t i = 0; i < expected.size(); ++i)
+            expected[i] = (expected[i] * (TestType { 1.0 } - mix[i]) + right[i] * mix[i]) * gains[i];
+
+        CHECK (portable == expected);
+    }
+
+    SECTION ("mid/side width")
+    {
+        for (const auto width : { TestType { 0.0 }, TestType { 0.7 }, TestType { 2.0 } })
+        {
+            auto portableLeft = left, portableRight = right, expectedLeft = left, expectedRight = right;
+            Portable::midSideWidth (portableLeft.data(), portableRight.data(), width, numSamples);
+
+            // as StereoEnhancer::processSample()
+            for (size_t i = 0; i < expectedLeft.size(); ++i)
+            {
+                const auto mid = (expectedLeft[i] + expectedRight[i]) * TestType { 0.5 };
+                auto side = (expectedLeft[i] - expectedRight[i]) * TestType { 0.5 };
+                side *= width;
+                expectedLeft[i] = mid + side;
+                expectedRight[i] = mid - side;
+            }
+
+            CHECK (portableLeft == expectedLeft);
+            CHECK (portableRight == expectedRight);
+        }
+    }
+
+    SECTION ("biquad cascade")
+    {
+        DSP::Utils::PortableBiquadCascade<TestType, 2> cascade;
+        configure<decltype (cascade), TestType> (cascade);
+
+        std::array<std::array<TestType, 2>, 2> state {};
+        auto portable = left, expected = left;
+
+        // in blocks, so the state carries over between calls; each stage over the block in turn
+        for (int start = 0; start < numSamples; start += 100)
+        {
+            const int length = juce::jmin (100, numSamples - start);
+            cascade.process (1, portable.data() + start, length);
+
+            for (size_t stage = 0; stage < 2; ++stage)
+                scalarBiquad (expected.data() + start, length, stages<TestType>[stage], state[stage]);
+        }
+
+        CHECK (portable == expected);
+
+        // and from silence after a reset
+        cascade.reset();
+        state = {};
+
+        auto portableAfterReset = right, expectedAfterReset = right;
+        cascade.process (1, portableAfterReset.data(), numSamples);
+
+        for (size_t stage = 0; stage < 2; ++stage)
+            scalarBiquad (expectedAfterReset.data(), numSamples, stages<TestType>[stage], state[stage]);
+
+        CHECK (portableAfterReset == expectedAfterReset);
+    }
+}
+
+#ifdef CHASM_IPP
+
+namespace
+{
+    template <typename SampleType>
+    constexpr double tolerance = std::is_same_v<SampleType, float> ? 1.0e-5 : 1.0e-12;
+}
+
+TEMPLATE_TEST_CASE ("IPP vector ops match the portable ones", "[dsp][ipp]", float, double)
+{
+    using Portable = DSP::Utils::PortableVectorOps;
+    using Ipp = DSP::Utils::IppVectorOps;
+
+    // an odd length, so the scratch buffer chunking ends on a partial chunk
+    constexpr int numSamples = 1001;
+
+    const auto left = makeSignal<TestType> (numSamples, 1, -1, 1);
+    const auto right = makeSignal<TestType> (numSamples, 2, -1, 1);
+    const auto mix = makeSignal<TestType> (numSamples, 3, 0, 1);
+    const auto gains = makeSignal<TestType> (numSamples, 4, 0, 2);
+
+    SECTION ("multiply")
+    {
+        std::vector<TestType> portable ((size_t) numSamples), ipp ((size_t) numSamples);
+        Portable::multiply (portable.data(), left.data(), gains.data(), numSamples);
+        Ipp::multiply (ipp.data(), left.data(), gains.data(), numSamples);
+        CHECK (maximumDifference (portable, ipp) <= tolerance<TestType>);
+
+        Portable::multiply (portable.data(), mix.data(), numSamples);
+        Ipp::multiply (ipp.data(), mix.data(), numSamples);
+        CHECK (maximumDifference (portable, ipp) <= tolerance<TestType>);
+    }
+
+    SECTION ("mix")
+    {
+        auto portable = left, ipp = left;
+        Portable::mix (portable.data(), right.data(), mix.data(), gains.data(), numSamples);
+        Ipp::mix (ipp.data(), right.data(), mix.data(), gains.data(), numSamples);
+        CHECK (maximumDifference (portable, ipp) <= tolerance<TestType>);
+    }
+
+    SECTION ("mid/side width")
+    {
+        for (const auto width : { TestType { 0.0 }, TestType { 0.7 }, TestType { 2.0 } })
+        {
+            auto portableLeft = left, portableRight = right, ippLeft = left, ippRight = right;
+            Portable::midSideWidth (portableLeft.data(), portableRight.data(), width, numSamples);
+            Ipp::midSideWidth (ippLeft.data(), ippRight.data(), width, numSamples);
+            CHECK (maximumDifference (portableLeft, ippLeft) <= tolerance<TestType>);
+            CHECK (maximumDifference (portableRight, ippRight) <= tolerance<TestType>);
+        }
+    }
+
+    SECTION ("biquad cascade")
+    {
+        DSP::Utils::PortableBiquadCascade<TestType, 2> portableCascade;
+        DSP::Utils::IppBiquadCascade<TestType, 2> ippCascade;
+        configure<decltype (portableCascade), TestType> (portableCascade);
+        configure<decltype (ippCascade), TestType> (ippCascade);
+
+        auto portable = left, ipp = left;
+
+        // in blocks, so the state carries over between calls
+        for (int start = 0; start < numSamples; start += 100)
+        {
+            const int length = juce::jmin (100, numSamples - start);
+            portableCascade.process (1, portable.data() + start, length);
+            ippCascade.process (1, ipp.data() + start, length);
+        }
+
+        CHECK (maximumDifference (portable, ipp) <= 100 * tolerance<TestType>);
+
+        portableCascade.reset();
+        ippCascade.reset();
+
+        auto portableAfterReset = right, ippAfterReset = right;
+        portableCascade.process (0, portableAfterReset.data(), numSamples);
+        ippCascade.process (0, ippAfterReset.data(), numSamples);
+        CHECK (maximumDifference (portableAfterReset, ippAfterReset) <= 100 * tolerance<TestType>);
+    }
+}
+
+#endif